@@ -119,7 +119,9 @@ void MecanumChassisSubsystem::updateMotorRpmPid(
     tap::motor::DjiMotor* const motor,
     float desiredRpm)
 {
-    pid->update(desiredRpm - motor->getShaftRPM());
+    // Estimated from the encoder history, finer than the RPM reported by the motor
+    float rpm = motor->getEncoderVelocity() * 60.0f / tap::motor::DjiMotor::ENC_RESOLUTION;
+    pid->update(desiredRpm - rpm);
     motor->setDesiredOutput(pid->getValue());
 }
 
@@ -21,6 +21,7 @@
 #define TURRET_MOTOR_HPP_
 
 #include "tap/algorithms/contiguous_float.hpp"
+#include "tap/motor/dji_motor.hpp"
 #include "tap/motor/motor_interface.hpp"
 #include "tap/util_macros.hpp"
 
@@ -109,11 +110,11 @@ public:
 
     /**
      * @return angular velocity of the turret, in rad/sec, positive rotation is defined by the
-     * motor.
+     * motor. Estimated from the motor's timestamped encoder history rather than its reported RPM.
      */
     mockable inline float getChassisFrameVelocity() const
     {
-        return (M_TWOPI / 60) * motor->getShaftRPM();
+        return (M_TWOPI / tap::motor::DjiMotor::ENC_RESOLUTION) * motor->getEncoderVelocity();
     }
 
     /**
@@ -45,7 +45,7 @@ TurretUserWorldRelativeCommand::TurretUserWorldRelativeCommand(
           userPitchInputScalar,
           turretID)
 {
-    comprisedCommandScheduler.registerSubsystem(turretSubsystem);
+    comprisedCommandExecutor.registerSubsystem(turretSubsystem);
     addSubsystemRequirement(turretSubsystem);
 }
 
@@ -56,19 +56,19 @@ bool TurretUserWorldRelativeCommand::isReady()
 
 void TurretUserWorldRelativeCommand::initialize()
 {
-    comprisedCommandScheduler.addCommand(&turretWRChassisImuCommand);
+    comprisedCommandExecutor.addCommand(&turretWRChassisImuCommand);
 }
 
 void TurretUserWorldRelativeCommand::execute()
 {
     // Re-initialize if no commands scheduled or if the turret WR Turret IMU command
     // is ready and isn't scheduled
-    if (comprisedCommandScheduler.getAddedCommandBitmap() == 0)
+    if (comprisedCommandExecutor.commandListSize() == 0)
     {
         initialize();
     }
 
-    comprisedCommandScheduler.run();
+    comprisedCommandExecutor.run();
 }
 
 bool TurretUserWorldRelativeCommand::isFinished() const
@@ -78,7 +78,7 @@ bool TurretUserWorldRelativeCommand::isFinished() const
 
 void TurretUserWorldRelativeCommand::end(bool interrupted)
 {
-    comprisedCommandScheduler.removeCommand(&turretWRChassisImuCommand, interrupted);
+    comprisedCommandExecutor.removeCommand(&turretWRChassisImuCommand, interrupted);
 }
 
 }  // namespace xcysrc::control::turret::user
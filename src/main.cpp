@@ -23,11 +23,13 @@
 #include "modm/architecture/interface/delay.hpp"
 
 /* arch includes ------------------------------------------------------------*/
+#include "tap/architecture/control_tick.hpp"
 #include "tap/architecture/periodic_timer.hpp"
 #include "tap/architecture/profiler.hpp"
 
 /* communication includes ---------------------------------------------------*/
 #include "src/drivers_singleton.hpp"
+#include "tap/communication/tcp-server/tcp_server.hpp"
 
 /* error handling includes --------------------------------------------------*/
 #include "tap/errors/create_errors.hpp"
@@ -40,6 +42,26 @@
 static constexpr float MAIN_LOOP_FREQUENCY = 500.0f;
 static constexpr float MAHONY_KP = 0.1f;
 
+/**
+ * If `true`, the control pass (scheduler and motor output) is run from a timer interrupt (a
+ * timer thread in the simulator) at `MAIN_LOOP_FREQUENCY` while the main loop polls I/O in the
+ * background. If `false`, the main loop polls I/O and runs the control pass whenever
+ * `sendMotorTimeout` expires.
+ *
+ * Off by default: with it on, every command and subsystem (and anything they call, such as
+ * `RAISE_ERROR`) runs in interrupt context on the MCB, so check a robot's code on hardware
+ * before enabling it.
+ */
+static constexpr bool USE_CONTROL_TICK_INTERRUPT = false;
+
+/**
+ * Frames drained per CAN bus per I/O pass, enough for two feedback frames from each of eight
+ * motors, and the time after which draining stops early (in us). The drain holds off the control
+ * tick, so the budget also bounds how late it can make a tick.
+ */
+static constexpr int CAN_RX_FRAMES_PER_BUS = 16;
+static constexpr uint32_t CAN_RX_DRAIN_BUDGET = 200;
+
 /* define timers here -------------------------------------------------------*/
 tap::arch::PeriodicMilliTimer sendMotorTimeout(1000.0f / MAIN_LOOP_FREQUENCY);
 
@@ -52,6 +74,9 @@ static void initializeIo(tap::Drivers *drivers);
 // called as frequently.
 static void updateIo(tap::Drivers *drivers);
 
+// The control pass, run once every main loop period.
+static void runControl(tap::Drivers *drivers);
+
 using namespace xcysrc::standard;
 
 int main()
@@ -70,18 +95,27 @@ int main()
     modm::delay_ms(1000);
     drivers->leds.set(tap::gpio::Leds::Red, false);
     initSubsystemCommands(drivers);
+    drivers->commandScheduler.setRunPeriod(
+        static_cast<uint32_t>(1'000'000.0f / MAIN_LOOP_FREQUENCY));
     drivers->leds.set(tap::gpio::Leds::Green, true);
     modm::delay_ms(1000);
     drivers->leds.set(tap::gpio::Leds::Green, false);
+
+    if (USE_CONTROL_TICK_INTERRUPT)
+    {
+        drivers->controlTick.start(
+            static_cast<uint32_t>(1'000'000.0f / MAIN_LOOP_FREQUENCY),
+            runControl);
+    }
+
     while (1)
     {
         // do this as fast as you can
-        PROFILE(drivers->profiler, updateIo, (drivers));
+        updateIo(drivers);
 
-        if (sendMotorTimeout.execute())
+        if (!USE_CONTROL_TICK_INTERRUPT && sendMotorTimeout.execute())
         {
-            PROFILE(drivers->profiler, drivers->commandScheduler.run, ());
-            PROFILE(drivers->profiler, drivers->djiMotorTxHandler.processCanSendData, ());
+            runControl(drivers);
         }
         modm::delay_us(10);
     }
@@ -95,13 +129,53 @@ static void initializeIo(tap::Drivers *drivers)
     drivers->digital.init();
     drivers->leds.init();
     drivers->can.initialize();
+    drivers->canRxHandler.initialize();
+    drivers->canRxHandler.setDrainLimits(CAN_RX_FRAMES_PER_BUS, CAN_RX_DRAIN_BUDGET);
     drivers->remote.initialize();
     drivers->refSerial.initialize();
+    drivers->terminalSerial.initialize();
+    drivers->schedulerTerminalHandler.init();
+    drivers->djiMotorTerminalSerialHandler.init();
+    drivers->profilerTerminalHandler.init();
+    drivers->canTerminalHandler.init();
+#ifdef PLATFORM_HOSTED
+    tap::communication::TCPServer *server = tap::communication::TCPServer::MainServer();
+    if (server != nullptr)
+    {
+        server->start(tap::communication::TCPServer::DEFAULT_PORT);
+    }
+#endif
 }
 
 static void updateIo(tap::Drivers *drivers)
 {
-    drivers->canRxHandler.pollCanData();
-    drivers->refSerial.updateSerial();
-    drivers->remote.read();
+    // Each step holds off the control tick, so that a control pass never sees a half processed
+    // message or runs concurrently with commands added by the remote. Locks are kept per step
+    // to bound how late they can make a tick.
+    {
+        tap::arch::ControlTick::Lock lock(&drivers->controlTick);
+        PROFILE(drivers->profiler, drivers->canRxHandler.pollCanData, ());
+        PROFILE(drivers->profiler, drivers->motorInnerLoop.run, ());
+    }
+    {
+        tap::arch::ControlTick::Lock lock(&drivers->controlTick);
+        PROFILE(drivers->profiler, drivers->refSerial.updateSerial, ());
+    }
+    {
+        tap::arch::ControlTick::Lock lock(&drivers->controlTick);
+        PROFILE(drivers->profiler, drivers->remote.read, ());
+    }
+    {
+        tap::arch::ControlTick::Lock lock(&drivers->controlTick);
+        drivers->terminalSerial.update();
+    }
+}
+
+static void runControl(tap::Drivers *drivers)
+{
+    PROFILE(drivers->profiler, drivers->commandScheduler.run, ());
+    PROFILE(drivers->profiler, drivers->djiMotorTxHandler.processCanSendData, ());
+#ifdef PLATFORM_HOSTED
+    PROFILE(drivers->profiler, drivers->motorTelemetry.update, ());
+#endif
 }
@@ -0,0 +1,139 @@
+# Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Decodes the binary motor telemetry stream sent by the simulator (see
+`tap/communication/tcp-server/motor_telemetry.hpp`).
+
+Usage: python3 decode_motor_telemetry.py [--host HOST] [--port PORT] [--channels N ...]
+                                         [--file FILE] [--json]
+
+Connects to the simulator's TCP server, subscribing only to the given channels (0 for
+the motors on CAN bus 1, 1 for CAN bus 2) if any, unless a file holding a raw capture
+of the stream is given ("-" reads stdin). Prints one line per motor per batch, or with
+--json one JSON object per line in the format the simulator used to send:
+
+  {"messageType": "motor", "canBus": 1, "motorID": 513, "shaftRPM": 0, ...}
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+
+# Must match tap::communication::MotorTelemetry
+MAGIC = 0x4D54
+VERSION = 2
+
+# Must match tap::communication::MotorTelemetryHeader and MotorTelemetryRecord, little endian
+HEADER_FORMAT = "<HBBB3xII"
+RECORD_FORMAT = "<qIhhhBBbB2x"
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+
+FIRST_FEEDBACK_ID = 0x201
+
+
+def read_chunks(args):
+    if args.file is not None:
+        f = sys.stdin.buffer if args.file == "-" else open(args.file, "rb")
+        with f:
+            while chunk := f.read(4096):
+                yield chunk
+    else:
+        with socket.create_connection((args.host, args.port)) as sock:
+            if args.channels:
+                sock.sendall(f"subscribe {' '.join(map(str, args.channels))}\n".encode())
+            while chunk := sock.recv(4096):
+                yield chunk
+
+
+def decode_batches(chunks):
+    """
+    Yields (channel, sequence, time, records) for every batch, skipping bytes until the
+    next magic number if the stream is corrupted or joined mid batch.
+    """
+    buffer = bytearray()
+    for chunk in chunks:
+        buffer += chunk
+        while len(buffer) >= HEADER_SIZE:
+            magic, version, count, channel, sequence, time = struct.unpack_from(
+                HEADER_FORMAT, buffer
+            )
+            if magic != MAGIC or version != VERSION:
+                del buffer[0]
+                continue
+            size = HEADER_SIZE + count * RECORD_SIZE
+            if len(buffer) < size:
+                break
+            records = [
+                struct.unpack_from(RECORD_FORMAT, buffer, HEADER_SIZE + i * RECORD_SIZE)
+                for i in range(count)
+            ]
+            del buffer[:size]
+            yield channel, sequence, time, records
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the simulator's motor telemetry.")
+    parser.add_argument("--host", default="localhost", help="simulator host")
+    parser.add_argument("--port", type=int, default=2001, help="simulator telemetry port")
+    parser.add_argument(
+        "--channels", type=int, nargs="+", help="channels to subscribe to (default: all)"
+    )
+    parser.add_argument("--file", help="raw capture of the stream to decode instead")
+    parser.add_argument("--json", action="store_true", help="print JSON motor messages")
+    args = parser.parse_args()
+
+    expected_sequences = {}
+    try:
+        for channel, sequence, time, records in decode_batches(read_chunks(args)):
+            expected = expected_sequences.get(channel)
+            if expected is not None and sequence != expected:
+                dropped = (sequence - expected) & 0xFFFFFFFF
+                print(f"# channel {channel}: {dropped} batches dropped", file=sys.stderr)
+            expected_sequences[channel] = (sequence + 1) & 0xFFFFFFFF
+
+            for encoder, feedback_time, rpm, torque, output, bus, motor, temp, flags in records:
+                if args.json:
+                    message = {
+                        "messageType": "motor",
+                        "canBus": bus + 1,
+                        "motorID": FIRST_FEEDBACK_ID + motor,
+                        "shaftRPM": rpm,
+                        "torque": torque,
+                        "encoderValue": encoder,
+                        "desiredOutput": output,
+                        "temperature": temp,
+                        "online": bool(flags & 1),
+                        "time": feedback_time,
+                    }
+                    print(json.dumps(message), flush=True)
+                else:
+                    print(
+                        f"{time:>10} can{bus + 1} {FIRST_FEEDBACK_ID + motor:#x} "
+                        f"enc {encoder:>10} rpm {rpm:>6} torque {torque:>6} out {output:>6} "
+                        f"temp {temp:>3} {'online' if flags & 1 else 'offline'}",
+                        flush=True,
+                    )
+    except (KeyboardInterrupt, BrokenPipeError):
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,141 @@
+# Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Decodes the output of the `scheduler trace` terminal command (see
+`tap/control/scheduler_trace.hpp`) into a human readable timeline, followed by a
+per-command summary of how often each command was added and interrupted.
+
+Usage: python3 decode_scheduler_trace.py [terminal-log-file] [-o timeline-file]
+
+Reads from stdin if no log file is given. Lines that are not part of the trace
+are ignored, so a raw capture of the terminal session may be passed in.
+"""
+
+import argparse
+import struct
+import sys
+from collections import defaultdict
+
+# Must match tap::control::SchedulerTraceEvent
+EVENTS = [
+    "ADD_COMMAND",
+    "REMOVE_COMMAND",
+    "EXECUTE_START",
+    "EXECUTE_END",
+    "REFRESH_START",
+    "REFRESH_END",
+    "SAFE_DISCONNECT",
+    "SAFE_RECONNECT",
+]
+SUBSYSTEM_EVENTS = {"REFRESH_START", "REFRESH_END"}
+NO_ID_EVENTS = {"SAFE_DISCONNECT", "SAFE_RECONNECT"}
+
+# Must match tap::control::SchedulerTraceRecord, little endian
+RECORD_FORMAT = "<IHBB"
+
+
+def parse_trace(lines):
+    commands = {}
+    subsystems = {}
+    records = []
+    dropped = 0
+    in_trace = False
+
+    for line in lines:
+        line = line.strip()
+        if line.startswith("trace begin"):
+            in_trace = True
+            commands.clear()
+            subsystems.clear()
+            records.clear()
+            dropped = int(line.split()[3])
+        elif line == "trace end":
+            in_trace = False
+        elif in_trace and line.startswith("C "):
+            _, ident, name = line.split(" ", 2)
+            commands[int(ident)] = name
+        elif in_trace and line.startswith("S "):
+            _, ident, name = line.split(" ", 2)
+            subsystems[int(ident)] = name
+        elif in_trace and line.startswith("R "):
+            records.append(struct.unpack(RECORD_FORMAT, bytes.fromhex(line[2:])))
+
+    return commands, subsystems, records, dropped
+
+
+def write_timeline(out, commands, subsystems, records, dropped):
+    if dropped != 0:
+        out.write(f"# {dropped} older records were overwritten\n")
+    out.write(f"{'time (us)':>12} {'delta':>8}  {'event':<16} name\n")
+
+    adds = defaultdict(int)
+    interrupts = defaultdict(int)
+    prev_time = records[0][0] if records else 0
+
+    for time, ident, event_id, arg in records:
+        event = EVENTS[event_id] if event_id < len(EVENTS) else f"UNKNOWN({event_id})"
+        if event in NO_ID_EVENTS:
+            name = ""
+        elif event in SUBSYSTEM_EVENTS:
+            name = subsystems.get(ident, f"subsystem {ident}")
+        else:
+            name = commands.get(ident, f"command {ident}")
+
+        extra = ""
+        if event == "REMOVE_COMMAND":
+            extra = " (interrupted)" if arg else " (finished)"
+            if arg:
+                interrupts[name] += 1
+        elif event == "ADD_COMMAND":
+            adds[name] += 1
+        elif event == "EXECUTE_END" and arg:
+            extra = " (finished)"
+
+        # Unsigned 32 bit microsecond timestamps wrap
+        delta = (time - prev_time) & 0xFFFFFFFF
+        prev_time = time
+        out.write(f"{time:>12} {delta:>8}  {event:<16} {name}{extra}\n")
+
+    out.write("\ncommand summary (adds / interrupted removals):\n")
+    for name in sorted(adds.keys() | interrupts.keys()):
+        out.write(f"  {name}: {adds[name]} / {interrupts[name]}\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a CommandScheduler trace dump.")
+    parser.add_argument("log", nargs="?", help="terminal output containing the trace dump")
+    parser.add_argument("-o", "--output", help="file to write the timeline to")
+    args = parser.parse_args()
+
+    if args.log is None:
+        lines = sys.stdin.readlines()
+    else:
+        with open(args.log) as f:
+            lines = f.readlines()
+
+    commands, subsystems, records, dropped = parse_trace(lines)
+
+    if args.output is None:
+        write_timeline(sys.stdout, commands, subsystems, records, dropped)
+    else:
+        with open(args.output, "w") as out:
+            write_timeline(out, commands, subsystems, records, dropped)
+
+
+if __name__ == "__main__":
+    main()
@@ -19,13 +19,14 @@ from SCons.Script import *
 
 
 CMD_LINE_ARGS                       = 1
-TEST_BUILD_TARGET_ACCEPTED_ARGS     = ["build-tests", "run-tests", "run-tests-gcov"]
+TEST_BUILD_TARGET_ACCEPTED_ARGS     = ["build-tests", "run-tests", "run-tests-gcov", "run-benchmarks"]
 SIM_BUILD_TARGET_ACCEPTED_ARGS      = ["build-sim", "run-sim"]
 HARDWARE_BUILD_TARGET_ACCEPTED_ARGS = ["build", "run", "size", "gdb"]
 VALID_BUILD_PROFILES                = ["debug", "release", "fast"]
 VALID_PROFILING_TYPES               = ["true", "false"]
+VALID_TRACE_TYPES                   = ["true", "false"]
 
-USAGE = "Usage: scons <target> [profile=<debug|release|fast>] [profiling=<true|false>]\n\
+USAGE = "Usage: scons <target> [profile=<debug|release|fast>] [profiling=<true|false>] [trace=<true|false>]\n\
     \"<target>\" is one of:\n\
         - \"build\": build all code for the hardware platform.\n\
         - \"run\": build all code for the hardware platform, and deploy it to the board via a connected ST-Link.\n\
@@ -34,6 +35,7 @@ USAGE = "Usage: scons <target> [profile=<debug|release|fast>] [profiling=<true|f
         - \"build-tests\": build core code and tests for the current host platform.\n\
         - \"run-tests\": build core code and tests for the current host platform, and execute them locally with the test runner.\n\
         - \"run-tests-gcov\": builds core code and tests, executes them locally, and captures and prints code coverage information\n\
+        - \"run-benchmarks\": build core code and tests for the current host platform, and execute only the microbenchmarks, writing results (ns/op) to \"benchmark-results.jsonl\" in the build directory.\n\
         - \"build-sim\": build all code for the simulated environment, for the current host platform.\n\
         - \"run-sim\": build all code for the simulated environment, for the current host platform, and execute the simulator locally."
 
@@ -42,7 +44,8 @@ def parse_args():
     args = {
         "TARGET_ENV": "",
         "BUILD_PROFILE": "",
-        "PROFILING": ""
+        "PROFILING": "",
+        "TRACE": ""
     }
     if len(COMMAND_LINE_TARGETS) > CMD_LINE_ARGS:
         raise Exception("You did not enter the correct number of arguments.\n" + USAGE)
@@ -71,4 +74,8 @@ def parse_args():
     if args["PROFILING"] not in VALID_PROFILING_TYPES:
         raise Exception("You specified an invalid profiling type.\n" + USAGE)
 
+    args["TRACE"] = ARGUMENTS.get("trace", "false")
+    if args["TRACE"] not in VALID_TRACE_TYPES:
+        raise Exception("You specified an invalid trace type.\n" + USAGE)
+
     return args
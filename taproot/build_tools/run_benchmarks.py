@@ -0,0 +1,61 @@
+# Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+
+
+import os
+import subprocess
+from SCons.Script import *
+
+
+# Benchmarks are regular gtest tests whose suite name starts with this prefix,
+# see taproot/test/tap/benchmark/benchmark.hpp
+BENCHMARK_GTEST_FILTER  = 'Benchmark*'
+BENCHMARK_OUTPUT_ENV    = 'TAPROOT_BENCHMARK_OUTPUT'
+BENCHMARK_OUTPUT_FILE   = 'benchmark-results.jsonl'
+
+
+def run_tests(env, source, alias="run_tests"):
+    def run_tests_action(target, source, env):
+        try:
+            subprocess.run([source[0].abspath, '--gtest_filter=-' + BENCHMARK_GTEST_FILTER], check=True)
+        except subprocess.CalledProcessError:
+            exit(1)
+
+    action = Action(run_tests_action, cmdstr="")
+    return env.AlwaysBuild(env.Alias(alias, source, action))
+
+
+def run_benchmarks(env, source, alias="run_benchmarks"):
+    def run_benchmarks_action(target, source, env):
+        output_file = os.path.join(env["BUILDPATH"], BENCHMARK_OUTPUT_FILE)
+        run_env = dict(os.environ)
+        run_env[BENCHMARK_OUTPUT_ENV] = output_file
+        try:
+            subprocess.run([source[0].abspath, '--gtest_filter=' + BENCHMARK_GTEST_FILTER], env=run_env, check=True)
+        except subprocess.CalledProcessError:
+            exit(1)
+        print("Benchmark results written to " + output_file)
+
+    action = Action(run_benchmarks_action, cmdstr="")
+    return env.AlwaysBuild(env.Alias(alias, source, action))
+
+def generate(env, **kw):
+    env.AddMethod(run_tests, "RunTests")
+    env.AddMethod(run_benchmarks, "RunBenchmarks")
+
+def exists(env):
+    return env.Detect("run_benchmarks")
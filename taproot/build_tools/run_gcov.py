@@ -31,7 +31,7 @@ COVERAGE_INFO_FILE  = os.path.join(GCOV_OUT_DIR, 'coverage.info')
 def run_gcov(env, source, alias="run_gcov"):
     def run_gcov_action(target, source, env):
         try:
-            subprocess.run([source[0].abspath], check=True)
+            subprocess.run([source[0].abspath, '--gtest_filter=-Benchmark*'], check=True)
         except subprocess.CalledProcessError as e:
             print(e.output())
             exit(1)
@@ -184,6 +184,7 @@
 #include "platform/timer/timer_1.hpp"
 #include "platform/timer/timer_10.hpp"
 #include "platform/timer/timer_4.hpp"
+#include "platform/timer/timer_7.hpp"
 #include "platform/timer/timer_8.hpp"
 #include "platform/uart/uart_1.hpp"
 #include "platform/uart/uart_3.hpp"
@@ -29,13 +29,6 @@
 #define CAN_BTR_TS2_POS		20
 #define CAN_BTR_TS1_POS		16
 
-// ----------------------------------------------------------------------------
-static modm::atomic::Queue<modm::can::Message, 32> txQueue;
-struct RxMessage {
-    modm::can::Message message;
-    uint8_t filter_id;
-};
-static modm::atomic::Queue<RxMessage, 32> rxQueue;
 // ----------------------------------------------------------------------------
 bool
 modm::platform::Can1::initializeWithPrescaler(
@@ -83,7 +76,6 @@ modm::platform::Can1::initializeWithPrescaler(
 	// FIFO1 Overrun, FIFO0 Overrun
 	CAN1->IER = CAN_IER_FOVIE1 | CAN_IER_FOVIE0;
 
-	CAN1->IER |= CAN_IER_TMEIE;
 	// Set vector priority
 	NVIC_SetPriority(CAN1_RX0_IRQn, interruptPriority);
 	NVIC_SetPriority(CAN1_RX1_IRQn, interruptPriority);
@@ -91,10 +83,6 @@ modm::platform::Can1::initializeWithPrescaler(
 	// Register Interrupts at the NVIC
 	NVIC_EnableIRQ(CAN1_RX0_IRQn);
 	NVIC_EnableIRQ(CAN1_RX1_IRQn);
-
-	NVIC_EnableIRQ(CAN1_TX_IRQn);
-	NVIC_SetPriority(CAN1_TX_IRQn, interruptPriority);
-	CAN1->IER |= CAN_IER_FMPIE1 | CAN_IER_FMPIE0;
 	CAN1->BTR =
 			  ((1 - 1) << CAN_BTR_SJW_POS) |		// SJW (1 to 4 possible)
 			((bs2 - 1) << CAN_BTR_TS2_POS) |		// BS2 Samplepoint
@@ -170,86 +158,6 @@ readMailbox(modm::can::Message& message, uint32_t mailboxId, uint8_t* filter_id)
 	reinterpret_cast<uint32_t *>(data)[1] = mailbox->RDHR;
 }
 
-// ----------------------------------------------------------------------------
-/* Transmit Interrupt
- *
- * Generated when Transmit Mailbox 0..2 becomes empty.
- */
-
-MODM_ISR(CAN1_TX)
-{
-	uint32_t mailbox;
-	uint32_t tsr = CAN1->TSR;
-
-	if (tsr & CAN_TSR_RQCP2) {
-		mailbox = 2;
-		CAN1->TSR = CAN_TSR_RQCP2;
-	}
-	else if (tsr & CAN_TSR_RQCP1) {
-		mailbox = 1;
-		CAN1->TSR = CAN_TSR_RQCP1;
-	}
-	else {
-		mailbox = 0;
-		CAN1->TSR = CAN_TSR_RQCP0;
-	}
-
-	if (txQueue.isNotEmpty())
-	{
-		sendMailbox(txQueue.get(), mailbox);
-		txQueue.pop();
-	}
-}
-
-// ----------------------------------------------------------------------------
-/* FIFO0 Interrupt
- *
- * Generated on a new received message, FIFO0 full condition and Overrun
- * Condition.
- */
-MODM_ISR(CAN1_RX0)
-{
-	if (not modm_assert_continue_ignore(not (CAN1->RF0R & CAN_RF0R_FOVR0),
-			"can.rx.hw0", "CAN receive hardware buffer overflowed!", 1))
-	{
-		// release overrun flag & access the next message
-		CAN1->RF0R = CAN_RF0R_FOVR0 | CAN_RF0R_RFOM0;
-	}
-
-	RxMessage rxMessage;
-	readMailbox(rxMessage.message, 0, &(rxMessage.filter_id));
-
-	// Release FIFO (access the next message)
-	CAN1->RF0R = CAN_RF0R_RFOM0;
-
-	modm_assert_continue_ignore(rxQueue.push(rxMessage), "can.rx.sw0",
-		"CAN receive software buffer overflowed!", 1);
-}
-
-// ----------------------------------------------------------------------------
-/* FIFO1 Interrupt
- *
- * See FIFO0 Interrupt
- */
-MODM_ISR(CAN1_RX1)
-{
-	if (not modm_assert_continue_ignore(not (CAN1->RF1R & CAN_RF1R_FOVR1),
-			"can.rx.hw1", "CAN receive hardware buffer overflowed!", 1))
-	{
-		// release overrun flag & access the next message
-		CAN1->RF1R = CAN_RF1R_FOVR1 | CAN_RF1R_RFOM1;
-	}
-
-	RxMessage rxMessage;
-	readMailbox(rxMessage.message, 1, &(rxMessage.filter_id));
-
-	// Release FIFO (access the next message)
-	CAN1->RF1R = CAN_RF1R_RFOM1;
-
-	modm_assert_continue_ignore(rxQueue.push(rxMessage), "can.rx.sw1",
-		"CAN receive software buffer overflowed!", 1);
-}
-
 // ----------------------------------------------------------------------------
 void
 modm::platform::Can1::setMode(Mode mode)
@@ -286,49 +194,48 @@ modm::platform::Can1::setAutomaticRetransmission(bool retransmission)
 bool
 modm::platform::Can1::isMessageAvailable()
 {
-	return rxQueue.isNotEmpty();
+	// Check if there are any messages pending in the receive registers
+	return ((CAN1->RF0R & CAN_RF0R_FMP0) > 0 || (CAN1->RF1R & CAN_RF1R_FMP1) > 0);
 }
 
 // ----------------------------------------------------------------------------
 bool
 modm::platform::Can1::getMessage(can::Message& message, uint8_t *filter_id)
 {
-	if (rxQueue.isEmpty())
+	if (CAN1->RF0R & CAN_RF0R_FMP0)
 	{
-		// no message in the receive buffer
-		return false;
+		readMailbox(message, 0, filter_id);
+
+		// Release FIFO (access the next message)
+		CAN1->RF0R = CAN_RF0R_RFOM0;
+		return true;
 	}
-	else {
-        auto& rxMessage = rxQueue.get();
-		memcpy(&message, &rxMessage.message, sizeof(message));
-        if(filter_id != nullptr) (*filter_id) = rxMessage.filter_id;
-		rxQueue.pop();
+	else if (CAN1->RF1R & CAN_RF1R_FMP1)
+	{
+		readMailbox(message, 1, filter_id);
+
+		// Release FIFO (access the next message)
+		CAN1->RF1R = CAN_RF1R_RFOM1;
 		return true;
 	}
+	return false;
 }
 
 // ----------------------------------------------------------------------------
 bool
 modm::platform::Can1::isReadyToSend()
 {
-	return txQueue.isNotFull();
+	return ((CAN1->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) != 0);
 }
 
 // ----------------------------------------------------------------------------
 bool
 modm::platform::Can1::sendMessage(const can::Message& message)
 {
-	// This function is not reentrant. If one of the mailboxes is empty it
-	// means that the software buffer is empty too. Therefore the mailbox
-	// will stay empty and won't be taken by an interrupt.
 	if ((CAN1->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) == 0)
 	{
 		// All mailboxes used at the moment
-		if (not modm_assert_continue_ignore(txQueue.push(message), "can.tx",
-				"CAN transmit software buffer overflowed!", 1)) {
-			return false;
-		}
-		return true;
+		return false;
 	}
 	else {
 		// Get number of the first free mailbox
@@ -65,8 +65,8 @@ public:
 	};
 
 	// Expose jinja template parameters to be checked by e.g. drivers or application
-	static constexpr size_t RxBufferSize = 32;
-	static constexpr size_t TxBufferSize = 32;
+	static constexpr size_t RxBufferSize = 0;
+	static constexpr size_t TxBufferSize = 0;
 
 private:
 	/// Private Initializer with computed prescaler and timing constants
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOG_HISTOGRAM_HPP_
+#define LOG_HISTOGRAM_HPP_
+
+#include <cstdint>
+
+namespace tap
+{
+namespace algorithms
+{
+/**
+ * A fixed memory histogram of unsigned values (typically latencies, in microseconds) with
+ * logarithmically sized buckets, supporting percentile queries.
+ *
+ * Values below `2^SUB_BUCKET_BITS` each get their own bucket. Above that, every power of two
+ * range is split into `2^SUB_BUCKET_BITS` equally sized buckets, so a value reported by
+ * `percentile` is at most `1 / 2^SUB_BUCKET_BITS` (relatively) above the true value. Values at or
+ * above `2^VALUE_BITS` are counted in the last bucket. Min, max and mean are exact.
+ *
+ * ```
+ * LogHistogram<3, 20> latency;  // 12.5% resolution, up to ~1 s in us, 144 buckets
+ * latency.add(elapsedUs);
+ * uint32_t p99 = latency.percentile(0.99f);
+ * ```
+ *
+ * @tparam SUB_BUCKET_BITS log2 of the number of buckets per power of two.
+ * @tparam VALUE_BITS log2 of the smallest value that is no longer resolved.
+ */
+template <int SUB_BUCKET_BITS, int VALUE_BITS>
+class LogHistogram
+{
+public:
+    static_assert(SUB_BUCKET_BITS > 0 && SUB_BUCKET_BITS < VALUE_BITS, "invalid bucket layout");
+    static_assert(VALUE_BITS <= 32, "values are 32 bit");
+
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKET_COUNT = SUB_BUCKET_COUNT * (VALUE_BITS - SUB_BUCKET_BITS + 1);
+
+    LogHistogram() { reset(); }
+
+    void add(uint32_t value)
+    {
+        counts[bucketIndex(value)]++;
+        count++;
+        sum += value;
+        if (value < min)
+        {
+            min = value;
+        }
+        if (value > max)
+        {
+            max = value;
+        }
+    }
+
+    /**
+     * @param[in] fraction The percentile to query, as a fraction in [0, 1] (0.99 for p99).
+     * @return The upper bound of the bucket holding the value of rank `fraction * count`
+     *      (rounded to the nearest rank), clamped to the largest value added. 0 if empty.
+     */
+    uint32_t percentile(float fraction) const
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(fraction * count + 0.5f);
+        if (rank == 0)
+        {
+            rank = 1;
+        }
+
+        uint64_t cumulative = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++)
+        {
+            cumulative += counts[i];
+            if (cumulative >= rank)
+            {
+                uint32_t upper = bucketUpperBound(i);
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+
+    uint32_t getCount() const { return count; }
+    uint32_t getMin() const { return count == 0 ? 0 : min; }
+    uint32_t getMax() const { return max; }
+    uint32_t getMean() const { return count == 0 ? 0 : sum / count; }
+
+    void reset()
+    {
+        for (uint32_t &bucket : counts)
+        {
+            bucket = 0;
+        }
+        count = 0;
+        sum = 0;
+        min = UINT32_MAX;
+        max = 0;
+    }
+
+    static int bucketIndex(uint32_t value)
+    {
+        if (value < static_cast<uint32_t>(SUB_BUCKET_COUNT))
+        {
+            return value;
+        }
+        if (VALUE_BITS < 32 && value >= (UINT64_C(1) << VALUE_BITS))
+        {
+            return BUCKET_COUNT - 1;
+        }
+
+        int msb = 31 - __builtin_clz(value);
+        int shift = msb - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKET_COUNT + static_cast<int>(value >> shift) -
+               SUB_BUCKET_COUNT;
+    }
+
+    /**
+     * @return The largest value counted in bucket `index`.
+     */
+    static uint32_t bucketUpperBound(int index)
+    {
+        if (index < SUB_BUCKET_COUNT)
+        {
+            return index;
+        }
+
+        int shift = index / SUB_BUCKET_COUNT - 1;
+        uint64_t lower = static_cast<uint64_t>(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT)
+                         << shift;
+        return lower + (UINT64_C(1) << shift) - 1;
+    }
+
+private:
+    uint32_t counts[BUCKET_COUNT];
+    uint32_t count;
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+};  // class LogHistogram
+
+}  // namespace algorithms
+
+}  // namespace tap
+
+#endif  // LOG_HISTOGRAM_HPP_
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "control_tick.hpp"
+
+#include <algorithm>
+
+#include "tap/drivers.hpp"
+#include "tap/errors/create_errors.hpp"
+
+#include "clock.hpp"
+
+#if defined(PLATFORM_HOSTED) && !defined(ENV_UNIT_TESTS)
+#include <chrono>
+#include <thread>
+#elif !defined(PLATFORM_HOSTED)
+#include "tap/board/board.hpp"
+
+#include "modm/architecture/interface/interrupt.hpp"
+#endif
+
+namespace tap
+{
+namespace arch
+{
+#ifndef PLATFORM_HOSTED
+/// The tick started on the MCB, called from the timer interrupt.
+static ControlTick *interruptControlTick = nullptr;
+
+MODM_ISR(TIM7)
+{
+    Timer7::acknowledgeInterruptFlags(Timer7::InterruptFlag::Update);
+    if (interruptControlTick != nullptr)
+    {
+        interruptControlTick->tick();
+    }
+}
+#endif
+
+ControlTick::Lock::Lock(ControlTick *controlTick) : controlTick(controlTick)
+{
+    // Only the outermost lock masks the tick, nested ones would deadlock (simulator) or unmask
+    // it early (MCB)
+    if (controlTick->lockDepth++ != 0)
+    {
+        return;
+    }
+#if defined(PLATFORM_HOSTED) && !defined(ENV_UNIT_TESTS)
+    controlTick->tickMutex.lock();
+#elif !defined(PLATFORM_HOSTED)
+    NVIC_DisableIRQ(TIM7_IRQn);
+    __DSB();
+    __ISB();
+#endif
+}
+
+ControlTick::Lock::~Lock()
+{
+    if (--controlTick->lockDepth != 0)
+    {
+        return;
+    }
+#if defined(PLATFORM_HOSTED) && !defined(ENV_UNIT_TESTS)
+    controlTick->tickMutex.unlock();
+#elif !defined(PLATFORM_HOSTED)
+    if (controlTick->running)
+    {
+        NVIC_EnableIRQ(TIM7_IRQn);
+    }
+#endif
+}
+
+#if defined(PLATFORM_HOSTED) && !defined(ENV_UNIT_TESTS)
+ControlTick::ControlTick(Drivers *drivers) : drivers(drivers), running(false) {}
+
+ControlTick::~ControlTick()
+{
+    if (tickThread != nullptr)
+    {
+        running = false;
+        tickThread->join();
+        delete tickThread;
+    }
+}
+#else
+ControlTick::ControlTick(Drivers *drivers) : drivers(drivers) {}
+
+ControlTick::~ControlTick() = default;
+#endif
+
+void ControlTick::start(uint32_t period, TickCallback callback)
+{
+    if (running)
+    {
+        RAISE_ERROR(drivers, "control tick already started");
+        return;
+    }
+    if (period == 0 || callback == nullptr)
+    {
+        RAISE_ERROR(drivers, "invalid control tick period or callback");
+        return;
+    }
+
+    this->period = period;
+    this->callback = callback;
+    running = true;
+
+#if defined(PLATFORM_HOSTED) && !defined(ENV_UNIT_TESTS)
+    tickThread = new std::thread(&ControlTick::runTickThread, this);
+#elif !defined(PLATFORM_HOSTED)
+    interruptControlTick = this;
+
+    Timer7::enable();
+    Timer7::setMode(Timer7::Mode::UpCounter);
+    Timer7::setPeriod<Board::SystemClock>(period);
+    // setPeriod generates an update event, clear it so the first tick is a full period away
+    Timer7::acknowledgeInterruptFlags(Timer7::InterruptFlag::Update);
+    Timer7::enableInterrupt(Timer7::Interrupt::Update);
+    Timer7::enableInterruptVector(true, INTERRUPT_PRIORITY);
+    Timer7::start();
+#endif
+}
+
+void ControlTick::tick()
+{
+    uint32_t tickStart = clock::getTimeMicroseconds();
+
+    if (stats.ticks != 0)
+    {
+        uint32_t measuredPeriod = tickStart - prevTickStart;
+        uint32_t jitter =
+            measuredPeriod > period ? measuredPeriod - period : period - measuredPeriod;
+
+        stats.periods++;
+        stats.lastPeriod = measuredPeriod;
+        stats.minPeriod = std::min(stats.minPeriod, measuredPeriod);
+        stats.maxPeriod = std::max(stats.maxPeriod, measuredPeriod);
+        stats.periodSum += measuredPeriod;
+        stats.maxJitter = std::max(stats.maxJitter, jitter);
+        stats.jitterSum += jitter;
+    }
+    stats.ticks++;
+    prevTickStart = tickStart;
+
+    if (callback != nullptr)
+    {
+        callback(drivers);
+    }
+
+    uint32_t execution = clock::getTimeMicroseconds() - tickStart;
+    stats.lastExecution = execution;
+    stats.maxExecution = std::max(stats.maxExecution, execution);
+    if (execution > period)
+    {
+        stats.overruns++;
+    }
+}
+
+void ControlTick::resetStats()
+{
+    Lock lock(this);
+    stats = {};
+}
+
+#if defined(PLATFORM_HOSTED) && !defined(ENV_UNIT_TESTS)
+void ControlTick::runTickThread()
+{
+    const auto tickPeriod = std::chrono::microseconds(period);
+    auto nextTick = std::chrono::steady_clock::now() + tickPeriod;
+
+    while (running)
+    {
+        std::this_thread::sleep_until(nextTick);
+        {
+            std::lock_guard<std::mutex> lock(tickMutex);
+            tick();
+        }
+
+        // Like the timer, skip ticks that were missed entirely rather than running them late
+        auto now = std::chrono::steady_clock::now();
+        do
+        {
+            nextTick += tickPeriod;
+        } while (nextTick <= now);
+    }
+}
+#endif
+}  // namespace arch
+
+}  // namespace tap
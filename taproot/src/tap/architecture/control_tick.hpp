@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTROL_TICK_HPP_
+#define CONTROL_TICK_HPP_
+
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#if defined(PLATFORM_HOSTED) && !defined(ENV_UNIT_TESTS)
+#include <atomic>
+#include <mutex>
+
+namespace std
+{
+class thread;
+}
+#endif
+
+namespace tap
+{
+class Drivers;
+namespace arch
+{
+/**
+ * Runs the robot's control pass (command scheduler, motor output) at a fixed period from a
+ * timer rather than from a busy-polling main loop, so that the control cadence does not depend
+ * on how long I/O polling takes.
+ *
+ * On the MCB a basic timer (`Timer7`) interrupt calls the tick callback. Its priority is below
+ * that of the peripheral (CAN, UART) interrupts, so the tick only preempts the main thread,
+ * which is left to poll I/O in the background. In the simulator a dedicated thread sleeping
+ * until each deadline calls the tick callback instead. In unit tests nothing calls the
+ * callback, call `tick()` directly.
+ *
+ * Background code that touches state used by the control pass (i.e. anything that updates
+ * motors, the remote or adds commands) must hold a `ControlTick::Lock` while doing so:
+ *
+ * ```
+ * drivers->controlTick.start(2'000, runControl);
+ * while (true)
+ * {
+ *     {
+ *         tap::arch::ControlTick::Lock lock(&drivers->controlTick);
+ *         drivers->canRxHandler.pollCanData();
+ *     }
+ *     ...
+ * }
+ * ```
+ *
+ * Each tick records the time since the previous tick, from which the period and jitter
+ * statistics returned by `getStats()` are computed.
+ */
+class ControlTick
+{
+public:
+    using TickCallback = void (*)(Drivers *drivers);
+
+    /**
+     * NVIC priority of the tick interrupt (0 is highest, 15 lowest). Lower than the CAN and UART
+     * interrupt priorities so that reception is never delayed by a control pass.
+     */
+    static constexpr uint32_t INTERRUPT_PRIORITY = 14;
+
+    /**
+     * Period and jitter statistics, all in microseconds. Jitter is the absolute difference
+     * between the measured time between two ticks and the configured period.
+     */
+    struct TickStats
+    {
+        uint32_t ticks = 0;
+        /// Number of measured periods, i.e. `ticks - 1` since the last reset.
+        uint32_t periods = 0;
+        uint32_t minPeriod = UINT32_MAX;
+        uint32_t maxPeriod = 0;
+        uint32_t lastPeriod = 0;
+        uint64_t periodSum = 0;
+        uint32_t maxJitter = 0;
+        uint64_t jitterSum = 0;
+        uint32_t maxExecution = 0;
+        uint32_t lastExecution = 0;
+        /// Number of ticks whose callback ran for longer than the period.
+        uint32_t overruns = 0;
+
+        uint32_t meanPeriod() const { return periods == 0 ? 0 : periodSum / periods; }
+        uint32_t meanJitter() const { return periods == 0 ? 0 : jitterSum / periods; }
+    };
+
+    /**
+     * Prevents the tick callback from starting while in scope. On the MCB this masks the tick
+     * interrupt, in the simulator this holds the mutex the tick thread takes around each tick.
+     * Keep the locked region short, a tick delayed by a lock shows up as jitter. Locks may be
+     * nested, only the outermost one masks and unmasks the tick. Only take locks from the
+     * background (main) thread, never from the tick callback.
+     */
+    class Lock
+    {
+    public:
+        explicit Lock(ControlTick *controlTick);
+        DISALLOW_COPY_AND_ASSIGN(Lock);
+        ~Lock();
+
+    private:
+        ControlTick *controlTick;
+    };
+
+    ControlTick(Drivers *drivers);
+    DISALLOW_COPY_AND_ASSIGN(ControlTick);
+    mockable ~ControlTick();
+
+    /**
+     * Starts calling `callback` every `period` microseconds. May only be called once.
+     *
+     * @param[in] period The tick period, in microseconds. Must be nonzero.
+     * @param[in] callback The control pass to run each tick.
+     */
+    mockable void start(uint32_t period, TickCallback callback);
+
+    mockable bool isRunning() const { return running; }
+
+    mockable uint32_t getPeriod() const { return period; }
+
+    /**
+     * Records period statistics and runs the tick callback. Called from the timer interrupt on
+     * the MCB and from the tick thread in the simulator.
+     */
+    void tick();
+
+    /**
+     * @return `true` if a `Lock` on this tick is in scope.
+     */
+    bool isLocked() const { return lockDepth != 0; }
+
+    const TickStats &getStats() const { return stats; }
+
+    /**
+     * Clears the statistics. Takes a `Lock`, so it may be called whether or not the caller
+     * already holds one.
+     */
+    void resetStats();
+
+private:
+    Drivers *drivers;
+
+    uint32_t period = 0;
+
+    TickCallback callback = nullptr;
+
+    /// Start time of the previous tick, in microseconds. Only valid if `stats.ticks != 0`.
+    uint32_t prevTickStart = 0;
+
+    TickStats stats;
+
+    /// Number of `Lock`s in scope. Only touched by the background thread.
+    int lockDepth = 0;
+
+#if defined(PLATFORM_HOSTED) && !defined(ENV_UNIT_TESTS)
+    std::atomic<bool> running;
+
+    std::thread *tickThread = nullptr;
+
+    std::mutex tickMutex;
+
+    void runTickThread();
+#else
+    bool running = false;
+#endif
+};  // class ControlTick
+
+}  // namespace arch
+
+}  // namespace tap
+
+#endif  // CONTROL_TICK_HPP_
@@ -19,92 +19,223 @@
 
 #include "profiler.hpp"
 
-#include "../algorithms/math_user_utils.hpp"
+#include <cstring>
 
 #include "clock.hpp"
 
+#ifdef PLATFORM_HOSTED
+#include <cstdio>
+#endif
+
 #ifdef RUN_WITH_PROFILING
 
 namespace tap
 {
 namespace arch
 {
-static int findIndex(
-    modm::DynamicArray<modm::Pair<const char*, Profiler::MinMaxAvgStruct>>& times,
-    const char* profile,
-    bool shouldAdd)
+const char* Profiler::probeNames[Profiler::MAX_PROBES] = {};
+int Profiler::probeCount = 0;
+
+int Profiler::registerProbe(const char* name)
 {
-    auto iter = times.begin();
+    int probe = findProbe(name);
+    if (probe != INVALID_PROBE || probeCount == MAX_PROBES || name == nullptr)
+    {
+        return probe;
+    }
 
-    for (int i = 0; iter != times.end(); ++iter, ++i)
+    probeNames[probeCount] = name;
+    return probeCount++;
+}
+
+int Profiler::findProbe(const char* name)
+{
+    if (name == nullptr)
+    {
+        return INVALID_PROBE;
+    }
+    for (int i = 0; i < probeCount; i++)
     {
-        if ((*iter).getFirst() == profile || strcmp((*iter).getFirst(), profile) == 0)
+        if (probeNames[i] == name || strcmp(probeNames[i], name) == 0)
         {
             return i;
         }
     }
+    return INVALID_PROBE;
+}
+
+const char* Profiler::getProbeName(int probe)
+{
+    return (probe >= 0 && probe < probeCount) ? probeNames[probe] : nullptr;
+}
+
+void Profiler::push(int probe)
+{
+    if (depth < MAX_DEPTH)
+    {
+        // Nested probes of an untracked probe are untracked too, rather than becoming roots
+        int node = NO_CALL_NODE;
+        if (probe != INVALID_PROBE && (depth == 0 || nodeStack[depth - 1] != NO_CALL_NODE))
+        {
+            node = findOrAddCallNode(depth == 0 ? NO_CALL_NODE : nodeStack[depth - 1], probe);
+        }
+
+        probeStack[depth] = probe;
+        nodeStack[depth] = node;
+        childTimeStack[depth] = 0;
+        timeStack[depth] = tap::arch::clock::getTimeMicroseconds();
+    }
+    if (depth >= MAX_DEPTH || probe == INVALID_PROBE)
+    {
+        droppedCount++;
+    }
+    depth++;
+}
+
+void Profiler::pop()
+{
+    if (depth == 0)
+    {
+        return;
+    }
+    depth--;
+    if (depth >= MAX_DEPTH)
+    {
+        return;
+    }
 
-    if (!shouldAdd)
+    uint32_t elapsed = tap::arch::clock::getTimeMicroseconds() - timeStack[depth];
+    if (depth > 0)
     {
-        return -1;
+        childTimeStack[depth - 1] += elapsed;
     }
 
-    times.append({profile, {}});
+    int probe = probeStack[depth];
+    if (probe == INVALID_PROBE)
+    {
+        return;
+    }
 
-    return times.getSize() - 1;
+    times[probe].add(elapsed);
+
+    if (nodeStack[depth] != NO_CALL_NODE)
+    {
+        CallNode& node = callNodes[nodeStack[depth]];
+        uint32_t childTime = childTimeStack[depth];
+        node.count++;
+        node.inclusiveTime += elapsed;
+        node.exclusiveTime += elapsed > childTime ? elapsed - childTime : 0;
+    }
+
+#ifdef PLATFORM_HOSTED
+    if (chromeTracing && chromeTraceEvents.size() < chromeTraceCapacity)
+    {
+        chromeTraceEvents.push_back({timeStack[depth], elapsed, probe});
+    }
+#endif
 }
 
-static Profiler::MinMaxAvgStruct find(
-    modm::DynamicArray<modm::Pair<const char*, Profiler::MinMaxAvgStruct>>& times,
-    const char* profile,
-    bool shouldAdd)
+int Profiler::findOrAddCallNode(int parent, int probe)
 {
-    int index = findIndex(times, profile, shouldAdd);
+    int& firstSibling = parent == NO_CALL_NODE ? firstRootCallNode : callNodes[parent].firstChild;
+
+    for (int node = firstSibling; node != NO_CALL_NODE; node = callNodes[node].nextSibling)
+    {
+        if (callNodes[node].probe == probe)
+        {
+            return node;
+        }
+    }
 
-    if (index != -1)
+    if (callNodeCount == MAX_CALL_NODES)
     {
-        return times[index].getSecond();
+        return NO_CALL_NODE;
     }
 
-    return {};
+    int node = callNodeCount++;
+    callNodes[node].probe = probe;
+    callNodes[node].parent = parent;
+    callNodes[node].nextSibling = firstSibling;
+    firstSibling = node;
+    return node;
 }
 
-void Profiler::push(const char* profile)
+const Profiler::LatencyHistogram& Profiler::getHistogram(int probe) const
 {
-    profileStack.prepend(profile);
-    profiles.append(profile);
-    timeStack.prepend(tap::arch::clock::getTimeMicroseconds());
+    static const LatencyHistogram noTimes;
+    return (probe >= 0 && probe < probeCount) ? times[probe] : noTimes;
 }
-void Profiler::pop()
-{
-    const char* profile = profileStack.getFront();
-    uint32_t ellapsedTime = tap::arch::clock::getTimeMicroseconds() - timeStack.getFront();
-    timeStack.removeFront();
-    profileStack.removeFront();
 
-    MinMaxAvgStruct time = find(times, profile, true);
+void Profiler::reset(int probe)
+{
+    if (probe >= 0 && probe < probeCount)
+    {
+        times[probe].reset();
+    }
+}
 
-    if (time.min > ellapsedTime)
+void Profiler::resetAll()
+{
+    for (LatencyHistogram& time : times)
     {
-        time.min = ellapsedTime;
+        time.reset();
     }
-    else if (time.max < ellapsedTime)
+    // Keep the tree itself, unfinished pushes may refer to its nodes
+    for (int i = 0; i < callNodeCount; i++)
     {
-        time.max = ellapsedTime;
+        callNodes[i].count = 0;
+        callNodes[i].inclusiveTime = 0;
+        callNodes[i].exclusiveTime = 0;
     }
+    droppedCount = 0;
+}
 
-    time.avg = algorithms::lowPassFilter(time.avg, ellapsedTime, 0.01f);
-    time.totalValues += 1;
-
-    times[findIndex(times, profile, false)].second = time;
+#ifdef PLATFORM_HOSTED
+void Profiler::startChromeTrace(size_t capacity)
+{
+    chromeTracing = false;
+    chromeTraceEvents.clear();
+    // Reserve up front so recording never allocates
+    chromeTraceEvents.reserve(capacity);
+    chromeTraceCapacity = capacity;
+    chromeTracing = true;
 }
 
-uint64_t Profiler::getAvgTime(const char* profile) { return find(times, profile, false).avg; }
-uint64_t Profiler::getMinTime(const char* profile) { return find(times, profile, false).min; }
-uint64_t Profiler::getMaxTime(const char* profile) { return find(times, profile, false).max; }
-void Profiler::reset(const char* profile) { times[findIndex(times, profile, false)].second = {}; }
+bool Profiler::writeChromeTrace(const char* path) const
+{
+    FILE* file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for (size_t i = 0; i < chromeTraceEvents.size(); i++)
+    {
+        const ChromeTraceEvent& event = chromeTraceEvents[i];
+        fprintf(file, i == 0 ? "\n" : ",\n");
+        fprintf(file, "{\"name\": \"");
+        for (const char* c = probeNames[event.probe]; *c != '\0'; c++)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                fputc('\\', file);
+            }
+            fputc(*c, file);
+        }
+        fprintf(
+            file,
+            "\", \"ph\": \"X\", \"ts\": %u, \"dur\": %u, \"pid\": 0, \"tid\": 0}",
+            static_cast<unsigned>(event.start),
+            static_cast<unsigned>(event.duration));
+    }
+    fprintf(file, "\n]}\n");
+
+    return fclose(file) == 0;
+}
+#endif
 
 }  // namespace arch
 
 }  // namespace tap
-#endif
\ No newline at end of file
+#endif
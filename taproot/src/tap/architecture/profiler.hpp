@@ -20,54 +20,229 @@
 #ifndef PROFILER_HPP__
 #define PROFILER_HPP__
 
-#include "modm/container.hpp"
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/algorithms/log_histogram.hpp"
+
+#if defined(RUN_WITH_PROFILING) && defined(PLATFORM_HOSTED)
+#include <vector>
+#endif
 
 #define PROFILE(profiler, func, params) func params
 
 #ifdef RUN_WITH_PROFILING
 #undef PROFILE
-#define PROFILE(profiler, func, params) \
-    profiler.push(#func);               \
-    func params;                        \
-    profiler.pop()
+/**
+ * Each `PROFILE` site looks up its probe ID once, the first time it runs, and pushes and pops
+ * that ID afterwards.
+ */
+#define PROFILE(profiler, func, params)                                                 \
+    do                                                                                  \
+    {                                                                                   \
+        static const int profileProbeId = ::tap::arch::Profiler::registerProbe(#func); \
+        (profiler).push(profileProbeId);                                                \
+        func params;                                                                    \
+        (profiler).pop();                                                               \
+    } while (0)
+
+#endif
 
+#ifndef PROFILER_MAX_PROBES
+/// The maximum number of distinct `PROFILE` sites (by name).
+#define PROFILER_MAX_PROBES 32
+#endif
+
+#ifndef PROFILER_MAX_DEPTH
+/// The maximum nesting depth of `PROFILE` sites.
+#define PROFILER_MAX_DEPTH 16
+#endif
+
+#ifndef PROFILER_MAX_CALL_NODES
+/// The maximum number of distinct call paths (chains of nested probes) tracked.
+#define PROFILER_MAX_CALL_NODES 64
 #endif
 
 namespace tap
 {
 namespace arch
 {
+/**
+ * Measures the execution time of code wrapped in `PROFILE` when built with `profiling=true`.
+ *
+ * Probes are identified by an index into fixed size storage. The name to index mapping is shared
+ * by all profilers and is built the first time each `PROFILE` site runs, so no allocation or
+ * string comparison happens on the measured path. Probes that do not fit in
+ * `PROFILER_MAX_PROBES`, or that are nested deeper than `PROFILER_MAX_DEPTH`, are not
+ * measured and are counted by `getDroppedCount()`.
+ *
+ * Besides per probe times, the profiler builds a call tree from the nesting of probes: one
+ * `CallNode` per distinct path from the outermost probe, holding inclusive time (the whole
+ * probe) and exclusive time (the probe minus its nested probes). A probe reached through two
+ * different parents therefore has two nodes.
+ *
+ * In hosted builds, the profiler can additionally record every probe as a Chrome trace event
+ * (see `startChromeTrace`), viewable as a flame chart in `chrome://tracing` or Perfetto.
+ */
 class Profiler
 {
 #ifdef RUN_WITH_PROFILING
 
 public:
-    void push(const char* profile);
-    void pop();
+    static constexpr int MAX_PROBES = PROFILER_MAX_PROBES;
+    static constexpr int MAX_DEPTH = PROFILER_MAX_DEPTH;
 
-    const modm::DynamicArray<const char*>& getAllProfiles() const { return profiles; }
+    /// Returned by `registerProbe` and `findProbe` if there is no such probe.
+    static constexpr int INVALID_PROBE = -1;
 
-    uint64_t getAvgTime(const char* profile);
-    uint64_t getMinTime(const char* profile);
-    uint64_t getMaxTime(const char* profile);
-    void reset(const char* profile);
+    /**
+     * Execution times of a probe, in microseconds. Resolves times to within 12.5% up to ~1 s.
+     */
+    using LatencyHistogram = algorithms::LogHistogram<3, 20>;
 
-    struct MinMaxAvgStruct
+    static constexpr int MAX_CALL_NODES = PROFILER_MAX_CALL_NODES;
+
+    /// Parent of the outermost call nodes, and the end of a sibling list.
+    static constexpr int NO_CALL_NODE = -1;
+
+    /**
+     * A probe reached through a particular chain of enclosing probes. Times are in microseconds.
+     */
+    struct CallNode
     {
-        uint64_t min = UINT32_MAX, max = 0, avg = 0;
-        int totalValues = 0;
+        int probe = INVALID_PROBE;
+        int parent = NO_CALL_NODE;
+        int firstChild = NO_CALL_NODE;
+        int nextSibling = NO_CALL_NODE;
+        uint32_t count = 0;
+        uint64_t inclusiveTime = 0;
+        uint64_t exclusiveTime = 0;
     };
 
+    /**
+     * @return The ID of the probe called `name`, registering it if it does not exist yet, or
+     *      `INVALID_PROBE` if `name` is `nullptr` or all `MAX_PROBES` probes are in use.
+     * @note Probes are looked up by name, so `name` must point to storage that outlives the
+     *      profiler (in `PROFILE`, a string literal).
+     */
+    static int registerProbe(const char* name);
+
+    /**
+     * @return The ID of the probe called `name`, or `INVALID_PROBE` if it was never registered
+     *      or `name` is `nullptr`.
+     */
+    static int findProbe(const char* name);
+
+    static int getProbeCount() { return probeCount; }
+
+    /**
+     * @return The name of probe `probe`, or `nullptr` if it does not exist.
+     */
+    static const char* getProbeName(int probe);
+
+    void push(int probe);
+    void pop();
+
+    /**
+     * @return Execution times of probe `probe`. Empty if it does not exist.
+     */
+    const LatencyHistogram& getHistogram(int probe) const;
+
+    uint32_t getAvgTime(int probe) const { return getHistogram(probe).getMean(); }
+    uint32_t getMinTime(int probe) const { return getHistogram(probe).getMin(); }
+    uint32_t getMaxTime(int probe) const { return getHistogram(probe).getMax(); }
+    void reset(int probe);
+
+    /**
+     * Clears the execution times of all probes and call nodes and the dropped count.
+     */
+    void resetAll();
+
+    /**
+     * @return The first outermost call node, or `NO_CALL_NODE` if nothing was measured yet.
+     *      Iterate the tree with `CallNode::firstChild` and `CallNode::nextSibling`.
+     */
+    int getFirstRootCallNode() const { return firstRootCallNode; }
+
+    const CallNode& getCallNode(int node) const { return callNodes[node]; }
+
+    int getCallNodeCount() const { return callNodeCount; }
+
+#ifdef PLATFORM_HOSTED
+    static constexpr size_t DEFAULT_CHROME_TRACE_CAPACITY = 1 << 18;
+
+    /**
+     * Starts recording every probe, in addition to the regular statistics. Discards any events
+     * previously recorded. Recording stops once `capacity` events were recorded.
+     */
+    void startChromeTrace(size_t capacity = DEFAULT_CHROME_TRACE_CAPACITY);
+
+    void stopChromeTrace() { chromeTracing = false; }
+
+    bool isChromeTracing() const { return chromeTracing; }
+
+    size_t getChromeTraceEventCount() const { return chromeTraceEvents.size(); }
+
+    /**
+     * Writes all recorded events to `path` in the Chrome trace event JSON format.
+     *
+     * @return `false` if the file could not be written.
+     */
+    bool writeChromeTrace(const char* path) const;
+#endif
+
+    /**
+     * @return The number of `push` calls not measured since their probe was invalid or the
+     *      stack was full.
+     */
+    uint32_t getDroppedCount() const { return droppedCount; }
+
 private:
-    modm::DynamicArray<modm::Pair<const char*, MinMaxAvgStruct>> times;
-    modm::DynamicArray<const char*> profiles;
-    modm::LinkedList<const char*> profileStack;
-    modm::LinkedList<uint32_t> timeStack;
+    static const char* probeNames[MAX_PROBES];
+    static int probeCount;
+
+    LatencyHistogram times[MAX_PROBES];
+
+    CallNode callNodes[MAX_CALL_NODES];
+    int callNodeCount = 0;
+    int firstRootCallNode = NO_CALL_NODE;
+
+    /**
+     * Probe, call node, start time and time spent in nested probes (in microseconds) of each
+     * unfinished `push`.
+     */
+    int probeStack[MAX_DEPTH] = {};
+    int nodeStack[MAX_DEPTH] = {};
+    uint32_t timeStack[MAX_DEPTH] = {};
+    uint32_t childTimeStack[MAX_DEPTH] = {};
+    /// Number of unfinished `push` calls, including those that were dropped.
+    int depth = 0;
+
+    uint32_t droppedCount = 0;
+
+#ifdef PLATFORM_HOSTED
+    struct ChromeTraceEvent
+    {
+        uint32_t start;
+        uint32_t duration;
+        int probe;
+    };
+
+    bool chromeTracing = false;
+    size_t chromeTraceCapacity = 0;
+    std::vector<ChromeTraceEvent> chromeTraceEvents;
+#endif
+
+    /**
+     * @return The call node of `probe` under `parent` (`NO_CALL_NODE` for an outermost probe),
+     *      creating it if needed, or `NO_CALL_NODE` if there is no room for it.
+     */
+    int findOrAddCallNode(int parent, int probe);
 
 #else
 
 public:
-    void push(const char*){};
+    void push(int){};
     void pop(){};
 
 #endif
@@ -78,4 +253,4 @@ public:
 
 }  // namespace tap
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "profiler_terminal_handler.hpp"
+
+#include "tap/algorithms/strtok.hpp"
+#include "tap/drivers.hpp"
+
+namespace tap
+{
+namespace arch
+{
+constexpr char ProfilerTerminalHandler::HEADER[];
+constexpr char ProfilerTerminalHandler::USAGE[];
+
+void ProfilerTerminalHandler::init() { drivers->terminalSerial.addHeader(HEADER, this); }
+
+bool ProfilerTerminalHandler::terminalSerialCallback(
+    char* inputLine,
+    modm::IOStream& outputStream,
+    bool streamingEnabled)
+{
+    char* arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine);
+
+    if (arg != nullptr && strcmp(arg, "times") == 0)
+    {
+        printTree = false;
+        printTimes(outputStream);
+        return true;
+    }
+    else if (arg != nullptr && strcmp(arg, "tree") == 0)
+    {
+        printTree = true;
+        printCallTree(outputStream);
+        return true;
+    }
+    else if (arg != nullptr && strcmp(arg, "chrometrace") == 0)
+    {
+        return handleChromeTrace(inputLine, outputStream) && !streamingEnabled;
+    }
+    else if (arg != nullptr && strcmp(arg, "reset") == 0)
+    {
+#ifdef RUN_WITH_PROFILING
+        drivers->profiler.resetAll();
+#endif
+        outputStream << "execution times cleared" << modm::endl;
+        return !streamingEnabled;
+    }
+    else
+    {
+        outputStream << USAGE;
+        return (arg != nullptr) && !streamingEnabled && (strcmp(arg, "-H") == 0);
+    }
+}
+
+void ProfilerTerminalHandler::terminalSerialStreamCallback(modm::IOStream& outputStream)
+{
+    if (printTree)
+    {
+        printCallTree(outputStream);
+    }
+    else
+    {
+        printTimes(outputStream);
+    }
+}
+
+void ProfilerTerminalHandler::printTimes(modm::IOStream& outputStream)
+{
+#ifdef RUN_WITH_PROFILING
+    const Profiler& profiler = drivers->profiler;
+
+    outputStream << "Probe execution (count, p50/p90/p99/p99.9/max us), dropped "
+                 << profiler.getDroppedCount() << ":" << modm::endl;
+    for (int i = 0; i < Profiler::getProbeCount(); i++)
+    {
+        const Profiler::LatencyHistogram& times = profiler.getHistogram(i);
+        outputStream << " " << Profiler::getProbeName(i) << ": " << times.getCount() << ", "
+                     << times.percentile(0.5f) << "/" << times.percentile(0.9f) << "/"
+                     << times.percentile(0.99f) << "/" << times.percentile(0.999f) << "/"
+                     << times.getMax() << modm::endl;
+    }
+#else
+    outputStream << "profiling disabled, build with profiling=true" << modm::endl;
+#endif
+}
+
+void ProfilerTerminalHandler::printCallTree(modm::IOStream& outputStream)
+{
+#ifdef RUN_WITH_PROFILING
+    const Profiler& profiler = drivers->profiler;
+
+    outputStream << "Call tree (count, mean inclusive/exclusive us):" << modm::endl;
+
+    // Depth first walk, going back up through the parents once a subtree is done
+    int depth = 0;
+    int node = profiler.getFirstRootCallNode();
+    while (node != Profiler::NO_CALL_NODE)
+    {
+        const Profiler::CallNode& callNode = profiler.getCallNode(node);
+        uint32_t count = callNode.count == 0 ? 1 : callNode.count;
+        for (int i = 0; i <= depth; i++)
+        {
+            outputStream << "  ";
+        }
+        outputStream << Profiler::getProbeName(callNode.probe) << ": " << callNode.count << ", "
+                     << static_cast<uint32_t>(callNode.inclusiveTime / count) << "/"
+                     << static_cast<uint32_t>(callNode.exclusiveTime / count) << modm::endl;
+
+        if (callNode.firstChild != Profiler::NO_CALL_NODE)
+        {
+            node = callNode.firstChild;
+            depth++;
+            continue;
+        }
+        while (node != Profiler::NO_CALL_NODE &&
+               profiler.getCallNode(node).nextSibling == Profiler::NO_CALL_NODE)
+        {
+            node = profiler.getCallNode(node).parent;
+            depth--;
+        }
+        if (node != Profiler::NO_CALL_NODE)
+        {
+            node = profiler.getCallNode(node).nextSibling;
+        }
+    }
+#else
+    outputStream << "profiling disabled, build with profiling=true" << modm::endl;
+#endif
+}
+
+bool ProfilerTerminalHandler::handleChromeTrace(char* inputLine, modm::IOStream& outputStream)
+{
+#if defined(RUN_WITH_PROFILING) && defined(PLATFORM_HOSTED)
+    char* arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine);
+
+    if (arg != nullptr && strcmp(arg, "start") == 0)
+    {
+        drivers->profiler.startChromeTrace();
+        outputStream << "chrome trace started" << modm::endl;
+        return true;
+    }
+    else if (arg != nullptr && strcmp(arg, "stop") == 0)
+    {
+        drivers->profiler.stopChromeTrace();
+        outputStream << "chrome trace stopped, " << drivers->profiler.getChromeTraceEventCount()
+                     << " events" << modm::endl;
+        return true;
+    }
+    else if (arg != nullptr && strcmp(arg, "write") == 0)
+    {
+        char* path =
+            strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine);
+        if (path != nullptr && drivers->profiler.writeChromeTrace(path))
+        {
+            outputStream << "wrote " << drivers->profiler.getChromeTraceEventCount()
+                         << " events to " << path << modm::endl;
+            return true;
+        }
+        outputStream << "failed to write chrome trace" << modm::endl;
+        return false;
+    }
+
+    outputStream << USAGE;
+    return false;
+#else
+    UNUSED(inputLine);
+    outputStream << "chrome traces require a hosted build with profiling=true" << modm::endl;
+    return false;
+#endif
+}
+
+}  // namespace arch
+
+}  // namespace tap
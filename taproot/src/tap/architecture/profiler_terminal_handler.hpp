@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_TERMINAL_HANDLER_HPP_
+#define PROFILER_TERMINAL_HANDLER_HPP_
+
+#include "tap/communication/serial/terminal_serial.hpp"
+#include "tap/util_macros.hpp"
+
+namespace tap
+{
+class Drivers;
+namespace arch
+{
+/**
+ * Prints the execution time percentiles of every `PROFILE` probe of `drivers->profiler`.
+ */
+class ProfilerTerminalHandler : public communication::serial::TerminalSerialCallbackInterface
+{
+public:
+    static constexpr char HEADER[] = "profiler";
+
+    ProfilerTerminalHandler(Drivers* drivers) : drivers(drivers) {}
+    DISALLOW_COPY_AND_ASSIGN(ProfilerTerminalHandler);
+
+    void init();
+
+    bool terminalSerialCallback(
+        char* inputLine,
+        modm::IOStream& outputStream,
+        bool streamingEnabled) override;
+
+    void terminalSerialStreamCallback(modm::IOStream& outputStream) override;
+
+private:
+    static constexpr char USAGE[] =
+        "Usage: profiler [-S] <target>\n"
+        "  Where \"<target>\" is one of:\n"
+        "    - \"-H\": displays possible commands.\n"
+        "    - \"times\" prints the sample count and p50/p90/p99/p99.9/max execution times\n"
+        "      (in us) of every probe, use -S to stream them.\n"
+        "    - \"tree\" prints the call tree of nested probes with the count and mean\n"
+        "      inclusive/exclusive time (in us) of every node, use -S to stream it.\n"
+        "    - \"reset\" clears all execution times.\n"
+#ifdef PLATFORM_HOSTED
+        "    - \"chrometrace start\" starts recording every probe.\n"
+        "    - \"chrometrace stop\" stops recording.\n"
+        "    - \"chrometrace write <path>\" writes the recorded probes to <path> as Chrome trace\n"
+        "      event JSON, open it in chrome://tracing or ui.perfetto.dev.\n"
+#endif
+        ;
+
+    Drivers* drivers;
+
+    /// `true` if `tree` was the last target requested, in which case the tree is streamed.
+    bool printTree = false;
+
+    void printTimes(modm::IOStream& outputStream);
+
+    void printCallTree(modm::IOStream& outputStream);
+
+    bool handleChromeTrace(char* inputLine, modm::IOStream& outputStream);
+};  // class ProfilerTerminalHandler
+
+}  // namespace arch
+
+}  // namespace tap
+
+#endif  // PROFILER_TERMINAL_HANDLER_HPP_
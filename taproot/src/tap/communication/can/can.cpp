@@ -19,110 +19,372 @@
 
 #include "can.hpp"
 
+#include "modm/architecture/interface/assert.hpp"
 #include "modm/architecture/interface/can_message.hpp"
 #include "modm/platform.hpp"
 
 #ifdef PLATFORM_HOSTED
 #include "tap/motor/motorsim/sim_handler.hpp"
+#else
+#include "modm/architecture/interface/atomic_lock.hpp"
 #endif
 
+#include "tap/architecture/clock.hpp"
 #include "tap/board/board.hpp"
 #include "tap/util_macros.hpp"
 
+#include "can_rx_ring.hpp"
+#include "can_stats.hpp"
+#include "can_tx_queue.hpp"
+
 #ifndef PLATFORM_HOSTED
 using namespace modm::platform;
 #endif
 using namespace modm::literals;
 
+static constexpr uint32_t CAN1_INTERRUPT_PRIORITY = 9;
+static constexpr uint32_t CAN2_INTERRUPT_PRIORITY = 12;
+
+static tap::can::CanRxRing<tap::can::Can::RX_RING_SIZE> rxRings[2];
+
+static tap::can::CanTxQueue txQueues[2];
+
+static inline int busIndex(tap::can::CanBus bus)
+{
+    return bus == tap::can::CanBus::CAN_BUS1 ? 0 : 1;
+}
+
+/// Acceptance filters of each bus. Until `setRxFilters` is called, `numRxFilters` is -1 and
+/// every identifier is accepted.
+static tap::can::CanIdFilter rxFilters[2][tap::can::Can::MAX_RX_FILTERS];
+static int numRxFilters[2] = {-1, -1};
+
+#ifndef PLATFORM_HOSTED
+static constexpr uint8_t FILTER_BANKS_PER_BUS = 14;
+
+static bool filterBanksReady = false;
+
+/**
+ * Programs the filter banks of a bus with its acceptance filters, two 16-bit mask filters per
+ * bank. Unused banks are disabled.
+ */
+static void applyRxFilters(int index)
+{
+    const uint8_t firstBank = index * FILTER_BANKS_PER_BUS;
+    if (numRxFilters[index] < 0)
+    {
+        // receive every message
+        CanFilter::setFilter(
+            firstBank,
+            CanFilter::FIFO0,
+            CanFilter::StandardIdentifier(0),
+            CanFilter::StandardFilterMask(0));
+        return;
+    }
+
+    for (int bank = 0; bank < FILTER_BANKS_PER_BUS; bank++)
+    {
+        int filter = 2 * bank;
+        if (filter >= numRxFilters[index])
+        {
+            CanFilter::disableFilter(firstBank + bank);
+            continue;
+        }
+        const tap::can::CanIdFilter &first = rxFilters[index][filter];
+        const tap::can::CanIdFilter &second =
+            filter + 1 < numRxFilters[index] ? rxFilters[index][filter + 1] : first;
+        CanFilter::setFilterShort(
+            firstBank + bank,
+            CanFilter::FIFO0,
+            CanFilter::StandardIdentifierShort(first.id),
+            CanFilter::StandardFilterMaskShort(first.mask),
+            CanFilter::StandardIdentifierShort(second.id),
+            CanFilter::StandardFilterMaskShort(second.mask));
+    }
+}
+#else
+/**
+ * The simulator's stand-in for the hardware acceptance filters.
+ */
+static bool isAccepted(int index, uint16_t identifier)
+{
+    if (numRxFilters[index] < 0)
+    {
+        return true;
+    }
+    for (int i = 0; i < numRxFilters[index]; i++)
+    {
+        if (rxFilters[index][i].accepts(identifier))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+#ifndef PLATFORM_HOSTED
+/// Hardware FIFO overruns per bus, counted by the receive interrupts.
+static volatile uint32_t rxOverrunCount[2] = {};
+
+/**
+ * Moves every frame waiting in the hardware FIFOs of a CAN peripheral into its receive ring,
+ * stamped with the time the interrupt was entered. modm is built without a receive queue
+ * (`buffer.rx` is 0 in project.xml) and so defines no receive interrupts of its own, and its
+ * `getMessage` reads straight from the hardware FIFOs.
+ */
+template <typename Peripheral>
+static void receiveFrames(CAN_TypeDef *can, int index)
+{
+    uint32_t timestamp = tap::arch::clock::getTimeMicroseconds();
+
+    if (can->RF0R & CAN_RF0R_FOVR0)
+    {
+        rxOverrunCount[index]++;
+        can->RF0R = CAN_RF0R_FOVR0;
+    }
+    if (can->RF1R & CAN_RF1R_FOVR1)
+    {
+        rxOverrunCount[index]++;
+        can->RF1R = CAN_RF1R_FOVR1;
+    }
+
+    modm::can::Message message;
+    while (Peripheral::getMessage(message))
+    {
+        rxRings[index].push(message, timestamp);
+    }
+}
+
+MODM_ISR(CAN1_RX0) { receiveFrames<Can1>(CAN1, 0); }
+MODM_ISR(CAN1_RX1) { receiveFrames<Can1>(CAN1, 0); }
+MODM_ISR(CAN2_RX0) { receiveFrames<Can2>(CAN2, 1); }
+MODM_ISR(CAN2_RX1) { receiveFrames<Can2>(CAN2, 1); }
+
+/// Where the transmit interrupts record sent and dropped frames, set by `Can::initialize`.
+static tap::can::CanStats *txStats = nullptr;
+
+/**
+ * Fills the free transmit mailboxes of a CAN peripheral from its transmit queue. Run when a
+ * mailbox empties and, through `NVIC_SetPendingIRQ`, whenever a frame is queued. modm is built
+ * without a transmit queue (`buffer.tx` is 0 in project.xml), so `isReadyToSend` tells whether
+ * a mailbox is free and `sendMessage` writes straight into it.
+ */
+template <typename Peripheral>
+static void transmitFrames(CAN_TypeDef *can, tap::can::CanBus bus)
+{
+    // Acknowledge the completed requests that raised the interrupt
+    can->TSR = CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2;
+
+    tap::can::CanTxQueue &queue = txQueues[busIndex(bus)];
+    uint32_t now = tap::arch::clock::getTimeMicroseconds();
+    uint32_t deadlineMisses = queue.getDeadlineMisses();
+    modm::can::Message message;
+    while (Peripheral::isReadyToSend() && queue.pop(now, &message))
+    {
+        Peripheral::sendMessage(message);
+        if (txStats != nullptr)
+        {
+            txStats->recordTx(bus, message);
+        }
+    }
+    if (txStats != nullptr && queue.getDeadlineMisses() != deadlineMisses)
+    {
+        txStats->recordTxFailures(bus, queue.getDeadlineMisses() - deadlineMisses);
+    }
+}
+
+MODM_ISR(CAN1_TX) { transmitFrames<Can1>(CAN1, tap::can::CanBus::CAN_BUS1); }
+MODM_ISR(CAN2_TX) { transmitFrames<Can2>(CAN2, tap::can::CanBus::CAN_BUS2); }
+
+static void enableTxInterrupt(CAN_TypeDef *can, IRQn_Type txIrq, uint32_t priority)
+{
+    NVIC_SetPriority(txIrq, priority);
+    NVIC_EnableIRQ(txIrq);
+    can->IER |= CAN_IER_TMEIE;
+}
+
+static void enableRxInterrupts(
+    CAN_TypeDef *can,
+    IRQn_Type fifo0Irq,
+    IRQn_Type fifo1Irq,
+    uint32_t priority)
+{
+    NVIC_SetPriority(fifo0Irq, priority);
+    NVIC_SetPriority(fifo1Irq, priority);
+    NVIC_EnableIRQ(fifo0Irq);
+    NVIC_EnableIRQ(fifo1Irq);
+    can->IER |= CAN_IER_FMPIE0 | CAN_IER_FMPIE1 | CAN_IER_FOVIE0 | CAN_IER_FOVIE1;
+}
+#else
+static uint32_t lastSimFeedback[2] = {};
+
+/**
+ * Stands in for the receive interrupt in the simulator: every `SIM_FEEDBACK_PERIOD`, pushes a
+ * feedback frame from each of the bus's motor sims into its receive ring.
+ */
+static void receiveSimFrames(tap::can::CanBus bus)
+{
+    int index = busIndex(bus);
+    uint32_t timestamp = tap::arch::clock::getTimeMicroseconds();
+    if (timestamp - lastSimFeedback[index] < tap::can::Can::SIM_FEEDBACK_PERIOD)
+    {
+        return;
+    }
+    lastSimFeedback[index] = timestamp;
+
+    for (int i = 0; i < tap::motor::DjiMotorTxHandler::DJI_MOTORS_PER_CAN; i++)
+    {
+        modm::can::Message message;
+        if (tap::motorsim::SimHandler::sendMessage(bus, &message) &&
+            isAccepted(index, message.getIdentifier()))
+        {
+            rxRings[index].push(message, timestamp);
+        }
+    }
+}
+#endif
+
 void tap::can::Can::initialize()
 {
 #ifndef PLATFORM_HOSTED
-    CanFilter::setStartFilterBankForCan2(14);
+    CanFilter::setStartFilterBankForCan2(FILTER_BANKS_PER_BUS);
     // initialize CAN 1
     Can1::connect<GpioD0::Rx, GpioD1::Tx>(Gpio::InputType::PullUp);
-    modm_assert((Can1::initialize<Board::SystemClock, 1000_kbps>(9)), "Can2", "initialize-failed");
-    // receive every message for CAN 1
-    CanFilter::setFilter(
-        0,
-        CanFilter::FIFO0,
-        CanFilter::StandardIdentifier(0),
-        CanFilter::StandardFilterMask(0));
+    modm_assert(
+        (Can1::initialize<Board::SystemClock, 1000_kbps>(CAN1_INTERRUPT_PRIORITY)),
+        "Can2",
+        "initialize-failed");
     Can2::connect<GpioB12::Rx, GpioB13::Tx>(Gpio::InputType::PullUp);
-    modm_assert((Can2::initialize<Board::SystemClock, 1000_kbps>(12)), "Can2", "initialize-failed");
-    // receive every message for CAN 2
-    CanFilter::setFilter(
-        14,
-        CanFilter::FIFO0,
-        CanFilter::StandardIdentifier(0),
-        CanFilter::StandardFilterMask(0));
+    modm_assert(
+        (Can2::initialize<Board::SystemClock, 1000_kbps>(CAN2_INTERRUPT_PRIORITY)),
+        "Can2",
+        "initialize-failed");
+    filterBanksReady = true;
+    txStats = stats;
+    applyRxFilters(0);
+    applyRxFilters(1);
+    enableRxInterrupts(CAN1, CAN1_RX0_IRQn, CAN1_RX1_IRQn, CAN1_INTERRUPT_PRIORITY);
+    enableRxInterrupts(CAN2, CAN2_RX0_IRQn, CAN2_RX1_IRQn, CAN2_INTERRUPT_PRIORITY);
+    enableTxInterrupt(CAN1, CAN1_TX_IRQn, CAN1_INTERRUPT_PRIORITY);
+    enableTxInterrupt(CAN2, CAN2_TX_IRQn, CAN2_INTERRUPT_PRIORITY);
 #endif
 }
 
-bool tap::can::Can::isMessageAvailable(tap::can::CanBus bus) const
+void tap::can::Can::setRxFilters(CanBus bus, const CanIdFilter* filters, int numFilters)
 {
-#ifdef PLATFORM_HOSTED
-    return tap::motorsim::SimHandler::readyToSend(bus);
-#else
-    switch (bus)
+    modm_assert(
+        numFilters >= 0 && numFilters <= MAX_RX_FILTERS,
+        "CAN",
+        "too many RX filters",
+        1);
+    int index = busIndex(bus);
+    for (int i = 0; i < numFilters; i++)
     {
-        case CanBus::CAN_BUS1:
-            return Can1::isMessageAvailable();
-        case CanBus::CAN_BUS2:
-            return Can2::isMessageAvailable();
-        default:
-            return false;
+        rxFilters[index][i] = filters[i];
+    }
+    numRxFilters[index] = numFilters;
+#ifndef PLATFORM_HOSTED
+    // The filter banks can only be written once the CAN peripherals are clocked
+    if (filterBanksReady)
+    {
+        applyRxFilters(index);
     }
 #endif
 }
 
-bool tap::can::Can::getMessage(tap::can::CanBus bus, modm::can::Message* message)
+bool tap::can::Can::isMessageAvailable(tap::can::CanBus bus) const
 {
 #ifdef PLATFORM_HOSTED
-    return tap::motorsim::SimHandler::sendMessage(bus, message);
-#else
-    switch (bus)
-    {
-        case CanBus::CAN_BUS1:
-            return Can1::getMessage(*message);
-        case CanBus::CAN_BUS2:
-            return Can2::getMessage(*message);
-        default:
-            return false;
-    }
+    receiveSimFrames(bus);
 #endif
+    return !rxRings[busIndex(bus)].isEmpty();
 }
 
-bool tap::can::Can::isReadyToSend(CanBus bus) const
+bool tap::can::Can::getMessage(
+    tap::can::CanBus bus,
+    modm::can::Message* message,
+    uint32_t* timestamp)
 {
 #ifdef PLATFORM_HOSTED
-    UNUSED(bus);
-    return true;
-#else
-    switch (bus)
+    receiveSimFrames(bus);
+#endif
+    TimestampedCanMessage frame;
+    if (!rxRings[busIndex(bus)].pop(&frame))
     {
-        case CanBus::CAN_BUS1:
-            return Can1::isReadyToSend();
-        case CanBus::CAN_BUS2:
-            return Can2::isReadyToSend();
-        default:
-            return false;
+        return false;
     }
-#endif
+    *message = frame.message;
+    *timestamp = frame.timestamp;
+    return true;
+}
+
+bool tap::can::Can::isReadyToSend(CanBus bus) const
+{
+    return !txQueues[busIndex(bus)].isFull(CanTxPriority::NORMAL);
 }
 
 bool tap::can::Can::sendMessage(CanBus bus, const modm::can::Message& message)
 {
+    return queueMessage(bus, message, CanTxPriority::NORMAL, 0);
+}
+
+bool tap::can::Can::queueMessage(
+    CanBus bus,
+    const modm::can::Message& message,
+    CanTxPriority priority,
+    uint32_t maxAge)
+{
+    int index = busIndex(bus);
+    uint32_t now = tap::arch::clock::getTimeMicroseconds();
 #ifdef PLATFORM_HOSTED
-    return tap::motorsim::SimHandler::getMessage(bus, message);
+    if (!txQueues[index].push(message, priority, now, maxAge))
+    {
+        if (stats != nullptr)
+        {
+            stats->recordTxFailures(bus);
+        }
+        return false;
+    }
+    // Stands in for the transmit interrupt, the simulated bus is never busy
+    modm::can::Message next;
+    while (txQueues[index].pop(now, &next))
+    {
+        tap::motorsim::SimHandler::getMessage(bus, next);
+        if (stats != nullptr)
+        {
+            stats->recordTx(bus, next);
+        }
+    }
+    return true;
 #else
-    switch (bus)
+    bool queued;
     {
-        case CanBus::CAN_BUS1:
-            return Can1::sendMessage(message);
-        case CanBus::CAN_BUS2:
-            return Can2::sendMessage(message);
-        default:
-            return false;
+        // Keep the transmit interrupt from taking a frame, or recording one, while the queue
+        // is being changed
+        modm::atomic::Lock lock;
+        queued = txQueues[index].push(message, priority, now, maxAge);
+        if (!queued && stats != nullptr)
+        {
+            stats->recordTxFailures(bus);
+        }
     }
+    NVIC_SetPendingIRQ(index == 0 ? CAN1_TX_IRQn : CAN2_TX_IRQn);
+    return queued;
+#endif
+}
+
+tap::can::CanTxQueue::Stats tap::can::Can::getTxQueueStats(CanBus bus, CanTxPriority priority)
+    const
+{
+    return txQueues[busIndex(bus)].getStats(priority);
+}
+
+uint32_t tap::can::Can::getRxOverflowCount(CanBus bus) const
+{
+    uint32_t dropped = rxRings[busIndex(bus)].getDroppedCount();
+#ifndef PLATFORM_HOSTED
+    dropped += rxOverrunCount[busIndex(bus)];
 #endif
+    return dropped;
 }
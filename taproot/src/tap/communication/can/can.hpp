@@ -20,9 +20,13 @@
 #ifndef CAN_HPP_
 #define CAN_HPP_
 
+#include <cstdint>
+
 #include "tap/util_macros.hpp"
 
 #include "can_bus.hpp"
+#include "can_id_filter.hpp"
+#include "can_tx_queue.hpp"
 
 namespace modm::can
 {
@@ -33,13 +37,49 @@ namespace tap
 {
 namespace can
 {
+class CanStats;
+
 /**
  * A simple CAN wrapper class that handles I/O from both CAN bus 1 and 2.
+ *
+ * Received frames are pushed, together with their arrival time, into a lock-free ring per bus
+ * by the CAN receive interrupts and stay there until `getMessage` is called. In the simulator
+ * the rings are fed with feedback from the `SimHandler` motor sims instead, once per
+ * `SIM_FEEDBACK_PERIOD`.
+ *
+ * Frames to send are queued in a `CanTxQueue` per bus, from which the CAN transmit interrupts
+ * fill the hardware mailboxes as they free up, highest priority class first. Frames that are
+ * still queued at their deadline are dropped instead of being sent late. In the simulator the
+ * queue is drained into the `SimHandler` as soon as a frame is queued.
+ *
+ * Sent frames are recorded in the `CanStats` given to the constructor as they are loaded into
+ * a mailbox (handed to the `SimHandler` in the simulator), and frames dropped because their
+ * priority class was full or their deadline passed are recorded as failures.
+ *
+ * @note Up to three frames already in the hardware mailboxes are sent before a newly queued
+ *      frame, whatever their priority.
  */
 class Can
 {
 public:
-    Can() = default;
+    /// Size of the receive ring of each bus, one slot of which is kept free.
+    static constexpr uint16_t RX_RING_SIZE = 64;
+
+    /**
+     * The number of acceptance filters available per bus: each bus has 14 filter banks, used
+     * as two 16-bit mask filters each.
+     */
+    static constexpr int MAX_RX_FILTERS = 28;
+
+#ifdef PLATFORM_HOSTED
+    /// Period at which each simulated motor sends feedback, in microseconds.
+    static constexpr uint32_t SIM_FEEDBACK_PERIOD = 1'000;
+#endif
+
+    /**
+     * @param[in] stats where sent frames and send failures are recorded, may be `nullptr`.
+     */
+    explicit Can(CanStats *stats = nullptr) : stats(stats) {}
     DISALLOW_COPY_AND_ASSIGN(Can)
     mockable ~Can() = default;
 
@@ -51,9 +91,24 @@ public:
      * @note CAN 1 is connected to pins D0 (RX) and D1 (TX) and
      *      CAN 2 is connected to pins B12 (RX) and B12 (TX).
      * @note The CAN filters are set up to receive NOT extended identifier IDs.
+     *      Until `setRxFilters` is called for a bus, every identifier is accepted,
+     *      `CanRxHandler::initialize` sets them from the attached listeners.
      */
     mockable void initialize();
 
+    /**
+     * Programs the acceptance filters of a bus, so that only frames matching one of `filters`
+     * are received. Frames that do not match are dropped by the hardware (by `Can` in the
+     * simulator) before they take up space in the receive ring. May be called before or
+     * after `initialize`.
+     *
+     * @param[in] bus the CanBus to set the filters of.
+     * @param[in] filters the filters, may be `nullptr` if `numFilters` is 0.
+     * @param[in] numFilters the number of filters, at most `MAX_RX_FILTERS`. 0 to receive
+     *      nothing.
+     */
+    mockable void setRxFilters(CanBus bus, const CanIdFilter *filters, int numFilters);
+
     /**
      * Checks the passed in CanBus to see if there is a message waiting
      * and available.
@@ -71,22 +126,25 @@ public:
      * @param[in] bus the CanBus to acquire a message from.
      * @param[out] message a return parameter which the message is
      *      placed in.
+     * @param[out] timestamp a return parameter which the time the message
+     *      arrived, in microseconds, is placed in.
      * @return true if a valid message was placed in the parameter
      *      message. False otherwise.
      */
-    mockable bool getMessage(CanBus bus, modm::can::Message *message);
+    mockable bool getMessage(CanBus bus, modm::can::Message *message, uint32_t *timestamp);
 
     /**
      * Checks the given CanBus to see if the CanBus is idle.
      *
      * @param[in] bus the CanBus to check.
-     * @return true if the bus is not busy, false otherwise.
+     * @return true if `sendMessage` can queue a message, false otherwise.
      */
     mockable bool isReadyToSend(CanBus bus) const;
 
     /**
-     * Sends the passed in message over the CanBus. Returns whether or
-     * not the message succeeded.
+     * Queues the passed in message to be sent over the CanBus, in the
+     * `CanTxPriority::NORMAL` class without a deadline. Returns whether or
+     * not the message could be queued.
      *
      * @attention `modm::can::Message` defaults to an extended
      * message identifier. For all RoboMaster products we have, we do not
@@ -96,9 +154,41 @@ public:
      *
      * @param[in] bus the `CanBus` for which the message should be sent across.
      * @param[in] message the message to send
-     * @return true if the message was successfully sent, false otherwise.
+     * @return true if the message was successfully queued, false otherwise.
      */
     mockable bool sendMessage(CanBus bus, const modm::can::Message &message);
+
+    /**
+     * Queues a message to be sent over the CanBus once no message of a higher priority class
+     * is waiting.
+     *
+     * @param[in] bus the `CanBus` for which the message should be sent across.
+     * @param[in] message the message to send, see the note on `sendMessage`.
+     * @param[in] priority the priority class to queue the message in.
+     * @param[in] maxAge the time after which the message is dropped if it is still queued, in
+     *      microseconds. 0 to never drop it.
+     * @return true if the message was queued, false if its priority class is full.
+     */
+    mockable bool queueMessage(
+        CanBus bus,
+        const modm::can::Message &message,
+        CanTxPriority priority,
+        uint32_t maxAge);
+
+    /**
+     * @return The transmit queue statistics of a priority class of the given CanBus, including
+     *      the number of messages dropped because they missed their deadline.
+     */
+    mockable CanTxQueue::Stats getTxQueueStats(CanBus bus, CanTxPriority priority) const;
+
+    /**
+     * @return The number of frames the given CanBus dropped on reception since boot, either
+     *      because the hardware FIFO overran or because the receive ring was full.
+     */
+    mockable uint32_t getRxOverflowCount(CanBus bus) const;
+
+private:
+    CanStats *stats;
 };  // class Can
 
 }  // namespace can
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "can_id_filter.hpp"
+
+#include "modm/architecture/interface/assert.hpp"
+
+namespace tap::can
+{
+/// The maximum number of identifiers `buildCanIdFilters` accepts.
+static constexpr int MAX_IDS = 64;
+
+/**
+ * A block of identifiers [`start`, `start + size`), where `size` is a power of two and `start`
+ * is a multiple of `size`, so that it can be matched by a single mask filter.
+ */
+struct IdBlock
+{
+    uint16_t start;
+    uint16_t size;
+
+    uint16_t end() const { return start + size; }
+};
+
+/**
+ * @return The smallest block that contains both `a` and `b`, where `a` is below `b`.
+ */
+static IdBlock coveringBlock(const IdBlock& a, const IdBlock& b)
+{
+    uint16_t size = a.size;
+    while ((a.start & ~(size - 1)) + size < b.end())
+    {
+        size <<= 1;
+    }
+    return IdBlock{static_cast<uint16_t>(a.start & ~(size - 1)), size};
+}
+
+int buildCanIdFilters(const uint16_t* ids, int numIds, CanIdFilter* filters, int maxFilters)
+{
+    modm_assert(numIds <= MAX_IDS && maxFilters > 0, "CAN", "invalid filter arguments", 1);
+
+    IdBlock blocks[MAX_IDS];
+    int numBlocks = 0;
+
+    for (int i = 0; i < numIds;)
+    {
+        // Find the range of consecutive identifiers starting at ids[i]
+        int runEnd = i + 1;
+        while (runEnd < numIds && ids[runEnd] == ids[runEnd - 1] + 1)
+        {
+            runEnd++;
+        }
+
+        // Split it into the largest aligned blocks that fit
+        uint16_t start = ids[i];
+        uint16_t end = ids[runEnd - 1] + 1;
+        while (start < end)
+        {
+            uint16_t size = 1;
+            while ((start & ((size << 1) - 1)) == 0 && start + (size << 1) <= end)
+            {
+                size <<= 1;
+            }
+            blocks[numBlocks++] = IdBlock{start, size};
+            start += size;
+        }
+        i = runEnd;
+    }
+
+    while (numBlocks > maxFilters)
+    {
+        // Merge the neighbouring blocks whose covering block is smallest
+        int best = 0;
+        IdBlock bestBlock = coveringBlock(blocks[0], blocks[1]);
+        for (int i = 1; i < numBlocks - 1; i++)
+        {
+            IdBlock merged = coveringBlock(blocks[i], blocks[i + 1]);
+            if (merged.size < bestBlock.size)
+            {
+                best = i;
+                bestBlock = merged;
+            }
+        }
+
+        // The covering block may also contain blocks on either side of the pair
+        int first = best;
+        while (first > 0 && blocks[first - 1].start >= bestBlock.start)
+        {
+            first--;
+        }
+        int last = best + 1;
+        while (last < numBlocks - 1 && blocks[last + 1].end() <= bestBlock.end())
+        {
+            last++;
+        }
+
+        blocks[first] = bestBlock;
+        int removed = last - first;
+        for (int i = first + 1; i + removed < numBlocks; i++)
+        {
+            blocks[i] = blocks[i + removed];
+        }
+        numBlocks -= removed;
+    }
+
+    for (int i = 0; i < numBlocks; i++)
+    {
+        filters[i].id = blocks[i].start;
+        filters[i].mask = CanIdFilter::STANDARD_ID_MASK & ~(blocks[i].size - 1);
+    }
+    return numBlocks;
+}
+
+}  // namespace tap::can
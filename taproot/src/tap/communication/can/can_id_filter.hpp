@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAN_ID_FILTER_HPP_
+#define CAN_ID_FILTER_HPP_
+
+#include <cstdint>
+
+namespace tap::can
+{
+/**
+ * An acceptance filter for standard (11-bit) CAN identifiers: a frame is accepted if its
+ * identifier matches `id` in every bit set in `mask`.
+ */
+struct CanIdFilter
+{
+    static constexpr uint16_t STANDARD_ID_MASK = 0x7FF;
+
+    uint16_t id;
+    uint16_t mask;
+
+    inline bool accepts(uint16_t identifier) const { return ((identifier ^ id) & mask) == 0; }
+
+    inline bool operator==(const CanIdFilter& other) const
+    {
+        return id == other.id && mask == other.mask;
+    }
+};
+
+/**
+ * Covers a set of standard identifiers with at most `maxFilters` mask filters. Ranges of
+ * consecutive identifiers are split into aligned power of two sized blocks, each needing one
+ * filter. If that takes more than `maxFilters` filters, the neighbouring blocks that are
+ * cheapest to merge are merged, so the filters accept some identifiers outside the set.
+ *
+ * @param[in] ids The identifiers to accept, in increasing order without duplicates.
+ * @param[in] numIds The number of identifiers in `ids`, at most 64.
+ * @param[out] filters Array of at least `maxFilters` filters that the filters are written to,
+ *      in increasing order of identifier.
+ * @param[in] maxFilters The maximum number of filters to use. Must be positive.
+ * @return The number of filters written to `filters`.
+ */
+int buildCanIdFilters(const uint16_t* ids, int numIds, CanIdFilter* filters, int maxFilters);
+
+}  // namespace tap::can
+
+#endif  // CAN_ID_FILTER_HPP_
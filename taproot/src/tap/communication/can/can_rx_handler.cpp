@@ -19,12 +19,16 @@
 
 #include "can_rx_handler.hpp"
 
+#include <algorithm>
+
+#include "tap/architecture/clock.hpp"
 #include "tap/drivers.hpp"
 #include "tap/errors/create_errors.hpp"
 
 #include "modm/architecture/interface/assert.h"
 #include "modm/architecture/interface/can.hpp"
 
+#include "can_id_filter.hpp"
 #include "can_rx_listener.hpp"
 
 namespace tap::can
@@ -36,6 +40,12 @@ CanRxHandler::CanRxHandler(Drivers* drivers)
 {
 }
 
+void CanRxHandler::initialize()
+{
+    updateRxFilters(CanBus::CAN_BUS1);
+    updateRxFilters(CanBus::CAN_BUS2);
+}
+
 void CanRxHandler::attachReceiveHandler(CanRxListener* const listener)
 {
     if (listener->canBus == can::CanBus::CAN_BUS1)
@@ -46,6 +56,7 @@ void CanRxHandler::attachReceiveHandler(CanRxListener* const listener)
     {
         attachReceiveHandler(listener, messageHandlerStoreCan2);
     }
+    updateRxFilters(listener->canBus);
 }
 
 void CanRxHandler::attachReceiveHandler(
@@ -61,24 +72,124 @@ void CanRxHandler::attachReceiveHandler(
 }
 
 void CanRxHandler::pollCanData()
+{
+    uint32_t pollStart = arch::clock::getTimeMicroseconds();
+    int framesCan1 = 0;
+    int framesCan2 = 0;
+    bool can1Empty = false;
+    bool can2Empty = false;
+
+    // Alternate between the buses so neither starves the other when the budget runs out
+    while (true)
+    {
+        if (!can1Empty && framesCan1 < maxFramesPerBus)
+        {
+            can1Empty = !pollCanBus(CanBus::CAN_BUS1);
+            framesCan1 += can1Empty ? 0 : 1;
+        }
+        if (!can2Empty && framesCan2 < maxFramesPerBus)
+        {
+            can2Empty = !pollCanBus(CanBus::CAN_BUS2);
+            framesCan2 += can2Empty ? 0 : 1;
+        }
+
+        bool can1Done = can1Empty || framesCan1 >= maxFramesPerBus;
+        bool can2Done = can2Empty || framesCan2 >= maxFramesPerBus;
+        if ((can1Done && can2Done) ||
+            (drainTimeBudget != 0 &&
+             arch::clock::getTimeMicroseconds() - pollStart >= drainTimeBudget))
+        {
+            break;
+        }
+    }
+
+    const CanBus buses[] = {CanBus::CAN_BUS1, CanBus::CAN_BUS2};
+    const int frames[] = {framesCan1, framesCan2};
+    const bool empty[] = {can1Empty, can2Empty};
+    for (int i = 0; i < 2; i++)
+    {
+        RxStats& stats = rxStats[i];
+        stats.frames += frames[i];
+        stats.maxFramesPerPoll = std::max(stats.maxFramesPerPoll, static_cast<uint32_t>(frames[i]));
+        if (!empty[i] && drivers->can.isMessageAvailable(buses[i]))
+        {
+            stats.backlogPolls++;
+        }
+        stats.overflows = drivers->can.getRxOverflowCount(buses[i]);
+    }
+}
+
+bool CanRxHandler::pollCanBus(CanBus bus)
 {
     modm::can::Message rxMessage;
+    uint32_t timestamp;
+    if (!drivers->can.getMessage(bus, &rxMessage, &timestamp))
+    {
+        return false;
+    }
+    drivers->canStats.recordRx(bus, rxMessage);
+
+    // DJI motor feedback is decoded straight into the bus's motor bank, without a virtual call
+    // to the motor listening for it
+    motor::DjiMotorBank& motorBank =
+        bus == CanBus::CAN_BUS1 ? drivers->djiMotorBankCan1 : drivers->djiMotorBankCan2;
+#ifdef RUN_WITH_PROFILING
+    static const int decodeProbe = arch::Profiler::registerProbe("DjiMotorBank::decode");
+    drivers->profiler.push(decodeProbe);
+#endif
+    bool decoded = motorBank.decode(rxMessage, timestamp);
+#ifdef RUN_WITH_PROFILING
+    drivers->profiler.pop();
+#endif
+    if (decoded)
+    {
+        uint16_t id = lookupTableIndexForCanId(rxMessage.getIdentifier());
+        CanRxListener* listener = getHandlerStore(bus)[id];
+        if (listener != nullptr)
+        {
+            listener->receiveTimestamp = timestamp;
+            listener->receiveCount++;
+        }
+    }
+    else
+    {
+        processReceivedCanData(rxMessage, timestamp, getHandlerStore(bus));
+    }
+    return true;
+}
 
-    // handle incoming CAN 1 messages
-    if (drivers->can.getMessage(CanBus::CAN_BUS1, &rxMessage))
+void CanRxHandler::updateRxFilters(CanBus bus)
+{
+    CanRxListener* const* messageHandlerStore = getHandlerStore(bus);
+    uint16_t ids[NUM_CAN_IDS];
+    int numIds = 0;
+    for (uint16_t i = 0; i < NUM_CAN_IDS; i++)
     {
-        processReceivedCanData(rxMessage, messageHandlerStoreCan1);
+        if (messageHandlerStore[i] != nullptr)
+        {
+            ids[numIds++] = MIN_CAN_ID + i;
+        }
     }
 
-    // handle incoming CAN 2 messages
-    if (drivers->can.getMessage(CanBus::CAN_BUS2, &rxMessage))
+    CanIdFilter filters[Can::MAX_RX_FILTERS];
+    int numFilters = buildCanIdFilters(ids, numIds, filters, Can::MAX_RX_FILTERS);
+    drivers->can.setRxFilters(bus, filters, numFilters);
+}
+
+void CanRxHandler::setDrainLimits(int maxFramesPerBus, uint32_t timeBudget)
+{
+    if (maxFramesPerBus <= 0)
     {
-        processReceivedCanData(rxMessage, messageHandlerStoreCan2);
+        RAISE_ERROR(drivers, "CAN drain limit must be positive");
+        return;
     }
+    this->maxFramesPerBus = maxFramesPerBus;
+    drainTimeBudget = timeBudget;
 }
 
 void CanRxHandler::processReceivedCanData(
     const modm::can::Message& rxMessage,
+    uint32_t timestamp,
     CanRxListener* const* messageHandlerStore)
 {
     uint16_t id = lookupTableIndexForCanId(rxMessage.getIdentifier());
@@ -91,7 +202,9 @@ void CanRxHandler::processReceivedCanData(
 
     if (messageHandlerStore[id] != nullptr)
     {
+        messageHandlerStore[id]->receiveTimestamp = timestamp;
         messageHandlerStore[id]->processMessage(rxMessage);
+        messageHandlerStore[id]->receiveCount++;
     }
 }
 
@@ -105,6 +218,7 @@ void CanRxHandler::removeReceiveHandler(const CanRxListener& canRxListener)
     {
         removeReceiveHandler(canRxListener, messageHandlerStoreCan2);
     }
+    updateRxFilters(canRxListener.canBus);
 }
 
 void CanRxHandler::removeReceiveHandler(
@@ -47,7 +47,8 @@ class CanRxListener;
  * identifier and CAN bus and calls the listener's `processMessage`
  * function.
  *
- * Interfaces with modm receive data from CAN1 and CAN2 buses.
+ * Interfaces with `Can` to receive data from CAN1 and CAN2 buses. Before a listener's
+ * `processMessage` is called, its `getReceiveTimestamp` is set to the time the message arrived.
  *
  * To use, extend CanRxListener class and create a method called
  * processMessage. Next, call the function attachReceiveHandler,
@@ -61,6 +62,21 @@ class CanRxListener;
  * pollCanData function be called at a very high frequency,
  * so call this in a high frequency thread.
  *
+ * By default each call to pollCanData processes at most one frame per bus. Use
+ * `setDrainLimits` to drain up to a number of frames per bus, or until a time budget is used
+ * up, per call instead, so listeners catch up with every frame that arrived since the last
+ * call. Per bus reception statistics (see `getRxStats`) tell whether frames are being left
+ * waiting or lost.
+ *
+ * On `initialize` and whenever a listener is attached or removed, the acceptance filters of
+ * the bus are set (see `Can::setRxFilters`) to accept exactly the identifiers that have
+ * listeners, so frames nobody listens to never reach the receive ring. A bus without listeners
+ * receives nothing.
+ *
+ * Feedback from DJI motors registered in the bus's `motor::DjiMotorBank` is decoded directly
+ * into the bank rather than passed to the `DjiMotor` listener's `processMessage`. The listener's
+ * receive count and timestamp are still updated.
+ *
  * @note The CAN handler can handle 64 CAN ids between [`0x1E4`, `0x224`). In the middle of this
  *      range, CAN ids [`0x201`, `0x20B`] are used by the `DjiMotor` objects to receive data from
  *      DJI branded motors. If you would like to define your own protocol, it is recommended to
@@ -79,6 +95,23 @@ public:
     static constexpr uint16_t NUM_CAN_IDS = 64;
     static constexpr uint16_t MAX_CAN_ID = MIN_CAN_ID + NUM_CAN_IDS;
 
+    static constexpr int DEFAULT_MAX_FRAMES_PER_BUS = 1;
+
+    /**
+     * Reception statistics of a single bus, since boot.
+     */
+    struct RxStats
+    {
+        /// Number of frames processed.
+        uint32_t frames = 0;
+        /// The most frames processed in a single `pollCanData` call.
+        uint32_t maxFramesPerPoll = 0;
+        /// Number of `pollCanData` calls that left frames waiting, due to the drain limits.
+        uint32_t backlogPolls = 0;
+        /// Number of frames dropped by the CAN driver before they could be processed.
+        uint32_t overflows = 0;
+    };
+
     CanRxHandler(Drivers* drivers);
     mockable ~CanRxHandler() = default;
     DISALLOW_COPY_AND_ASSIGN(CanRxHandler)
@@ -97,6 +130,13 @@ public:
         return canId - MIN_CAN_ID;
     }
 
+    /**
+     * Sets the acceptance filters of both buses from the listeners attached so far, so that a
+     * bus without any listeners rejects every frame rather than keeping the accept-all filters
+     * `Can` starts with. Call once, after `Can::initialize`.
+     */
+    mockable void initialize();
+
     /**
      * Call this function to add a CanRxListener to the list of CanRxListener's
      * that are referenced when a new CAN message is received.
@@ -119,13 +159,31 @@ public:
      * Function handles receiving messages and calling the appropriate
      * processMessage function given the CAN bus and can identifier.
      *
+     * Frames are taken from the two buses in turn until both are empty, `maxFramesPerBus`
+     * frames were processed on each, or the time budget is used up.
+     *
      * @attention you should call this function as frequently as you receive
      *      messages if you want to receive the most up to date messages.
-     *      modm's IQR puts CAN messages in a queue, and this function
-     *      clears out the queue once it is called.
+     *      The CAN receive interrupts put CAN messages in a ring, and this
+     *      function clears out the ring once it is called.
      */
     mockable void pollCanData();
 
+    /**
+     * Sets how much of the receive queues a single `pollCanData` call drains.
+     *
+     * @param[in] maxFramesPerBus The maximum number of frames processed per bus per call. Must
+     *      be positive.
+     * @param[in] timeBudget No more frames are taken once a call has run for this long, in
+     *      microseconds. 0 for no time limit. At least one frame per bus is always processed.
+     */
+    mockable void setDrainLimits(int maxFramesPerBus, uint32_t timeBudget);
+
+    mockable const RxStats& getRxStats(CanBus bus) const
+    {
+        return bus == CanBus::CAN_BUS1 ? rxStats[0] : rxStats[1];
+    }
+
     /**
      * Removes the passed in `CanRxListener` from the `CanRxHandler`. If the
      * listener isn't in the handler, an error will be added to the `ErrorController`
@@ -150,6 +208,24 @@ private:
      */
     CanRxListener* messageHandlerStoreCan2[NUM_CAN_IDS];
 
+    int maxFramesPerBus = DEFAULT_MAX_FRAMES_PER_BUS;
+
+    uint32_t drainTimeBudget = 0;
+
+    RxStats rxStats[2];
+
+    /**
+     * Takes and processes one frame from `bus`, if there is one.
+     *
+     * @return `true` if a frame was processed.
+     */
+    bool pollCanBus(CanBus bus);
+
+    /**
+     * Sets the acceptance filters of `bus` from the identifiers that have listeners on it.
+     */
+    void updateRxFilters(CanBus bus);
+
 #if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
 public:
 #endif
@@ -160,6 +236,7 @@ public:
 
     void processReceivedCanData(
         const modm::can::Message& rxMessage,
+        uint32_t timestamp,
         CanRxListener* const* messageHandlerStore);
 
     void removeReceiveHandler(
@@ -114,10 +114,26 @@ public:
      * Pure virtual function: When you extend this class declare this
      * function.
      *
+     * Not called for feedback of `motor::DjiMotor`s, which `CanRxHandler` decodes into their
+     * `motor::DjiMotorBank` directly.
+     *
      * @param[in] message a new message received on the CAN bus.
      */
     virtual void processMessage(const modm::can::Message& message) = 0;
 
+    /**
+     * @return The number of messages the `CanRxHandler` has passed to this listener. Wraps
+     *      around, so only useful to detect that new data has arrived.
+     */
+    inline uint32_t getReceiveCount() const { return receiveCount; }
+
+    /**
+     * @return The time the last message passed to this listener arrived on the bus, in
+     *      microseconds. Inside `processMessage`, the arrival time of the message being
+     *      processed. 0 if no message has been received yet.
+     */
+    inline uint32_t getReceiveTimestamp() const { return receiveTimestamp; }
+
     /**
      * A variable necessary for the receive handler to determine
      * which message corresponds to which CanRxListener child class.
@@ -131,6 +147,13 @@ public:
     const CanBus canBus;
 
     Drivers* drivers;
+
+private:
+    friend class CanRxHandler;
+
+    uint32_t receiveCount = 0;
+
+    uint32_t receiveTimestamp = 0;
 };  // class CanRxListener
 
 }  // namespace can
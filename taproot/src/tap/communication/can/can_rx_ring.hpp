@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAN_RX_RING_HPP_
+#define CAN_RX_RING_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::can
+{
+/**
+ * A received CAN frame and the time it arrived.
+ */
+struct TimestampedCanMessage
+{
+    modm::can::Message message;
+    /// Arrival time of the frame, in microseconds.
+    uint32_t timestamp = 0;
+};
+
+/**
+ * A lock-free single producer, single consumer ring of received CAN frames. The producer (the
+ * CAN receive interrupt) only calls `push` and the consumer (the main loop, through `Can`) only
+ * calls `pop`, `isEmpty` and `size`, so neither needs to disable interrupts.
+ *
+ * @tparam SIZE The number of slots, a power of two. One slot is kept free to tell a full ring
+ *      from an empty one, so at most `SIZE - 1` frames are held.
+ */
+template <uint16_t SIZE>
+class CanRxRing
+{
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+public:
+    /**
+     * Adds a frame. Producer only.
+     *
+     * @return `false` and counts the frame as dropped if the ring is full.
+     */
+    bool push(const modm::can::Message& message, uint32_t timestamp)
+    {
+        uint16_t h = head.load(std::memory_order_relaxed);
+        uint16_t next = (h + 1) & MASK;
+        if (next == tail.load(std::memory_order_acquire))
+        {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        frames[h].message = message;
+        frames[h].timestamp = timestamp;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest frame. Consumer only.
+     *
+     * @return `false` if the ring is empty, in which case `frame` is left unchanged.
+     */
+    bool pop(TimestampedCanMessage* frame)
+    {
+        uint16_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        *frame = frames[t];
+        tail.store((t + 1) & MASK, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+    }
+
+    uint16_t size() const
+    {
+        return (head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed)) &
+               MASK;
+    }
+
+    /// @return The number of frames `push` dropped because the ring was full.
+    uint32_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint16_t MASK = SIZE - 1;
+
+    TimestampedCanMessage frames[SIZE];
+
+    /// Next slot `push` writes, only written by the producer.
+    std::atomic<uint16_t> head{0};
+
+    /// Next slot `pop` reads, only written by the consumer.
+    std::atomic<uint16_t> tail{0};
+
+    std::atomic<uint32_t> dropped{0};
+};  // class CanRxRing
+
+}  // namespace tap::can
+
+#endif  // CAN_RX_RING_HPP_
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "can_stats.hpp"
+
+#include "tap/architecture/clock.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::can
+{
+uint32_t CanStats::frameBits(const modm::can::Message& message)
+{
+    uint32_t dataBits = message.isRemoteTransmitRequest() ? 0 : 8 * message.getLength();
+    // Start of frame, arbitration and control fields, data and CRC are subject to bit
+    // stuffing, at worst one stuff bit after the first five bits and every four after that
+    uint32_t stuffedBits = (message.isExtended() ? 54 : 34) + dataBits;
+    // CRC delimiter, acknowledge slot and delimiter, end of frame and interframe space
+    return stuffedBits + (stuffedBits - 1) / 4 + 13;
+}
+
+void CanStats::record(DirectionStats& stats, const modm::can::Message& message)
+{
+    uint32_t bits = frameBits(message);
+    uint32_t bytes = message.isRemoteTransmitRequest() ? 0 : message.getLength();
+
+    stats.total.frames++;
+    stats.total.bytes += bytes;
+    stats.total.bits += bits;
+
+    uint32_t identifier = message.getIdentifier();
+    int id = 0;
+    while (id < stats.numIds && stats.ids[id].identifier != identifier)
+    {
+        id++;
+    }
+    if (id == stats.numIds)
+    {
+        if (stats.numIds == MAX_IDS_PER_BUS)
+        {
+            return;
+        }
+        // Fully set up the new entry before it becomes visible to readers
+        stats.ids[id] = IdStats();
+        stats.ids[id].identifier = identifier;
+        stats.numIds++;
+    }
+    stats.ids[id].total.frames++;
+    stats.ids[id].total.bytes += bytes;
+    stats.ids[id].total.bits += bits;
+}
+
+void CanStats::recordRx(CanBus bus, const modm::can::Message& message)
+{
+    record(busStats[busIndex(bus)].rx, message);
+}
+
+void CanStats::recordTx(CanBus bus, const modm::can::Message& message)
+{
+    record(busStats[busIndex(bus)].tx, message);
+}
+
+void CanStats::recordTxFailures(CanBus bus, uint32_t count)
+{
+    busStats[busIndex(bus)].txFailures += count;
+}
+
+void CanStats::recordTxNotReady(CanBus bus, uint32_t count)
+{
+    busStats[busIndex(bus)].txNotReady += count;
+}
+
+/**
+ * @return The rate, per second, at which a counter increased by `delta` over `elapsed` us.
+ */
+static inline uint32_t perSecond(uint32_t delta, uint32_t elapsed)
+{
+    return static_cast<uint64_t>(delta) * 1'000'000 / elapsed;
+}
+
+void CanStats::sampleDirection(
+    DirectionStats& stats,
+    Counters& last,
+    Counters* lastIds,
+    uint32_t elapsed)
+{
+    stats.framesPerSecond = perSecond(stats.total.frames - last.frames, elapsed);
+    stats.bytesPerSecond = perSecond(stats.total.bytes - last.bytes, elapsed);
+    last = stats.total;
+
+    for (int i = 0; i < stats.numIds; i++)
+    {
+        IdStats& id = stats.ids[i];
+        id.framesPerSecond = perSecond(id.total.frames - lastIds[i].frames, elapsed);
+        id.bytesPerSecond = perSecond(id.total.bytes - lastIds[i].bytes, elapsed);
+        lastIds[i] = id.total;
+    }
+}
+
+void CanStats::sample()
+{
+    uint32_t now = arch::clock::getTimeMicroseconds();
+    uint32_t elapsed = now - lastSampleTime;
+    if (elapsed == 0)
+    {
+        return;
+    }
+    lastSampleTime = now;
+
+    for (int i = 0; i < 2; i++)
+    {
+        BusStats& stats = busStats[i];
+        Snapshot& last = lastSample[i];
+        uint32_t bits = (stats.rx.total.bits - last.rx.bits) + (stats.tx.total.bits - last.tx.bits);
+        stats.loadPermille = static_cast<uint64_t>(bits) * 1'000 * 1'000'000 /
+                             (static_cast<uint64_t>(elapsed) * BIT_RATE);
+
+        sampleDirection(stats.rx, last.rx, last.rxIds, elapsed);
+        sampleDirection(stats.tx, last.tx, last.txIds, elapsed);
+    }
+}
+
+void CanStats::reset()
+{
+    for (int i = 0; i < 2; i++)
+    {
+        busStats[i] = BusStats();
+        lastSample[i] = Snapshot();
+    }
+    lastSampleTime = arch::clock::getTimeMicroseconds();
+}
+
+}  // namespace tap::can
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAN_STATS_HPP_
+#define CAN_STATS_HPP_
+
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#include "can_bus.hpp"
+
+namespace modm::can
+{
+class Message;
+}
+
+namespace tap::can
+{
+/**
+ * Counts the CAN frames received and sent on each bus, in total and per identifier, and
+ * estimates how busy each bus is.
+ *
+ * Received frames are recorded by the `CanRxHandler`, sent frames and send failures by `Can`
+ * as its transmit interrupts load the hardware mailboxes or drop frames, and full transmit
+ * queues by the `DjiMotorTxHandler`. The counters only ever increase and each is written from
+ * a single context (received frames from the main loop, sent frames and failures from the
+ * transmit interrupt or with it masked, full queues from the control pass), so they may be read
+ * at any time. Rates are computed by `sample`, which only the reader calls.
+ *
+ * Each frame is counted as its worst case length on the wire including bit stuffing, so the
+ * estimated load is an upper bound. Frames rejected by the acceptance filters (see
+ * `Can::setRxFilters`) are never seen, so the load does not include traffic nobody listens to.
+ */
+class CanStats
+{
+public:
+    /// The bit rate both buses are configured to, in bits per second.
+    static constexpr uint32_t BIT_RATE = 1'000'000;
+
+    /// Identifiers tracked individually per bus and direction, further ones are only counted in
+    /// the bus totals.
+    static constexpr int MAX_IDS_PER_BUS = 16;
+
+    /// Frame, byte and bit counts.
+    struct Counters
+    {
+        uint32_t frames = 0;
+        uint32_t bytes = 0;
+        uint32_t bits = 0;
+    };
+
+    /// Counts and rates of frames with a single identifier in one direction.
+    struct IdStats
+    {
+        uint32_t identifier = 0;
+        Counters total;
+        uint32_t framesPerSecond = 0;
+        uint32_t bytesPerSecond = 0;
+    };
+
+    /// Counts and rates of the frames in one direction on a bus.
+    struct DirectionStats
+    {
+        Counters total;
+        uint32_t framesPerSecond = 0;
+        uint32_t bytesPerSecond = 0;
+        IdStats ids[MAX_IDS_PER_BUS];
+        int numIds = 0;
+    };
+
+    struct BusStats
+    {
+        DirectionStats rx;
+        DirectionStats tx;
+        /// Number of frames dropped by `Can`, either because the transmit queue was full or
+        /// because their deadline passed while queued.
+        uint32_t txFailures = 0;
+        /// Number of times frames were not sent because the bus's transmit queue was full.
+        uint32_t txNotReady = 0;
+        /// Estimated share of the bus's bit time in use, in tenths of a percent.
+        uint32_t loadPermille = 0;
+    };
+
+    CanStats() = default;
+    DISALLOW_COPY_AND_ASSIGN(CanStats)
+
+    /**
+     * @return The worst case number of bits `message` takes up on the wire, including bit
+     *      stuffing, the end of frame and the interframe space.
+     */
+    static uint32_t frameBits(const modm::can::Message& message);
+
+    /// Records a frame received on `bus`.
+    void recordRx(CanBus bus, const modm::can::Message& message);
+
+    /// Records a frame loaded into a transmit mailbox of `bus`.
+    void recordTx(CanBus bus, const modm::can::Message& message);
+
+    /// Records that `count` frames queued or about to be queued on `bus` were dropped.
+    void recordTxFailures(CanBus bus, uint32_t count = 1);
+
+    /// Records that `count` frames could not be sent on `bus` because it was not ready.
+    void recordTxNotReady(CanBus bus, uint32_t count = 1);
+
+    /**
+     * Updates the rates and bus load from the counts since the previous call. Call
+     * periodically, from the context that reads the statistics.
+     */
+    void sample();
+
+    /// Clears all counters and rates.
+    void reset();
+
+    inline const BusStats& getBusStats(CanBus bus) const { return busStats[busIndex(bus)]; }
+
+private:
+    BusStats busStats[2];
+
+    /// Counts at the previous `sample` call, only used by `sample`.
+    struct Snapshot
+    {
+        Counters rx;
+        Counters tx;
+        Counters rxIds[MAX_IDS_PER_BUS];
+        Counters txIds[MAX_IDS_PER_BUS];
+    } lastSample[2] = {};
+
+    uint32_t lastSampleTime = 0;
+
+    static inline int busIndex(CanBus bus) { return bus == CanBus::CAN_BUS1 ? 0 : 1; }
+
+    static void record(DirectionStats& stats, const modm::can::Message& message);
+
+    static void sampleDirection(
+        DirectionStats& stats,
+        Counters& last,
+        Counters* lastIds,
+        uint32_t elapsed);
+};  // class CanStats
+
+}  // namespace tap::can
+
+#endif  // CAN_STATS_HPP_
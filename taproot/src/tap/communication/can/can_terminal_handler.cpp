@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "can_terminal_handler.hpp"
+
+#include "tap/algorithms/strtok.hpp"
+#include "tap/drivers.hpp"
+
+namespace tap
+{
+namespace can
+{
+constexpr char CanTerminalHandler::HEADER[];
+constexpr char CanTerminalHandler::USAGE[];
+
+void CanTerminalHandler::init() { drivers->terminalSerial.addHeader(HEADER, this); }
+
+bool CanTerminalHandler::terminalSerialCallback(
+    char* inputLine,
+    modm::IOStream& outputStream,
+    bool streamingEnabled)
+{
+    char* arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine);
+
+    if (arg != nullptr && strcmp(arg, "stats") == 0)
+    {
+        printStats(outputStream);
+        return true;
+    }
+    else if (arg != nullptr && strcmp(arg, "reset") == 0)
+    {
+        drivers->canStats.reset();
+        outputStream << "CAN statistics cleared" << modm::endl;
+        return !streamingEnabled;
+    }
+    else
+    {
+        outputStream << USAGE;
+        return (arg != nullptr) && !streamingEnabled && (strcmp(arg, "-H") == 0);
+    }
+}
+
+void CanTerminalHandler::terminalSerialStreamCallback(modm::IOStream& outputStream)
+{
+    printStats(outputStream);
+}
+
+void CanTerminalHandler::printStats(modm::IOStream& outputStream)
+{
+    drivers->canStats.sample();
+    printBusStats(CanBus::CAN_BUS1, outputStream);
+    printBusStats(CanBus::CAN_BUS2, outputStream);
+}
+
+static void printDirection(
+    const char* name,
+    const CanStats::DirectionStats& stats,
+    modm::IOStream& outputStream)
+{
+    outputStream << " " << name << ": " << stats.framesPerSecond << " frames/s, "
+                 << stats.bytesPerSecond << " B/s, " << stats.total.frames << " frames"
+                 << modm::endl;
+    for (int i = 0; i < stats.numIds; i++)
+    {
+        const CanStats::IdStats& id = stats.ids[i];
+        outputStream << "  0x" << modm::hex << static_cast<uint16_t>(id.identifier) << modm::ascii
+                     << ": " << id.framesPerSecond << " frames/s, " << id.bytesPerSecond
+                     << " B/s, " << id.total.frames << " frames" << modm::endl;
+    }
+}
+
+static const char* const TX_PRIORITY_NAMES[NUM_CAN_TX_PRIORITIES] = {
+    "control",
+    "normal",
+    "telemetry"};
+
+void CanTerminalHandler::printBusStats(CanBus bus, modm::IOStream& outputStream)
+{
+    const CanStats::BusStats& stats = drivers->canStats.getBusStats(bus);
+
+    outputStream << "CAN " << (bus == CanBus::CAN_BUS1 ? 1 : 2) << ": load "
+                 << stats.loadPermille / 10 << "." << stats.loadPermille % 10
+                 << "%, tx failures: " << stats.txFailures
+                 << ", tx not ready: " << stats.txNotReady
+                 << ", rx dropped: " << drivers->can.getRxOverflowCount(bus) << modm::endl;
+    printDirection("rx", stats.rx, outputStream);
+    printDirection("tx", stats.tx, outputStream);
+    for (int i = 0; i < NUM_CAN_TX_PRIORITIES; i++)
+    {
+        const CanTxQueue::Stats queue =
+            drivers->can.getTxQueueStats(bus, static_cast<CanTxPriority>(i));
+        outputStream << " tx queue " << TX_PRIORITY_NAMES[i] << ": " << queue.queued
+                     << " queued, " << queue.sent << " sent, " << queue.deadlineMisses
+                     << " deadline misses, " << queue.overflows << " overflows" << modm::endl;
+    }
+}
+}  // namespace can
+
+}  // namespace tap
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAN_TERMINAL_HANDLER_HPP_
+#define CAN_TERMINAL_HANDLER_HPP_
+
+#include "tap/communication/serial/terminal_serial.hpp"
+#include "tap/util_macros.hpp"
+
+#include "can_bus.hpp"
+#include "can_stats.hpp"
+
+namespace tap
+{
+class Drivers;
+namespace can
+{
+/**
+ * Prints the traffic statistics of both CAN buses kept in `drivers->canStats`.
+ */
+class CanTerminalHandler : public communication::serial::TerminalSerialCallbackInterface
+{
+public:
+    static constexpr char HEADER[] = "can";
+
+    CanTerminalHandler(Drivers* drivers) : drivers(drivers) {}
+    DISALLOW_COPY_AND_ASSIGN(CanTerminalHandler);
+
+    void init();
+
+    bool terminalSerialCallback(
+        char* inputLine,
+        modm::IOStream& outputStream,
+        bool streamingEnabled) override;
+
+    void terminalSerialStreamCallback(modm::IOStream& outputStream) override;
+
+private:
+    static constexpr char USAGE[] =
+        "Usage: can [-S] <target>\n"
+        "  Where \"<target>\" is one of:\n"
+        "    - \"-H\": displays possible commands.\n"
+        "    - \"stats\" prints the estimated load of each bus and the frames/s and bytes/s\n"
+        "      received and sent, in total and per identifier, averaged since the last time\n"
+        "      they were printed, use -S to stream them, and the frames queued, sent,\n"
+        "      dropped past their deadline and rejected by each transmit priority class.\n"
+        "    - \"reset\" clears all counters.\n";
+
+    Drivers* drivers;
+
+    void printStats(modm::IOStream& outputStream);
+
+    void printBusStats(CanBus bus, modm::IOStream& outputStream);
+};  // class CanTerminalHandler
+
+}  // namespace can
+
+}  // namespace tap
+
+#endif  // CAN_TERMINAL_HANDLER_HPP_
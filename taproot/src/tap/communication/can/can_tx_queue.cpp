@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "can_tx_queue.hpp"
+
+namespace tap::can
+{
+bool CanTxQueue::push(
+    const modm::can::Message& message,
+    CanTxPriority priority,
+    uint32_t now,
+    uint32_t maxAge)
+{
+    PriorityClass& queue = classes[static_cast<int>(priority)];
+    if (queue.count == SLOTS_PER_PRIORITY)
+    {
+        queue.stats.overflows++;
+        return false;
+    }
+
+    QueuedFrame& frame = queue.frames[(queue.head + queue.count) % SLOTS_PER_PRIORITY];
+    frame.message = message;
+    frame.deadline = now + maxAge;
+    frame.hasDeadline = maxAge != 0;
+    queue.count++;
+    queue.stats.queued++;
+    return true;
+}
+
+bool CanTxQueue::pop(uint32_t now, modm::can::Message* message)
+{
+    for (PriorityClass& queue : classes)
+    {
+        while (queue.count > 0)
+        {
+            const QueuedFrame& frame = queue.frames[queue.head];
+            queue.head = (queue.head + 1) % SLOTS_PER_PRIORITY;
+            queue.count--;
+
+            // Compare through the difference so the clock wrapping around does not matter
+            if (frame.hasDeadline && static_cast<int32_t>(now - frame.deadline) > 0)
+            {
+                queue.stats.deadlineMisses++;
+                continue;
+            }
+
+            *message = frame.message;
+            queue.stats.sent++;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace tap::can
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAN_TX_QUEUE_HPP_
+#define CAN_TX_QUEUE_HPP_
+
+#include <cstdint>
+
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::can
+{
+/**
+ * Priority classes of queued CAN frames. A frame is only sent once no frame of a higher class
+ * is waiting.
+ */
+enum class CanTxPriority : uint8_t
+{
+    /// Actuator setpoints, such as `DjiMotor` output commands.
+    CONTROL = 0,
+    /// Everything else, the class frames given to `Can::sendMessage` are queued in.
+    NORMAL = 1,
+    /// Low rate status and telemetry frames that may wait behind everything else.
+    TELEMETRY = 2,
+};
+
+static constexpr int NUM_CAN_TX_PRIORITIES = 3;
+
+/**
+ * A transmit queue for a single CAN bus, with a FIFO per `CanTxPriority` class. Each frame may
+ * have a deadline, and frames still waiting at their deadline are dropped rather than sent
+ * late.
+ *
+ * Not thread safe, `Can` serializes access between the code queueing frames and the transmit
+ * interrupt taking them.
+ */
+class CanTxQueue
+{
+public:
+    /// Frames each priority class can hold.
+    static constexpr int SLOTS_PER_PRIORITY = 16;
+
+    /// Statistics of one priority class.
+    struct Stats
+    {
+        /// Number of frames queued.
+        uint32_t queued = 0;
+        /// Number of frames taken to be sent.
+        uint32_t sent = 0;
+        /// Number of frames dropped because their deadline passed while queued.
+        uint32_t deadlineMisses = 0;
+        /// Number of frames not queued because the class was full.
+        uint32_t overflows = 0;
+    };
+
+    /**
+     * Queues a frame.
+     *
+     * @param[in] priority the class to queue the frame in.
+     * @param[in] now the current time, in microseconds.
+     * @param[in] maxAge the time after `now` after which the frame is stale and is dropped if
+     *      it has not been sent, in microseconds. 0 for a frame that never goes stale.
+     * @return `false` if the class is full, in which case the frame is not queued.
+     */
+    bool push(
+        const modm::can::Message& message,
+        CanTxPriority priority,
+        uint32_t now,
+        uint32_t maxAge);
+
+    /**
+     * Takes the oldest frame of the highest priority class that has waiting frames, dropping
+     * stale frames on the way.
+     *
+     * @param[in] now the current time, in microseconds.
+     * @param[out] message the frame to send.
+     * @return `false` if no frame is waiting.
+     */
+    bool pop(uint32_t now, modm::can::Message* message);
+
+    bool isFull(CanTxPriority priority) const
+    {
+        return classes[static_cast<int>(priority)].count == SLOTS_PER_PRIORITY;
+    }
+
+    int size(CanTxPriority priority) const { return classes[static_cast<int>(priority)].count; }
+
+    const Stats& getStats(CanTxPriority priority) const
+    {
+        return classes[static_cast<int>(priority)].stats;
+    }
+
+    /// @return The number of frames of all classes dropped because their deadline passed.
+    uint32_t getDeadlineMisses() const
+    {
+        uint32_t misses = 0;
+        for (const PriorityClass& queue : classes)
+        {
+            misses += queue.stats.deadlineMisses;
+        }
+        return misses;
+    }
+
+private:
+    struct QueuedFrame
+    {
+        modm::can::Message message;
+        uint32_t deadline;
+        bool hasDeadline;
+    };
+
+    struct PriorityClass
+    {
+        QueuedFrame frames[SLOTS_PER_PRIORITY];
+        int head = 0;
+        int count = 0;
+        Stats stats;
+    };
+
+    PriorityClass classes[NUM_CAN_TX_PRIORITIES];
+};  // class CanTxQueue
+
+}  // namespace tap::can
+
+#endif  // CAN_TX_QUEUE_HPP_
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#include "motor_telemetry.hpp"
+
+#include <cstring>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor.hpp"
+
+namespace tap
+{
+namespace communication
+{
+void MotorTelemetry::update()
+{
+    uint32_t time = arch::clock::getTimeMicroseconds();
+    updateBank(drivers->djiMotorBankCan1, 0, time);
+    updateBank(drivers->djiMotorBankCan2, 1, time);
+}
+
+void MotorTelemetry::updateBank(const motor::DjiMotorBank& bank, uint8_t canBus, uint32_t time)
+{
+    uint8_t* batch = batches[canBus];
+    int count = 0;
+
+    for (int slot = 0; slot < motor::DjiMotorBank::NUM_MOTORS; slot++)
+    {
+        if (!bank.isRegistered(slot))
+        {
+            continue;
+        }
+
+        const motor::MotorFeedbackHistory& history = bank.getFeedbackHistory(slot);
+
+        MotorTelemetryRecord record = {};
+        record.encoderUnwrapped = bank.getEncoderUnwrapped(slot);
+        record.feedbackTime = history.size() > 0 ? history.get(0).timestamp : 0;
+        record.shaftRPM = bank.getShaftRPM(slot);
+        record.torque = bank.getTorque(slot);
+        record.desiredOutput = bank.getMotor(slot)->getOutputDesired();
+        record.canBus = canBus;
+        record.motorId = slot;
+        record.temperature = bank.getTemperature(slot);
+        record.flags = bank.isOnline(slot) ? 1 : 0;
+
+        memcpy(
+            batch + sizeof(MotorTelemetryHeader) + count * sizeof(MotorTelemetryRecord),
+            &record,
+            sizeof(record));
+        count++;
+    }
+
+    MotorTelemetryHeader header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.count = count;
+    header.channel = canBus == 0 ? CHANNEL_CAN1 : CHANNEL_CAN2;
+    header.sequence = sequences[canBus];
+    header.time = time;
+    memcpy(batch, &header, sizeof(header));
+    batchSizes[canBus] = sizeof(header) + count * sizeof(MotorTelemetryRecord);
+
+    if (count == 0)
+    {
+        return;
+    }
+    sequences[canBus]++;
+
+    TCPServer* server = TCPServer::MainServer();
+    if (server != nullptr && !server->publish(header.channel, batch, batchSizes[canBus]))
+    {
+        droppedBatches++;
+    }
+}
+
+}  // namespace communication
+
+}  // namespace tap
+
+#endif  // PLATFORM_HOSTED
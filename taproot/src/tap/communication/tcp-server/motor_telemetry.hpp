@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#ifndef MOTOR_TELEMETRY_HPP_
+#define MOTOR_TELEMETRY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/motor/dji_motor_bank.hpp"
+#include "tap/util_macros.hpp"
+
+#include "tcp_server.hpp"
+
+namespace tap
+{
+class Drivers;
+namespace communication
+{
+/**
+ * Header of a motor telemetry batch, followed by `count` `MotorTelemetryRecord`s. Sent little
+ * endian, in field order.
+ */
+struct MotorTelemetryHeader
+{
+    /// `MotorTelemetry::MAGIC`, to find the start of a batch in the stream.
+    uint16_t magic;
+    uint8_t version;
+    /// Number of records following the header.
+    uint8_t count;
+    /// `TCPServer` channel the batch was published on.
+    uint8_t channel;
+    uint8_t reserved[3];
+    /// Incremented for every batch of the channel, gaps mean batches were dropped.
+    uint32_t sequence;
+    /// Time the batch was collected, in microseconds.
+    uint32_t time;
+};
+
+static_assert(sizeof(MotorTelemetryHeader) == 16, "telemetry header must stay 16 bytes");
+
+/**
+ * State of a single motor. Sent little endian, in field order.
+ */
+struct MotorTelemetryRecord
+{
+    int64_t encoderUnwrapped;
+    /// Time of the latest feedback frame, in microseconds.
+    uint32_t feedbackTime;
+    int16_t shaftRPM;
+    int16_t torque;
+    int16_t desiredOutput;
+    /// 0 for CAN bus 1, 1 for CAN bus 2.
+    uint8_t canBus;
+    /// Normalized motor ID, 0 for the motor sending feedback with ID 0x201.
+    uint8_t motorId;
+    int8_t temperature;
+    /// Bit 0 is set if the motor is online.
+    uint8_t flags;
+    uint8_t reserved[2];
+};
+
+static_assert(sizeof(MotorTelemetryRecord) == 24, "telemetry records must stay 24 bytes");
+
+/**
+ * Collects the state of the registered DJI motors of each CAN bus into a batch of fixed size
+ * binary records once per control tick, and publishes it to the `TCPServer` on the bus's
+ * channel (`CHANNEL_CAN1` or `CHANNEL_CAN2`). Publishing never blocks, batches the server
+ * can't take are dropped.
+ *
+ * Decode the stream on the host with taproot/build_tools/decode_motor_telemetry.py, which can
+ * also print it as JSON.
+ */
+class MotorTelemetry
+{
+public:
+    /// "TM" in little endian.
+    static constexpr uint16_t MAGIC = 0x4d54;
+    static constexpr uint8_t VERSION = 2;
+    static constexpr uint8_t CHANNEL_CAN1 = 0;
+    static constexpr uint8_t CHANNEL_CAN2 = 1;
+    static constexpr int MAX_RECORDS = motor::DjiMotorBank::NUM_MOTORS;
+    static constexpr size_t MAX_BATCH_SIZE =
+        sizeof(MotorTelemetryHeader) + MAX_RECORDS * sizeof(MotorTelemetryRecord);
+
+    static_assert(MAX_BATCH_SIZE <= TCPServer::MAX_MESSAGE_SIZE, "batches must fit a message");
+
+    MotorTelemetry(Drivers* drivers) : drivers(drivers) {}
+    DISALLOW_COPY_AND_ASSIGN(MotorTelemetry)
+    mockable ~MotorTelemetry() = default;
+
+    /**
+     * Collects and publishes a batch for each bus with a registered motor. Call once per
+     * control tick, after the motor outputs have been sent.
+     */
+    mockable void update();
+
+    /// @return The last batch collected for `canBus` (0 or 1).
+    const uint8_t* getBatch(int canBus) const { return batches[canBus]; }
+
+    /// @return The size of the last batch collected for `canBus`, in bytes.
+    size_t getBatchSize(int canBus) const { return batchSizes[canBus]; }
+
+    /// @return The number of batches that couldn't be sent.
+    uint32_t getDroppedBatches() const { return droppedBatches; }
+
+private:
+    Drivers* drivers;
+
+    uint8_t batches[2][MAX_BATCH_SIZE] = {};
+    size_t batchSizes[2] = {};
+    uint32_t sequences[2] = {};
+    uint32_t droppedBatches = 0;
+
+    /// Packs and publishes the batch of `bank`.
+    void updateBank(const motor::DjiMotorBank& bank, uint8_t canBus, uint32_t time);
+};  // class MotorTelemetry
+
+}  // namespace communication
+
+}  // namespace tap
+
+#endif  // MOTOR_TELEMETRY_HPP_
+
+#endif  // PLATFORM_HOSTED
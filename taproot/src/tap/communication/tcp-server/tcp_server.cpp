@@ -23,246 +23,456 @@
 
 #ifdef __linux__
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
-#include <sys/types.h>
 #include <unistd.h>
 #endif  // __linux__
 
-#include <atomic>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <stdexcept>
 
-#include "json_messages.hpp"
-using std::cerr;
-/**
- * TCP Server class to allow MCB simulator to communicate with stuff.
- * I actually have no idea what's happening ~ Tenzin
- */
+#include "tap/algorithms/strtok.hpp"
+
 namespace tap
 {
 namespace communication
 {
-/**
- * TCPServer constructor. Runs a server on the given portnumber.
- * Also takes a function pointer. This function is left to the implementer
- * of a specific TCP server to define (it should take an int16_t parameter
- * for client file descriptor). Ideally mainLoop should use a non-blocking
- * loop as currently since threads detach its possible that if a client never
- * responds there could be threads that never close.
- */
+static constexpr uint32_t ALL_CHANNELS = 0xffffffff;
+static constexpr char COMMAND_DELIMITERS[] = " \t\r";
 
-TCPServer::TCPServer(int targetPortNumber)
-#ifdef __linux__
-    : socketOpened(false),
-      clientConnected(false),
-      mainClientDescriptor(-1),
-      serverAddress(),
-      portNumber(-1)
-#endif  // __linux__
+struct TCPServer::Client
+{
+    int fileDescriptor = -1;
+    /// Bit `i` is set if the client receives channel `i`.
+    uint32_t subscriptions = ALL_CHANNELS;
+
+    /// Messages not sent yet, oldest first, starting at `queueHead`.
+    Message queued[CLIENT_QUEUE_SIZE];
+    uint16_t queueHead = 0;
+    uint16_t queueCount = 0;
+
+    /// The message being sent, kept apart so that dropping old messages never tears it.
+    Message inFlight;
+    uint16_t inFlightOffset = 0;
+    bool hasInFlight = false;
+
+    bool waitingForWritable = false;
+
+    char command[MAX_COMMAND_LENGTH + 1];
+    size_t commandLength = 0;
+
+    uint32_t dropped = 0;
+};
+
+TCPServer::TCPServer() {}
+
+TCPServer::~TCPServer() { stop(); }
+
+TCPServer* TCPServer::MainServer()
+{
+#if defined(ENV_UNIT_TESTS) || !defined(__linux__)
+    return nullptr;
+#else
+    // Constructed on first use, and doesn't bind anything until started
+    static TCPServer mainServer;
+    return &mainServer;
+#endif
+}
+
+bool TCPServer::start(uint16_t port)
 {
 #ifdef __linux__
-    // Do sockety stuff.
-    listenFileDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+    if (isRunning())
+    {
+        return false;
+    }
+
+    listenFileDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
     if (listenFileDescriptor < 0)
     {
         perror("TCPServer failed to open socket");
-        throw std::runtime_error("SocketError");
+        return false;
     }
 
     int yes = 1;
-    if (setsockopt(listenFileDescriptor, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)))
-    {
-        perror("TCPSever failed to set socket options");
-        throw std::runtime_error("SocketOptionsError");
-    }
+    setsockopt(listenFileDescriptor, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
 
-    socketOpened = true;
+    sockaddr_in serverAddress = {};
     serverAddress.sin_family = AF_INET;
-    serverAddress.sin_port = htons(targetPortNumber);
+    serverAddress.sin_port = htons(port);
     serverAddress.sin_addr.s_addr = INADDR_ANY;
+    socklen_t addressLength = sizeof(serverAddress);
 
-    int n = bind(
-        listenFileDescriptor,
-        reinterpret_cast<sockaddr*>(&serverAddress),
-        sizeof(serverAddress));
-
-    if (n < 0)
+    if (bind(
+            listenFileDescriptor,
+            reinterpret_cast<sockaddr*>(&serverAddress),
+            sizeof(serverAddress)) < 0 ||
+        listen(listenFileDescriptor, LISTEN_QUEUE_SIZE) < 0 ||
+        getsockname(
+            listenFileDescriptor,
+            reinterpret_cast<sockaddr*>(&serverAddress),
+            &addressLength) < 0)
     {
         perror("TCPServer failed to bind socket");
-        // Good reference for why this error occurs and what it means:
-        // https://hea-www.harvard.edu/~fine/Tech/addrinuse.html
-        std::cerr << "If you're seeing this error it means that the TCPServer "
-                     "has failed to bind to a port too many times. If you're seeing this "
-                     "message, something is probably really messed up."
-                  << std::endl;
-        throw std::runtime_error("BindError");
+        close(listenFileDescriptor);
+        listenFileDescriptor = -1;
+        return false;
+    }
+
+    epollFileDescriptor = epoll_create1(0);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (epollFileDescriptor < 0 ||
+        epoll_ctl(epollFileDescriptor, EPOLL_CTL_ADD, listenFileDescriptor, &event) < 0)
+    {
+        perror("TCPServer failed to set up epoll");
+        close(listenFileDescriptor);
+        close(epollFileDescriptor);
+        listenFileDescriptor = -1;
+        epollFileDescriptor = -1;
+        return false;
     }
 
-    portNumber = targetPortNumber;
+    // Anything left from a previous run is stale, and no server thread is popping yet
+    Message stale;
+    while (queue.pop(&stale))
+    {
+    }
 
-    listen(listenFileDescriptor, LISTEN_QUEUE_SIZE);
-    std::cout << "TCPServer initialized on port: " << targetPortNumber << std::endl;
-    std::cout << "call getConnection() to accept client" << std::endl;
+    portNumber = ntohs(serverAddress.sin_port);
+    running = true;
+    serverThread = std::thread(&TCPServer::run, this);
+    std::cout << "TCPServer: streaming telemetry on port " << portNumber << std::endl;
+    return true;
 #else
-    UNUSED(targetPortNumber);
+    UNUSED(port);
+    return false;
 #endif  // __linux__
 }
 
-TCPServer::~TCPServer()
+void TCPServer::stop()
 {
 #ifdef __linux__
+    if (!isRunning())
+    {
+        return;
+    }
+
+    running = false;
+    serverThread.join();
+
+    for (auto& client : clients)
+    {
+        closeClient(client.get());
+    }
+    clients.clear();
+    clientCount = 0;
+
+    close(epollFileDescriptor);
     close(listenFileDescriptor);
-    close(mainClientDescriptor);
+    epollFileDescriptor = -1;
+    listenFileDescriptor = -1;
+    portNumber = 0;
 #endif  // __linux__
 }
 
-TCPServer* TCPServer::MainServer()
+bool TCPServer::publish(uint8_t channel, const uint8_t* data, uint16_t length)
 {
-#if defined(ENV_UNIT_TESTS) || !defined(__linux__)
-    return nullptr;
-#else
-    return &mainServer;
-#endif
+    if (!isRunning() || getClientCount() == 0)
+    {
+        return true;
+    }
+    return queue.push(channel, data, length);
 }
 
-void TCPServer::getConnection()
-{
 #ifdef __linux__
-    sockaddr_in clientAddress;
-    socklen_t clientAddressLength = sizeof(clientAddress);
-    mainClientDescriptor = accept(
-        listenFileDescriptor,
-        reinterpret_cast<sockaddr*>(&clientAddress),
-        &clientAddressLength);
-    cerr << "TCPServer: connection accepted" << std::endl;
-#endif  // __linux__
-}
-
-void TCPServer::closeConnection()
+void TCPServer::run()
 {
-#ifdef __linux__
-    close(mainClientDescriptor);
-    mainClientDescriptor = -1;
-    std::cout << "TCPServer: closed connection with client, "
-                 "use getConnection() to connect to a new one";
-#endif  // __linux__
+    epoll_event events[MAX_CLIENTS + 1];
+    Message message;
+
+    while (running)
+    {
+        int n = epoll_wait(epollFileDescriptor, events, MAX_CLIENTS + 1, POLL_PERIOD);
+
+        for (int i = 0; i < n; i++)
+        {
+            Client* client = static_cast<Client*>(events[i].data.ptr);
+            if (client == nullptr)
+            {
+                acceptClients();
+                continue;
+            }
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                closeClient(client);
+                continue;
+            }
+            if (events[i].events & EPOLLIN)
+            {
+                readCommands(client);
+            }
+            if ((events[i].events & EPOLLOUT) && client->fileDescriptor >= 0)
+            {
+                flush(client);
+            }
+        }
+
+        while (queue.pop(&message))
+        {
+            dispatch(message);
+        }
+
+        // Clients are only closed above, remove them once nothing refers to them anymore
+        clients.erase(
+            std::remove_if(
+                clients.begin(),
+                clients.end(),
+                [](const std::unique_ptr<Client>& c) { return c->fileDescriptor < 0; }),
+            clients.end());
+        clientCount = static_cast<int>(clients.size());
+    }
 }
 
-/**
- * Post: Returns the port number of this server.
- */
-uint16_t TCPServer::getPortNumber()
+void TCPServer::acceptClients()
 {
-#ifdef __linux__
-    return this->portNumber;
-#else
-    return 0;
-#endif  // __linux__
+    while (true)
+    {
+        int fileDescriptor = accept4(listenFileDescriptor, nullptr, nullptr, SOCK_NONBLOCK);
+        if (fileDescriptor < 0)
+        {
+            return;
+        }
+
+        if (clients.size() >= MAX_CLIENTS)
+        {
+            std::cerr << "TCPServer: too many clients, refusing connection" << std::endl;
+            close(fileDescriptor);
+            continue;
+        }
+
+        // Messages are small and latency matters more than throughput
+        int yes = 1;
+        setsockopt(fileDescriptor, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        auto client = std::make_unique<Client>();
+        client->fileDescriptor = fileDescriptor;
+
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.ptr = client.get();
+        if (epoll_ctl(epollFileDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) < 0)
+        {
+            close(fileDescriptor);
+            continue;
+        }
+
+        clients.push_back(std::move(client));
+        clientCount = static_cast<int>(clients.size());
+        std::cout << "TCPServer: connection accepted" << std::endl;
+    }
 }
 
-/**
- * Writes "messageLength" bytes of "message" to the mainClient
- */
-void TCPServer::writeToClient(const char* message, int32_t messageLength)
+void TCPServer::closeClient(Client* client)
 {
-#ifdef __linux__
-    if (mainClientDescriptor < 0)
+    if (client->fileDescriptor < 0)
     {
-        // Not necessarily an error if fileDescriptor still hasn't been opened
-        // so we just don't write to anything and early return.
-        cerr << "TCPServer: mainClientDescriptor not connected yet" << std::endl;
         return;
     }
-    try
-    {
-        writeMessage(mainClientDescriptor, message, messageLength);
-    }
-    catch (std::runtime_error& e)
-    {
-        std::cerr << e.what() << std::endl;
-    }
-#else
-    UNUSED(message);
-    UNUSED(messageLength);
-#endif  // __linux__
+    // Closing the socket removes it from the epoll set
+    close(client->fileDescriptor);
+    client->fileDescriptor = -1;
+    std::cout << "TCPServer: closed connection with client, " << client->dropped
+              << " messages dropped" << std::endl;
 }
 
-#ifdef __linux__
-void readMessage(int16_t fileDescriptor, char* readBuffer, uint16_t messageLength)
+void TCPServer::readCommands(Client* client)
 {
-    readBuffer[messageLength] = '\0';  // Null terminate the message
-    uint16_t bytesRead = read(fileDescriptor, readBuffer, messageLength);
-    while (bytesRead < messageLength)
+    while (true)
     {
-        int32_t n = read(fileDescriptor, readBuffer + bytesRead, messageLength - bytesRead);
+        ssize_t n = recv(
+            client->fileDescriptor,
+            client->command + client->commandLength,
+            MAX_COMMAND_LENGTH - client->commandLength,
+            MSG_DONTWAIT);
+        if (n == 0)
+        {
+            closeClient(client);
+            return;
+        }
         if (n < 0)
         {
-            if (errno == EAGAIN or errno == EINTR)
+            if (errno == EINTR)
             {
                 continue;
             }
-            else
+            if (errno != EAGAIN)
             {
-                perror("TCPServer failed to read from client");
-                throw std::runtime_error("ReadingError");
+                closeClient(client);
             }
+            return;
+        }
+        client->commandLength += n;
+
+        char* lineStart = client->command;
+        char* lineEnd;
+        while ((lineEnd = static_cast<char*>(memchr(
+                    lineStart,
+                    '\n',
+                    client->commandLength - (lineStart - client->command)))) != nullptr)
+        {
+            *lineEnd = '\0';
+            handleCommand(client, lineStart);
+            lineStart = lineEnd + 1;
+        }
+
+        client->commandLength -= lineStart - client->command;
+        memmove(client->command, lineStart, client->commandLength);
+        if (client->commandLength == MAX_COMMAND_LENGTH)
+        {
+            // No command is this long, discard it
+            client->commandLength = 0;
         }
-        bytesRead += n;
     }
 }
 
-/**
- * Write to connected connectionFileDescriptor, ensures that all bytes are sent.
- * Throws runtime_error if irrecoverable error occurs.
- */
-void writeMessage(int16_t fileDescriptor, const char* message, uint16_t bytes)
+void TCPServer::handleCommand(Client* client, char* line)
+{
+    char* savePtr;
+    char* arg = strtokR(line, COMMAND_DELIMITERS, &savePtr);
+    if (arg == nullptr)
+    {
+        return;
+    }
+
+    bool subscribe = strcmp(arg, "subscribe") == 0;
+    if (!subscribe && strcmp(arg, "unsubscribe") != 0)
+    {
+        std::cerr << "TCPServer: unknown client command " << arg << std::endl;
+        return;
+    }
+
+    uint32_t channels = 0;
+    while ((arg = strtokR(nullptr, COMMAND_DELIMITERS, &savePtr)) != nullptr)
+    {
+        char* end;
+        long channel = strtol(arg, &end, 10);
+        if (strcmp(arg, "all") == 0)
+        {
+            channels = ALL_CHANNELS;
+        }
+        else if (*end == '\0' && end != arg && channel >= 0 && channel < NUM_CHANNELS)
+        {
+            channels |= 1u << channel;
+        }
+    }
+
+    client->subscriptions = subscribe ? channels : client->subscriptions & ~channels;
+}
+
+void TCPServer::dispatch(const Message& message)
+{
+    for (auto& c : clients)
+    {
+        Client* client = c.get();
+        if (client->fileDescriptor < 0 || !((client->subscriptions >> message.channel) & 1))
+        {
+            continue;
+        }
+
+        if (client->queueCount == CLIENT_QUEUE_SIZE)
+        {
+            client->queueHead = (client->queueHead + 1) % CLIENT_QUEUE_SIZE;
+            client->queueCount--;
+            client->dropped++;
+        }
+        Message& slot =
+            client->queued[(client->queueHead + client->queueCount) % CLIENT_QUEUE_SIZE];
+        slot.channel = message.channel;
+        slot.length = message.length;
+        memcpy(slot.data, message.data, message.length);
+        client->queueCount++;
+
+        if (!client->waitingForWritable)
+        {
+            flush(client);
+        }
+    }
+}
+
+void TCPServer::flush(Client* client)
 {
-    uint32_t bytesWritten = 0;
-    while (bytesWritten < bytes)
+    while (true)
     {
-        int32_t n = write(fileDescriptor, message + bytesWritten, bytes - bytesWritten);
+        if (!client->hasInFlight)
+        {
+            if (client->queueCount == 0)
+            {
+                break;
+            }
+            const Message& next = client->queued[client->queueHead];
+            client->inFlight.length = next.length;
+            memcpy(client->inFlight.data, next.data, next.length);
+            client->queueHead = (client->queueHead + 1) % CLIENT_QUEUE_SIZE;
+            client->queueCount--;
+            client->inFlightOffset = 0;
+            client->hasInFlight = true;
+        }
+
+        ssize_t n = send(
+            client->fileDescriptor,
+            client->inFlight.data + client->inFlightOffset,
+            client->inFlight.length - client->inFlightOffset,
+            MSG_DONTWAIT | MSG_NOSIGNAL);
         if (n < 0)
         {
-            if (errno == EAGAIN or errno == EINTR)
+            if (errno == EINTR)
             {
                 continue;
             }
+            if (errno == EAGAIN)
+            {
+                setWaitingForWritable(client, true);
+            }
             else
             {
-                perror("TCPServer failed to write");
-                throw std::runtime_error("WriteError");
+                closeClient(client);
             }
+            return;
+        }
+
+        client->inFlightOffset += n;
+        if (client->inFlightOffset == client->inFlight.length)
+        {
+            client->hasInFlight = false;
         }
-        bytesWritten += n;
     }
+
+    setWaitingForWritable(client, false);
 }
 
-/**
- * Read the next 4 bytes as a big endian int32_t
- */
-int32_t readInt32(int16_t fileDescriptor)
+void TCPServer::setWaitingForWritable(Client* client, bool waiting)
 {
-    char buffer[5];
-    readMessage(fileDescriptor, buffer, 4);
-    int32_t answer = 0;
-    for (size_t i = 0; i < 4; i++)
+    if (client->waitingForWritable == waiting)
     {
-        answer = answer | buffer[i];
-        answer <<= 8;
+        return;
     }
-    return answer;
+    client->waitingForWritable = waiting;
+
+    epoll_event event = {};
+    event.events = waiting ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.ptr = client;
+    epoll_ctl(epollFileDescriptor, EPOLL_CTL_MOD, client->fileDescriptor, &event);
 }
 #endif  // __linux__
 
-// Only construct static singleton in actual sim, not in unit tests.
-#ifndef ENV_UNIT_TESTS
-// Definition of static variable. mainServer never created otherwise.
-TCPServer TCPServer::mainServer(2001);
-#endif
-
 }  // namespace communication
 
 }  // namespace tap
@@ -22,115 +22,130 @@
 #ifndef TCPSERVER_HPP_
 #define TCPSERVER_HPP_
 
-#ifdef __linux__
-#include <netinet/in.h>
-#endif
-
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "tap/util_macros.hpp"
+
+#include "telemetry_queue.hpp"
 
 namespace tap
 {
 namespace communication
 {
 /**
- * TCPServer is an singleton class for running a TCPServer using a user
- * defined messaging protocol.
+ * Streams telemetry published by the control loop to any number of TCP clients (plot tools,
+ * loggers) from a dedicated thread, so that clients never change the control loop's timing.
+ *
+ * `publish` only copies the message into a lock-free queue. The server thread waits on epoll
+ * for new connections, client commands and sockets becoming writable, and moves queued
+ * messages to the clients subscribed to their channel. Each client has its own bounded queue,
+ * when a client doesn't keep up its oldest queued messages are dropped, never whole messages
+ * partially sent, and other clients are unaffected.
+ *
+ * Clients receive every channel until they send a command line:
+ *  - "subscribe <channel> [<channel> ...]": receive only the given channels.
+ *  - "subscribe all": receive every channel.
+ *  - "unsubscribe <channel> [<channel> ...]": stop receiving the given channels.
+ *
+ * Nothing is bound until `start` is called.
  */
 class TCPServer
 {
-// Make constructor and destructor public if in unit tests environment.
-#ifdef ENV_UNIT_TESTS
 public:
-#endif
-    /**
-     * Post: Creates a new TCPServer and binds to the first avaiable port
-     * in the range [portnumber, portnumber+1000]. If it cannot succesfully
-     * bind to any of these ports, throws a std::runtime_error.
-     */
-    TCPServer(int portnumber);
-
-    /**
-     * Destructor. Only special thing is that it closes any open file descriptors.
-     */
+    static constexpr uint16_t DEFAULT_PORT = 2001;
+    static constexpr int MAX_CLIENTS = 16;
+    static constexpr int LISTEN_QUEUE_SIZE = 5;  // 5 is max on most systems
+    /// Channels are numbered [0, `NUM_CHANNELS`).
+    static constexpr uint8_t NUM_CHANNELS = 32;
+    static constexpr uint16_t MAX_MESSAGE_SIZE = 512;
+    /// Slots of the queue between the control loop and the server thread.
+    static constexpr uint16_t QUEUE_SIZE = 64;
+    /// Messages queued per client before the oldest are dropped.
+    static constexpr uint16_t CLIENT_QUEUE_SIZE = 64;
+    /// Longest command line a client may send.
+    static constexpr size_t MAX_COMMAND_LENGTH = 128;
+    /// Upper bound of how long queued messages wait for the server thread, in milliseconds.
+    static constexpr int POLL_PERIOD = 1;
+
+    using Queue = TelemetryQueue<QUEUE_SIZE, MAX_MESSAGE_SIZE>;
+    using Message = Queue::Message;
+
+    TCPServer();
+    DISALLOW_COPY_AND_ASSIGN(TCPServer)
+    /// Stops the server thread and closes all connections.
     ~TCPServer();
 
-public:
-    /* PortNumber which the server will try to open on. This seems finicky
-     * as it's possible that port is in use, but I don't know how to do
-     * better (Tenzin)*/
-    static const int16_t PORT_NUMBER = 8888;
-    static const uint8_t LISTEN_QUEUE_SIZE = 5;  // 5 is max on most systems
-
     /**
-     * Return a const reference to the singleton static instance of this class.
+     * @return The server the simulator publishes to, or `nullptr` in unit tests. It isn't
+     *      started until the simulator calls `start`.
      */
     static TCPServer* MainServer();
 
     /**
-     * Accepts a new connection and stores the file descriptor in mainClientDescriptor
+     * Binds `port` (any free port if 0) and starts the server thread.
+     *
+     * @return `false` if the server is already running or the port couldn't be bound.
      */
-    void getConnection();
+    bool start(uint16_t port);
 
-    /**
-     * Closes mainClientFile descriptor and then sets its value to -1.
-     */
-    void closeConnection();
+    /// Stops the server thread and closes all connections.
+    void stop();
 
-    /**
-     * Post: Returns the port number of this server.
-     */
-    uint16_t getPortNumber();
+    bool isRunning() const { return running.load(std::memory_order_relaxed); }
+
+    /// @return The port the server is bound to, or 0 if it isn't running.
+    uint16_t getPortNumber() const { return portNumber; }
 
     /**
-     * Writes the null-terminated message "message" to the connected TCP client
-     * if there is one.
+     * Queues a message for the clients subscribed to `channel`. Never blocks, call from the
+     * control loop only (the queue has a single producer).
+     *
+     * @return `false` if the message was dropped because the queue was full or it is longer
+     *      than `MAX_MESSAGE_SIZE`. Messages aren't queued, and `true` is returned, while the
+     *      server isn't running or no client is connected.
      */
-    void writeToClient(const char* message, int32_t messageLength);
+    bool publish(uint8_t channel, const uint8_t* data, uint16_t length);
+
+    int getClientCount() const { return clientCount.load(std::memory_order_relaxed); }
+
+    /// @return The number of messages `publish` dropped.
+    uint32_t getDroppedCount() const { return queue.getDroppedCount(); }
 
 private:
-#ifdef __linux__
-    bool socketOpened;
-    bool clientConnected;
-    int16_t listenFileDescriptor;  // File descriptor which server gets connection requests
-    int16_t mainClientDescriptor;  // File Descriptor which we communciate with
-    sockaddr_in serverAddress;
-    int16_t portNumber;  // portNumber the server is bound to
-#endif                   // __linux__
-
-    // Singleton server.
-    static TCPServer mainServer;
-};  // TCPServer
+    struct Client;
 
-#ifdef __linux__
-/**
- * Pre: Message readBuffer must be messageLength + 1 bytes long otherwise out of bounds
- * array access will occur and behavior will be undefined.
- * Post: Reads a message to the given "readBuffer" ensuring that messageLength bytes are
- * read.
- *
- * Throws: runtime_error if read() fails.
- */
-void readMessage(int16_t fileDescriptor, char* readBuffer, uint16_t messageLength);
+    std::atomic<bool> running{false};
+    std::atomic<int> clientCount{0};
+    uint16_t portNumber = 0;
 
-/**
- * Pre: fileDescriptor should be open.
- * Write to connected ClientFileDescriptor, ensures that all bytes are sent.
- * Throws std::runtime_error if write() fails, check errno to see exact code why.
- */
-void writeMessage(int16_t fileDescriptor, const char* message, uint16_t bytes);
+    int listenFileDescriptor = -1;
+    int epollFileDescriptor = -1;
+    std::thread serverThread;
 
-/**
- * Read the next four bytes from the TCP stream as an int32_t. It is expected
- * that the lowest register bytes are most significant (big endian)
- */
-int32_t readInt32(int16_t fileDescriptor);
-#endif  // __linux__
+    Queue queue;
+
+    /// Only touched by the server thread.
+    std::vector<std::unique_ptr<Client>> clients;
+
+    void run();
+    void acceptClients();
+    void closeClient(Client* client);
+    void readCommands(Client* client);
+    void handleCommand(Client* client, char* line);
+    void dispatch(const Message& message);
+    void flush(Client* client);
+    void setWaitingForWritable(Client* client, bool waiting);
+};  // TCPServer
 
 }  // namespace communication
 
 }  // namespace tap
 
-#endif  // TCP_SERVER_HPP_
+#endif  // TCPSERVER_HPP_
 
 #endif  // PLATFORM_HOSTED
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TELEMETRY_QUEUE_HPP_
+#define TELEMETRY_QUEUE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace tap::communication
+{
+/**
+ * A telemetry message and the channel it was published on.
+ */
+template <uint16_t MAX_SIZE>
+struct TelemetryMessage
+{
+    uint8_t channel = 0;
+    uint16_t length = 0;
+    uint8_t data[MAX_SIZE];
+};
+
+/**
+ * A lock-free single producer, single consumer ring of telemetry messages. The producer (the
+ * control loop) only calls `push` and the consumer (the `TCPServer` thread) only calls `pop`,
+ * so the control loop never waits on the server.
+ *
+ * @tparam SIZE The number of slots, a power of two. One slot is kept free to tell a full ring
+ *      from an empty one, so at most `SIZE - 1` messages are held.
+ * @tparam MAX_MESSAGE_SIZE The largest message that can be pushed, in bytes.
+ */
+template <uint16_t SIZE, uint16_t MAX_MESSAGE_SIZE>
+class TelemetryQueue
+{
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+public:
+    using Message = TelemetryMessage<MAX_MESSAGE_SIZE>;
+
+    /**
+     * Copies a message in. Producer only.
+     *
+     * @return `false` and counts the message as dropped if the ring is full or the message is
+     *      longer than `MAX_MESSAGE_SIZE`.
+     */
+    bool push(uint8_t channel, const uint8_t* data, uint16_t length)
+    {
+        uint16_t h = head.load(std::memory_order_relaxed);
+        uint16_t next = (h + 1) & MASK;
+        if (length > MAX_MESSAGE_SIZE || next == tail.load(std::memory_order_acquire))
+        {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        messages[h].channel = channel;
+        messages[h].length = length;
+        memcpy(messages[h].data, data, length);
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest message. Consumer only.
+     *
+     * @return `false` if the ring is empty, in which case `message` is left unchanged.
+     */
+    bool pop(Message* message)
+    {
+        uint16_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        message->channel = messages[t].channel;
+        message->length = messages[t].length;
+        memcpy(message->data, messages[t].data, messages[t].length);
+        tail.store((t + 1) & MASK, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+    }
+
+    /// @return The number of messages `push` dropped.
+    uint32_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint16_t MASK = SIZE - 1;
+
+    Message messages[SIZE];
+
+    /// Next slot `push` writes, only written by the producer.
+    std::atomic<uint16_t> head{0};
+
+    /// Next slot `pop` reads, only written by the consumer.
+    std::atomic<uint16_t> tail{0};
+
+    std::atomic<uint32_t> dropped{0};
+};  // class TelemetryQueue
+
+}  // namespace tap::communication
+
+#endif  // TELEMETRY_QUEUE_HPP_
@@ -20,9 +20,12 @@
 #ifndef COMMAND_HPP_
 #define COMMAND_HPP_
 
+#include <cstdint>
+
 #include "tap/util_macros.hpp"
 
 #include "command_scheduler_types.hpp"
+#include "command_trigger.hpp"
 
 namespace tap
 {
@@ -65,6 +68,40 @@ public:
     // This shouldn't be mockable
     inline int getGlobalIdentifier() const { return globalIdentifier; }
 
+    /**
+     * Sets the period at which the CommandScheduler should call `execute()` and `isFinished()`
+     * while this Command is scheduled. Commands that do not need to run every time the
+     * scheduler runs (UI, housekeeping) should use a longer period.
+     *
+     * @param[in] period The desired period, in microseconds, rounded to the nearest multiple
+     *      of the scheduler's run period. A period of 0 (the default) or one shorter than the
+     *      run period means the Command is executed every time the scheduler runs, as the
+     *      scheduler cannot run anything faster than that.
+     * @see CommandScheduler::setRunPeriod
+     */
+    inline void setSchedulingPeriod(uint32_t period) { schedulingPeriod = period; }
+
+    inline uint32_t getSchedulingPeriod() const { return schedulingPeriod; }
+
+    /**
+     * Sets the priority class of this Command. `BEST_EFFORT` Commands are executed after all
+     * other work and skipped for a run if the CommandScheduler's run budget is used up.
+     *
+     * @see CommandScheduler::setRunBudget
+     */
+    inline void setSchedulingPriority(SchedulingPriority priority)
+    {
+        schedulingPriority = priority;
+    }
+
+    inline SchedulingPriority getSchedulingPriority() const { return schedulingPriority; }
+
+    /**
+     * @return The trigger of this Command. Add sources to it to only execute this Command when
+     *      new feedback has arrived, see `CommandTrigger`.
+     */
+    inline CommandTrigger& getTrigger() { return trigger; }
+
     /**
      * Adds the required subsystem to a list of required subsystems.
      *
@@ -131,7 +168,16 @@ private:
      */
     const int globalIdentifier;
 
-    command_scheduler_bitmap_t commandRequirementsBitwise = 0;
+    subsystem_scheduler_bitmap_t commandRequirementsBitwise;
+
+    /**
+     * The period at which this command would like to be executed, in microseconds.
+     */
+    uint32_t schedulingPeriod = 0;
+
+    SchedulingPriority schedulingPriority = SchedulingPriority::CONTROL;
+
+    CommandTrigger trigger;
 };  // class Command
 
 }  // namespace control
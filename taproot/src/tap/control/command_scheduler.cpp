@@ -26,6 +26,7 @@
 #include "modm/architecture/interface/assert.hpp"
 
 #include "command.hpp"
+#include "scheduler_trace.hpp"
 #include "subsystem.hpp"
 
 using namespace tap::errors;
@@ -39,6 +40,28 @@ Subsystem *CommandScheduler::globalSubsystemRegistrar[CommandScheduler::MAX_SUBS
 Command *CommandScheduler::globalCommandRegistrar[CommandScheduler::MAX_COMMAND_COUNT];
 int CommandScheduler::maxSubsystemIndex = 0;
 int CommandScheduler::maxCommandIndex = 0;
+CommandScheduler::ExecutionTimeStats
+    CommandScheduler::commandExecutionTimes[CommandScheduler::MAX_COMMAND_COUNT];
+CommandScheduler::ExecutionTimeStats
+    CommandScheduler::subsystemRefreshTimes[CommandScheduler::MAX_SUBSYSTEM_COUNT];
+CommandScheduler::ExecutionTimeStats CommandScheduler::runTimes;
+#ifdef RUN_WITH_PROFILING
+int CommandScheduler::commandProfilerProbes[CommandScheduler::MAX_COMMAND_COUNT];
+int CommandScheduler::subsystemProfilerProbes[CommandScheduler::MAX_SUBSYSTEM_COUNT];
+
+/**
+ * @return The profiler probe called `name`, registering it and caching it in `*cachedProbe`
+ *      on first use.
+ */
+static int getProfilerProbe(int *cachedProbe, const char *name)
+{
+    if (*cachedProbe == 0)
+    {
+        *cachedProbe = arch::Profiler::registerProbe(name) + 1;
+    }
+    return *cachedProbe - 1;
+}
+#endif
 SafeDisconnectFunction CommandScheduler::defaultSafeDisconnectFunction;
 
 int CommandScheduler::constructCommand(Command *command)
@@ -58,6 +81,10 @@ int CommandScheduler::constructCommand(Command *command)
             // Update max index if need be
             maxCommandIndex = std::max(maxCommandIndex, i + 1);
             globalCommandRegistrar[i] = command;
+            commandExecutionTimes[i] = {};
+#ifdef RUN_WITH_PROFILING
+            commandProfilerProbes[i] = 0;
+#endif
             return i;
         }
     }
@@ -86,6 +113,10 @@ int CommandScheduler::constructSubsystem(Subsystem *subsystem)
             // Update max index if need be
             maxSubsystemIndex = std::max(maxSubsystemIndex, i + 1);
             globalSubsystemRegistrar[i] = subsystem;
+            subsystemRefreshTimes[i] = {};
+#ifdef RUN_WITH_PROFILING
+            subsystemProfilerProbes[i] = 0;
+#endif
             return i;
         }
     }
@@ -163,9 +194,11 @@ CommandScheduler::~CommandScheduler()
 
 void CommandScheduler::run()
 {
-#ifndef PLATFORM_HOSTED
     uint32_t runStart = arch::clock::getTimeMicroseconds();
-#endif
+    slowestInRunStats = nullptr;
+    slowestInRunName = nullptr;
+    slowestInRunTime = 0;
+    runCount++;
 
     if (runningHardwareTests)
     {
@@ -183,6 +216,19 @@ void CommandScheduler::run()
         return;
     }
 
+#ifdef RUN_WITH_SCHEDULER_TRACE
+    if (safeDisconnected() != wasSafeDisconnected)
+    {
+        wasSafeDisconnected = !wasSafeDisconnected;
+        SCHEDULER_TRACE(
+            wasSafeDisconnected ? SchedulerTraceEvent::SAFE_DISCONNECT
+                                : SchedulerTraceEvent::SAFE_RECONNECT,
+            0,
+            runStart,
+            0);
+    }
+#endif
+
     if (safeDisconnected())
     {
         // End all commands running. They were interrupted by the remote disconnecting.
@@ -194,31 +240,25 @@ void CommandScheduler::run()
     else
     {
         // Execute commands in the addedCommandBitmap, remove any that are finished
-        for (auto it = cmdMapBegin(); it != cmdMapEnd(); it++)
-        {
-            (*it)->execute();
-            if ((*it)->isFinished())
-            {
-                removeCommand(*it, false);
-            }
-        }
+        executeCommands(SchedulingPriority::SAFETY_CRITICAL, runStart);
+        executeCommands(SchedulingPriority::CONTROL, runStart);
     }
 
     // Only refresh subsystems if this is the master scheduler
     if (isMasterScheduler)
     {
         // Refresh subsystems in the registeredSubsystemBitmap
+        refreshSubsystems(SchedulingPriority::SAFETY_CRITICAL, runStart);
+        refreshSubsystems(SchedulingPriority::CONTROL, runStart);
+
         for (auto it = subMapBegin(); it != subMapEnd(); it++)
         {
-            (*it)->refresh();
-
             Command *defaultCmd;
             // If the remote is connected given the scheduler is in safe disconnect mode and
             // the current subsystem does not have an associated command and the current
             // subsystem has a default command, add it
             if (!safeDisconnected() &&
-                !(subsystemsAssociatedWithCommandBitmap &
-                  (LSB_ONE_HOT_SUBSYSTEM_BITMAP << (*it)->getGlobalIdentifier())) &&
+                !subsystemsAssociatedWithCommandBitmap.test((*it)->getGlobalIdentifier()) &&
                 ((defaultCmd = (*it)->getDefaultCommand()) != nullptr))
             {
                 addCommand(defaultCmd);
@@ -226,18 +266,176 @@ void CommandScheduler::run()
         }
     }
 
-#ifndef PLATFORM_HOSTED
+    // Best effort work goes last so that it only uses what is left of the run budget
+    if (!safeDisconnected())
+    {
+        executeCommands(SchedulingPriority::BEST_EFFORT, runStart);
+    }
+    if (isMasterScheduler)
+    {
+        refreshSubsystems(SchedulingPriority::BEST_EFFORT, runStart);
+        runTimes.addSample(arch::clock::getTimeMicroseconds() - runStart);
+    }
+
     // make sure we are not going over tolerable runtime, otherwise something is really
     // wrong with the code
-    if (arch::clock::getTimeMicroseconds() - runStart > MAX_ALLOWABLE_SCHEDULER_RUNTIME)
+    if (isMasterScheduler &&
+        arch::clock::getTimeMicroseconds() - runStart > MAX_ALLOWABLE_SCHEDULER_RUNTIME)
     {
+        runTimes.overruns++;
+        if (slowestInRunStats != nullptr)
+        {
+            slowestInRunStats->overruns++;
+        }
+
+#ifndef PLATFORM_HOSTED
         // shouldn't take more than MAX_ALLOWABLE_SCHEDULER_RUNTIME microseconds
         // to complete all this stuff, if it does something
         // is seriously wrong (i.e. you are adding subsystems unchecked or the scheduler
-        // itself is broken).
-        RAISE_ERROR(drivers, "scheduler took longer than MAX_ALLOWABLE_SCHEDULER_RUNTIME");
+        // itself is broken). The error is named after the slowest Command or Subsystem in
+        // this run, see `ExecutionTimeStats::overruns` for the full history.
+        if (slowestInRunName != nullptr)
+        {
+            RAISE_ERROR(drivers, slowestInRunName);
+        }
+        else
+        {
+            RAISE_ERROR(drivers, "scheduler took longer than MAX_ALLOWABLE_SCHEDULER_RUNTIME");
+        }
+#endif
     }
+}
+
+void CommandScheduler::executeCommands(SchedulingPriority priority, uint32_t runStart)
+{
+    for (auto it = cmdMapBegin(); it != cmdMapEnd(); it++)
+    {
+        Command *cmd = *it;
+        int cmdId = cmd->getGlobalIdentifier();
+        bool due =
+            deferredCommandBitmap.test(cmdId) || isDueThisRun(cmd->getSchedulingPeriod(), cmdId);
+        if (cmd->getSchedulingPriority() != priority || !due)
+        {
+            continue;
+        }
+
+        if (priority == SchedulingPriority::BEST_EFFORT && isOverBudget(runStart))
+        {
+            // Try again next run, regardless of the command's scheduling period
+            deferredCommandBitmap.set(cmdId);
+            commandExecutionTimes[cmdId].deferrals++;
+            continue;
+        }
+        deferredCommandBitmap.reset(cmdId);
+
+        // Event driven commands only run once new feedback arrives or their timeout expires
+        CommandTrigger &trigger = cmd->getTrigger();
+        if (trigger.isEnabled() && !trigger.poll(runStart))
+        {
+            continue;
+        }
+
+        uint32_t executeStart = arch::clock::getTimeMicroseconds();
+        SCHEDULER_TRACE(SchedulerTraceEvent::EXECUTE_START, cmdId, executeStart, 0);
+#ifdef RUN_WITH_PROFILING
+        drivers->profiler.push(getProfilerProbe(&commandProfilerProbes[cmdId], cmd->getName()));
 #endif
+        cmd->execute();
+#ifdef RUN_WITH_PROFILING
+        drivers->profiler.pop();
+#endif
+        bool finished = cmd->isFinished();
+        SCHEDULER_TRACE(
+            SchedulerTraceEvent::EXECUTE_END,
+            cmdId,
+            arch::clock::getTimeMicroseconds(),
+            finished);
+        recordExecutionTime(&commandExecutionTimes[cmdId], cmd->getName(), executeStart);
+
+        if (finished)
+        {
+            removeCommand(cmd, false);
+        }
+    }
+}
+
+void CommandScheduler::refreshSubsystems(SchedulingPriority priority, uint32_t runStart)
+{
+    for (auto it = subMapBegin(); it != subMapEnd(); it++)
+    {
+        Subsystem *sub = *it;
+        int subId = sub->getGlobalIdentifier();
+        bool due =
+            deferredSubsystemBitmap.test(subId) || isDueThisRun(sub->getSchedulingPeriod(), subId);
+        if (sub->getSchedulingPriority() != priority || !due)
+        {
+            continue;
+        }
+
+        if (priority == SchedulingPriority::BEST_EFFORT && isOverBudget(runStart))
+        {
+            deferredSubsystemBitmap.set(subId);
+            subsystemRefreshTimes[subId].deferrals++;
+            continue;
+        }
+        deferredSubsystemBitmap.reset(subId);
+
+        uint32_t refreshStart = arch::clock::getTimeMicroseconds();
+        SCHEDULER_TRACE(SchedulerTraceEvent::REFRESH_START, subId, refreshStart, 0);
+#ifdef RUN_WITH_PROFILING
+        drivers->profiler.push(getProfilerProbe(&subsystemProfilerProbes[subId], sub->getName()));
+#endif
+        sub->refresh();
+#ifdef RUN_WITH_PROFILING
+        drivers->profiler.pop();
+#endif
+        SCHEDULER_TRACE(
+            SchedulerTraceEvent::REFRESH_END,
+            subId,
+            arch::clock::getTimeMicroseconds(),
+            0);
+        recordExecutionTime(&subsystemRefreshTimes[subId], sub->getName(), refreshStart);
+    }
+}
+
+bool CommandScheduler::isOverBudget(uint32_t runStart) const
+{
+    return isMasterScheduler && runBudget != 0 &&
+           arch::clock::getTimeMicroseconds() - runStart >= runBudget;
+}
+
+void CommandScheduler::recordExecutionTime(
+    ExecutionTimeStats *stats,
+    const char *name,
+    uint32_t startTime)
+{
+    if (!isMasterScheduler)
+    {
+        return;
+    }
+
+    uint32_t time = arch::clock::getTimeMicroseconds() - startTime;
+    stats->addSample(time);
+
+    if (slowestInRunStats == nullptr || time > slowestInRunTime)
+    {
+        slowestInRunStats = stats;
+        slowestInRunName = name;
+        slowestInRunTime = time;
+    }
+}
+
+void CommandScheduler::resetExecutionTimes()
+{
+    for (ExecutionTimeStats &stats : commandExecutionTimes)
+    {
+        stats = {};
+    }
+    for (ExecutionTimeStats &stats : subsystemRefreshTimes)
+    {
+        stats = {};
+    }
+    runTimes = {};
 }
 
 void CommandScheduler::addCommand(Command *commandToAdd)
@@ -266,7 +464,7 @@ void CommandScheduler::addCommand(Command *commandToAdd)
 
     // Check to see if all the requirements are in the subsytemToCommandMap
     if ((requirementsBitwise & registeredSubsystemBitmap) != requirementsBitwise ||
-        requirementsBitwise == static_cast<subsystem_scheduler_bitmap_t>(0))
+        requirementsBitwise.none())
     {
         // the command you are trying to add has a subsystem that is not in the
         // scheduler, so you cannot add it (will lead to undefined control behavior)
@@ -275,27 +473,40 @@ void CommandScheduler::addCommand(Command *commandToAdd)
     }
 
     // End all commands running that used the subsystem requirements. They were interrupted.
-    for (auto it = cmdMapBegin(); it != cmdMapEnd(); it++)
-    {
-        // Does this command's requierments intersect the new command?
-        if (((*it)->getRequirementsBitwise() & requirementsBitwise) !=
-            static_cast<subsystem_scheduler_bitmap_t>(0))
+    // Each subsystem associated with a command is owned by exactly one command, so the
+    // conflicting commands are found by scanning the intersecting subsystem bits rather than by
+    // walking every added command.
+    subsystem_scheduler_bitmap_t conflicts =
+        requirementsBitwise & subsystemsAssociatedWithCommandBitmap;
+    for (int subId = conflicts.findFirst(); subId != -1; subId = conflicts.findNext(subId + 1))
+    {
+        // Removing a command frees all of its subsystems, which may include later conflicts
+        if (subsystemsAssociatedWithCommandBitmap.test(subId))
         {
-            removeCommand(*it, true);
+            removeCommand(subsystemToCommandMap[subId], true);
         }
     }
 
     // Add the subsystem requirements to the subsystems associated with command bitmap
     subsystemsAssociatedWithCommandBitmap |= requirementsBitwise;
+    for (int subId = requirementsBitwise.findFirst(); subId != -1;
+         subId = requirementsBitwise.findNext(subId + 1))
+    {
+        subsystemToCommandMap[subId] = commandToAdd;
+    }
     commandToAdd->initialize();
     // Add the command to the command bitmap
-    addedCommandBitmap |= LSB_ONE_HOT_COMMAND_BITMAP << commandToAdd->getGlobalIdentifier();
+    addedCommandBitmap.set(commandToAdd->getGlobalIdentifier());
+    SCHEDULER_TRACE(
+        SchedulerTraceEvent::ADD_COMMAND,
+        commandToAdd->getGlobalIdentifier(),
+        arch::clock::getTimeMicroseconds(),
+        0);
 }
 
 bool CommandScheduler::isCommandScheduled(const Command *command) const
 {
-    return command != nullptr &&
-           (addedCommandBitmap & (LSB_ONE_HOT_COMMAND_BITMAP << command->getGlobalIdentifier()));
+    return command != nullptr && addedCommandBitmap.test(command->getGlobalIdentifier());
 }
 
 void CommandScheduler::removeCommand(Command *command, bool interrupted)
@@ -311,14 +522,32 @@ void CommandScheduler::removeCommand(Command *command, bool interrupted)
     }
 
     command->end(interrupted);
+    SCHEDULER_TRACE(
+        SchedulerTraceEvent::REMOVE_COMMAND,
+        command->getGlobalIdentifier(),
+        arch::clock::getTimeMicroseconds(),
+        interrupted);
 
     // Remove all subsystem requirements from the subsystem associated with command bitmap
     subsystemsAssociatedWithCommandBitmap &= ~command->getRequirementsBitwise();
 
     // Remove the command from the command bitmap
-    addedCommandBitmap &= ~(LSB_ONE_HOT_COMMAND_BITMAP << command->getGlobalIdentifier());
+    addedCommandBitmap.reset(command->getGlobalIdentifier());
+    deferredCommandBitmap.reset(command->getGlobalIdentifier());
 }
 
+void CommandScheduler::setRunPeriod(uint32_t period)
+{
+    if (period == 0)
+    {
+        RAISE_ERROR(drivers, "scheduler run period must be nonzero");
+        return;
+    }
+    runPeriod = period;
+}
+
+void CommandScheduler::setRunBudget(uint32_t budget) { runBudget = budget; }
+
 void CommandScheduler::setSafeDisconnectFunction(SafeDisconnectFunction *func)
 {
     this->safeDisconnectFunction = func;
@@ -339,16 +568,14 @@ void CommandScheduler::registerSubsystem(Subsystem *subsystem)
     else
     {
         // Add the subsystem to the registered subsystem bitmap
-        registeredSubsystemBitmap |=
-            (LSB_ONE_HOT_SUBSYSTEM_BITMAP << subsystem->getGlobalIdentifier());
+        registeredSubsystemBitmap.set(subsystem->getGlobalIdentifier());
     }
 }
 
 bool CommandScheduler::isSubsystemRegistered(const Subsystem *subsystem) const
 {
     return subsystem != nullptr &&
-           ((LSB_ONE_HOT_SUBSYSTEM_BITMAP << subsystem->getGlobalIdentifier()) &
-            registeredSubsystemBitmap);
+           registeredSubsystemBitmap.test(subsystem->getGlobalIdentifier());
 }
 
 void CommandScheduler::startHardwareTests()
@@ -361,9 +588,9 @@ void CommandScheduler::startHardwareTests()
     }
 
     // Clear command bitmap (now all commands are removed)
-    addedCommandBitmap = 0;
+    addedCommandBitmap.reset();
     // No more subsystems associated with commands, so clear this bitmap as well
-    subsystemsAssociatedWithCommandBitmap = 0;
+    subsystemsAssociatedWithCommandBitmap.reset();
 
     // Start hardware tests
     for (auto it = subMapBegin(); it != subMapEnd(); it++)
@@ -382,31 +609,9 @@ void CommandScheduler::stopHardwareTests()
     runningHardwareTests = false;
 }
 
-int CommandScheduler::subsystemListSize() const
-{
-    int size = 0;
-    for (int i = 0; i < maxSubsystemIndex; i++)
-    {
-        if (registeredSubsystemBitmap & (LSB_ONE_HOT_SUBSYSTEM_BITMAP << i))
-        {
-            size++;
-        }
-    }
-    return size;
-}
+int CommandScheduler::subsystemListSize() const { return registeredSubsystemBitmap.count(); }
 
-int CommandScheduler::commandListSize() const
-{
-    int size = 0;
-    for (int i = 0; i < maxCommandIndex; i++)
-    {
-        if (addedCommandBitmap & (LSB_ONE_HOT_COMMAND_BITMAP << i))
-        {
-            size++;
-        }
-    }
-    return size;
-}
+int CommandScheduler::commandListSize() const { return addedCommandBitmap.count(); }
 
 CommandScheduler::CommandIterator CommandScheduler::cmdMapBegin()
 {
@@ -442,7 +647,7 @@ CommandScheduler::CommandIterator::CommandIterator(CommandScheduler *scheduler,
         // If the curr index is pointing somewhere in the valid range of commands but the command
         // associated with the index is not in the current added commands bitmap, increment the
         // iterator to find the next valid index
-        if (!(scheduler->addedCommandBitmap & (LSB_ONE_HOT_COMMAND_BITMAP << currIndex)))
+        if (!scheduler->addedCommandBitmap.test(currIndex))
         {
             (*this)++;
         }
@@ -461,19 +666,12 @@ CommandScheduler::CommandIterator &CommandScheduler::CommandIterator::operator++
         return *this;
     }
 
-    currIndex++;
-    while (currIndex < maxCommandIndex)
+    // The bitmap is re-read on every increment since commands may be removed while iterating
+    currIndex = scheduler->addedCommandBitmap.findNext(currIndex + 1);
+    if (currIndex >= maxCommandIndex)
     {
-        // Is the current index in the bitmap of added commands?
-        if (scheduler->addedCommandBitmap & (LSB_ONE_HOT_COMMAND_BITMAP << currIndex))
-        {
-            // We found the correct index
-            return *this;
-        }
-        currIndex++;
+        currIndex = INVALID_ITER_INDEX;
     }
-    // We didn't find the correct index, set currindex to invalid index
-    currIndex = INVALID_ITER_INDEX;
     return *this;
 }
 
@@ -512,7 +710,7 @@ CommandScheduler::SubsystemIterator::SubsystemIterator(CommandScheduler *schedul
         // If the curr index is pointing somewhere in the valid range of subsystems but the
         // subsystem associated with the index is not in the current registered subsystem bitmap,
         // increment the iterator to find the next valid index
-        if (!(scheduler->registeredSubsystemBitmap & (LSB_ONE_HOT_SUBSYSTEM_BITMAP << currIndex)))
+        if (!scheduler->registeredSubsystemBitmap.test(currIndex))
         {
             (*this)++;
         }
@@ -531,19 +729,11 @@ CommandScheduler::SubsystemIterator &CommandScheduler::SubsystemIterator::operat
         return *this;
     }
 
-    currIndex++;
-    while (currIndex < maxSubsystemIndex)
+    currIndex = scheduler->registeredSubsystemBitmap.findNext(currIndex + 1);
+    if (currIndex >= maxSubsystemIndex)
     {
-        // Is the current index in the bitmap of added commands?
-        if (scheduler->registeredSubsystemBitmap & (LSB_ONE_HOT_SUBSYSTEM_BITMAP << currIndex))
-        {
-            // We found the correct index
-            return *this;
-        }
-        currIndex++;
+        currIndex = INVALID_ITER_INDEX;
     }
-    // We didn't find the correct index, set currindex to invalid index
-    currIndex = INVALID_ITER_INDEX;
     return *this;
 }
 
@@ -20,6 +20,8 @@
 #ifndef COMMAND_SCHEDULER_HPP_
 #define COMMAND_SCHEDULER_HPP_
 
+#include <algorithm>
+#include <cstdint>
 #include <iterator>
 
 #include "tap/util_macros.hpp"
@@ -101,9 +103,9 @@ public:
  * }
  * ```
  *
- * The second use case for a CommandScheduler is in the ComprisedCommand class.
- * Here, you utilize the CommandScheduler to coordinate multiple commands inside a
- * single command. The usage is exactly the same as using the main CommandScheduler.
+ * A secondary (non-master) CommandScheduler may also be used to coordinate multiple
+ * commands inside a single command, but ComprisedCommands should use the lighter
+ * SubCommandExecutor instead.
  */
 class CommandScheduler
 {
@@ -120,9 +122,7 @@ public:
      * Calls the `refresh()` function for all Subsystems and the associated
      * `execute()` function for all Commands. A Subsystem is guarenteed to
      * be refreshed no more than one time each time the mainScheduler's run
-     * function is called. The same goes for a Command. This includes even if
-     * multiple CommandSchedulers are running in ComprisedCommands that have
-     * shared Subsystems.
+     * function is called. The same goes for a Command.
      *
      * If any Subsystem that is in the scheduler does not have a Command
      * controlling it but does have a default command (via the Subsystem's
@@ -132,6 +132,10 @@ public:
      * the scheduler. The Command's `end()` function is called, passing in
      * `isInterrupted = false`.
      *
+     * Commands and Subsystems are handled in order of their `SchedulingPriority`.
+     * `BEST_EFFORT` ones run last and are deferred once the run budget is used up.
+     * Commands with an enabled `CommandTrigger` are only executed when the trigger fires.
+     *
      * @note checks the run time of the scheduler. An error is added to the
      *      error handler if the time is greater than `MAX_ALLOWABLE_SCHEDULER_RUNTIME`
      *      (in microseconds).
@@ -201,6 +205,36 @@ public:
      */
     mockable bool isSubsystemRegistered(const Subsystem* subsystem) const;
 
+    /**
+     * Sets the period at which `run()` is being called. Used to convert the scheduling period
+     * of each Command and Subsystem into a number of runs. Defaults to `DEFAULT_RUN_PERIOD`.
+     *
+     * Items with a scheduling period longer than the run period are only executed/refreshed
+     * every `schedulingPeriod / runPeriod` runs, rounded to the nearest whole number of runs,
+     * so a period that is not a multiple of the run period is only approximated. Nothing runs
+     * more often than `run()` is called, items with a shorter period run every time. Items
+     * with the same period are offset from one another by their global identifier so that they
+     * do not all run in the same pass.
+     *
+     * @param[in] period The period at which `run()` is called, in microseconds.
+     */
+    mockable void setRunPeriod(uint32_t period);
+
+    mockable uint32_t getRunPeriod() const { return runPeriod; }
+
+    /**
+     * Sets the time budget of a single `run()`. `BEST_EFFORT` Commands and Subsystems are
+     * handled after everything else; any that would start once the budget has been used up
+     * are deferred to the next run and have their `ExecutionTimeStats::deferrals` incremented.
+     * `SAFETY_CRITICAL` and `CONTROL` items always run. Only the master scheduler enforces
+     * the budget.
+     *
+     * @param[in] budget The budget, in microseconds. 0 disables the budget.
+     */
+    mockable void setRunBudget(uint32_t budget);
+
+    mockable uint32_t getRunBudget() const { return runBudget; }
+
     mockable void startHardwareTests();
     mockable void stopHardwareTests();
 
@@ -277,24 +311,112 @@ public:
     mockable SubsystemIterator subMapBegin();
     mockable SubsystemIterator subMapEnd();
 
+    /**
+     * Execution time statistics of a single Command or Subsystem, in microseconds. For a
+     * Command the time spent in `execute()` and `isFinished()` is measured, for a Subsystem
+     * the time spent in `refresh()`. Only the master scheduler records statistics.
+     */
+    struct ExecutionTimeStats
+    {
+        uint32_t min = UINT32_MAX;
+        uint32_t max = 0;
+        uint32_t last = 0;
+        uint64_t total = 0;
+        uint32_t samples = 0;
+        /**
+         * The number of scheduler runs that went over `MAX_ALLOWABLE_SCHEDULER_RUNTIME`
+         * in which this Command or Subsystem was the slowest one.
+         */
+        uint32_t overruns = 0;
+
+        /**
+         * The number of times this `BEST_EFFORT` Command or Subsystem was deferred to the
+         * next run because the run budget was used up.
+         */
+        uint32_t deferrals = 0;
+
+        inline uint32_t mean() const { return samples == 0 ? 0 : total / samples; }
+
+        inline void addSample(uint32_t time)
+        {
+            min = std::min(min, time);
+            max = std::max(max, time);
+            last = time;
+            total += time;
+            samples++;
+        }
+    };
+
+    /**
+     * @return The execution time statistics of the Command with the given global identifier.
+     */
+    static const ExecutionTimeStats &getCommandExecutionTime(int commandId)
+    {
+        return commandExecutionTimes[commandId];
+    }
+
+    /**
+     * @return The refresh time statistics of the Subsystem with the given global identifier.
+     */
+    static const ExecutionTimeStats &getSubsystemRefreshTime(int subsystemId)
+    {
+        return subsystemRefreshTimes[subsystemId];
+    }
+
+    /**
+     * @return The time statistics of whole runs of the master scheduler. Compare against
+     *      `getRunBudget()` to see how much headroom is left.
+     */
+    static const ExecutionTimeStats &getRunTime() { return runTimes; }
+
+    /**
+     * Clears all Command, Subsystem and run time statistics.
+     */
+    static void resetExecutionTimes();
+
     mockable subsystem_scheduler_bitmap_t getRegisteredSubsystemBitmap() const
     {
         return registeredSubsystemBitmap;
     }
     mockable command_scheduler_bitmap_t getAddedCommandBitmap() const { return addedCommandBitmap; }
 
+    /**
+     * @return The constructed Command with the given global identifier, or `nullptr` if there
+     *      is none.
+     */
+    static Command* getCommandFromGlobalIdentifier(int commandId)
+    {
+        return commandId >= 0 && commandId < MAX_COMMAND_COUNT ? globalCommandRegistrar[commandId]
+                                                               : nullptr;
+    }
+
+    /**
+     * @return The constructed Subsystem with the given global identifier, or `nullptr` if
+     *      there is none.
+     */
+    static Subsystem* getSubsystemFromGlobalIdentifier(int subsystemId)
+    {
+        return subsystemId >= 0 && subsystemId < MAX_SUBSYSTEM_COUNT
+                   ? globalSubsystemRegistrar[subsystemId]
+                   : nullptr;
+    }
+
     static int constructCommand(Command* command);
     static int constructSubsystem(Subsystem* subsystem);
     static void destructCommand(Command* command);
     static void destructSubsystem(Subsystem* subsystem);
 
+    /// Period at which `run()` is assumed to be called unless set otherwise, in microseconds.
+    static constexpr uint32_t DEFAULT_RUN_PERIOD = 2'000;
+
+    /// Time budget of a single `run()` unless set otherwise, in microseconds.
+    static constexpr uint32_t DEFAULT_RUN_BUDGET = 80;
+
 private:
     /// Maximum time before we start erroring, in microseconds.
     static constexpr float MAX_ALLOWABLE_SCHEDULER_RUNTIME = 100;
-    static constexpr int MAX_SUBSYSTEM_COUNT = sizeof(subsystem_scheduler_bitmap_t) * 8;
-    static constexpr int MAX_COMMAND_COUNT = sizeof(command_scheduler_bitmap_t) * 8;
-    static constexpr subsystem_scheduler_bitmap_t LSB_ONE_HOT_SUBSYSTEM_BITMAP = 1;
-    static constexpr command_scheduler_bitmap_t LSB_ONE_HOT_COMMAND_BITMAP = 1;
+    static constexpr int MAX_SUBSYSTEM_COUNT = subsystem_scheduler_bitmap_t::SIZE;
+    static constexpr int MAX_COMMAND_COUNT = command_scheduler_bitmap_t::SIZE;
     static constexpr int INVALID_ITER_INDEX = -1;
 
     /**
@@ -324,6 +446,33 @@ private:
      */
     static Command* globalCommandRegistrar[MAX_COMMAND_COUNT];
 
+    /**
+     * Execution time statistics of every constructed command, indexed by the command's
+     * global identifier.
+     */
+    static ExecutionTimeStats commandExecutionTimes[MAX_COMMAND_COUNT];
+
+    /**
+     * Refresh time statistics of every constructed subsystem, indexed by the subsystem's
+     * global identifier.
+     */
+    static ExecutionTimeStats subsystemRefreshTimes[MAX_SUBSYSTEM_COUNT];
+
+    /**
+     * Time statistics of whole runs of the master scheduler.
+     */
+    static ExecutionTimeStats runTimes;
+
+#ifdef RUN_WITH_PROFILING
+    /**
+     * Profiler probe (plus one, 0 until first used) of every constructed command and subsystem,
+     * named after it. Command executions and subsystem refreshes are profiled under these so
+     * they show up in the profiler's call tree below the scheduler run.
+     */
+    static int commandProfilerProbes[MAX_COMMAND_COUNT];
+    static int subsystemProfilerProbes[MAX_SUBSYSTEM_COUNT];
+#endif
+
     /**
      * A global flag indicating whether or not a "master" scheduler has been constructed.
      */
@@ -335,6 +484,71 @@ private:
      */
     bool safeDisconnected();
 
+    /**
+     * @return `true` if an item with the given scheduling period and global identifier is due
+     *      in the current run.
+     */
+    inline bool isDueThisRun(uint32_t schedulingPeriod, int globalIdentifier) const
+    {
+        uint32_t runsPerPeriod = (schedulingPeriod + runPeriod / 2) / runPeriod;
+        if (runsPerPeriod <= 1)
+        {
+            return true;
+        }
+        // Offsetting by the identifier spreads items of the same rate across runs
+        return (runCount + globalIdentifier) % runsPerPeriod == 0;
+    }
+
+    /**
+     * The period at which `run()` is called, in microseconds.
+     */
+    uint32_t runPeriod = DEFAULT_RUN_PERIOD;
+
+    /**
+     * The number of times `run()` has been called, used to decide which rate limited items
+     * are due.
+     */
+    uint32_t runCount = 0;
+
+    /**
+     * The time budget of a single `run()`, in microseconds.
+     */
+    uint32_t runBudget = DEFAULT_RUN_BUDGET;
+
+    /**
+     * Executes all Commands of the given priority that are due this run. If `priority` is
+     * `BEST_EFFORT`, Commands are deferred once the run budget measured from `runStart` is
+     * used up.
+     */
+    void executeCommands(SchedulingPriority priority, uint32_t runStart);
+
+    /**
+     * Refreshes all Subsystems of the given priority that are due this run, see
+     * `executeCommands`.
+     */
+    void refreshSubsystems(SchedulingPriority priority, uint32_t runStart);
+
+    /**
+     * @return `true` if this is the master scheduler and the run that started at `runStart`
+     *      has used up the run budget.
+     */
+    bool isOverBudget(uint32_t runStart) const;
+
+    /**
+     * Adds a sample measured from `startTime` until now to `stats` and keeps track of the
+     * slowest Command or Subsystem in the current run. Does nothing if this is not the master
+     * scheduler.
+     */
+    void recordExecutionTime(ExecutionTimeStats *stats, const char *name, uint32_t startTime);
+
+    /**
+     * The statistics and name of the Command or Subsystem that took the longest in the
+     * current run.
+     */
+    ExecutionTimeStats *slowestInRunStats = nullptr;
+    const char *slowestInRunName = nullptr;
+    uint32_t slowestInRunTime = 0;
+
     Drivers* drivers;
 
     /**
@@ -353,23 +567,42 @@ private:
      * in the codebase. If a subsystem is registered, the associated bit in this bitmap
      * will be set to 1.
      */
-    subsystem_scheduler_bitmap_t registeredSubsystemBitmap = 0;
+    subsystem_scheduler_bitmap_t registeredSubsystemBitmap;
 
     /**
      * Each bit in the bitmap corresponds to an index into the subsystem registrar. If a
      * bit is set, it means that the subsystem in the registrar has a command associated
      * in in this scheduler.
      */
-    subsystem_scheduler_bitmap_t subsystemsAssociatedWithCommandBitmap = 0;
+    subsystem_scheduler_bitmap_t subsystemsAssociatedWithCommandBitmap;
+
+    /**
+     * Maps the index of a subsystem in the registrar to the command in this scheduler that
+     * currently requires it. An entry is only valid if the associated bit in
+     * `subsystemsAssociatedWithCommandBitmap` is set.
+     */
+    Command* subsystemToCommandMap[MAX_SUBSYSTEM_COUNT] = {};
 
     /**
      * If a command has been added and is running, the associated bit in this bitmap will
      * be set to 1.
      */
-    command_scheduler_bitmap_t addedCommandBitmap = 0;
+    command_scheduler_bitmap_t addedCommandBitmap;
+
+    /**
+     * `BEST_EFFORT` Commands and Subsystems that were deferred in a previous run. These run as
+     * soon as the budget allows, regardless of their scheduling period.
+     */
+    command_scheduler_bitmap_t deferredCommandBitmap;
+    subsystem_scheduler_bitmap_t deferredSubsystemBitmap;
 
     bool isMasterScheduler = false;
 
+#ifdef RUN_WITH_SCHEDULER_TRACE
+    /// Safe disconnect state of the previous run, used to trace transitions.
+    bool wasSafeDisconnected = false;
+#endif
+
     bool runningHardwareTests = false;
 };  // class CommandScheduler
 
@@ -22,10 +22,39 @@
 
 #include <cinttypes>
 
+#include "multiword_bitmap.hpp"
+
+/**
+ * The maximum number of Commands and Subsystems that may be constructed at once. Robots with
+ * many small mechanisms may raise these by defining them at build time. Widths above 64 use
+ * multiple words per bitmap.
+ */
+#ifndef COMMAND_SCHEDULER_MAX_COMMAND_COUNT
+#define COMMAND_SCHEDULER_MAX_COMMAND_COUNT 64
+#endif
+
+#ifndef COMMAND_SCHEDULER_MAX_SUBSYSTEM_COUNT
+#define COMMAND_SCHEDULER_MAX_SUBSYSTEM_COUNT 64
+#endif
+
 namespace tap::control
 {
-typedef uint64_t command_scheduler_bitmap_t;
-typedef uint64_t subsystem_scheduler_bitmap_t;
+typedef MultiwordBitmap<COMMAND_SCHEDULER_MAX_COMMAND_COUNT> command_scheduler_bitmap_t;
+typedef MultiwordBitmap<COMMAND_SCHEDULER_MAX_SUBSYSTEM_COUNT> subsystem_scheduler_bitmap_t;
+
+/**
+ * Priority class of a Command or Subsystem. Each run of the CommandScheduler handles items in
+ * this order. Only `BEST_EFFORT` items are ever deferred when a run goes over its time budget.
+ */
+enum class SchedulingPriority : uint8_t
+{
+    /// Never deferred and executed/refreshed before anything else.
+    SAFETY_CRITICAL = 0,
+    /// Never deferred. The default for Commands and Subsystems (motor control, etc.).
+    CONTROL,
+    /// Handled last and deferred to the next run if the budget is used up (UI, diagnostics).
+    BEST_EFFORT,
+};
 }  // namespace tap::control
 
 #endif  // COMMAND_SCHEDULER_TYPES_HPP_
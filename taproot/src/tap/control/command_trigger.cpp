@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "command_trigger.hpp"
+
+#include "tap/communication/can/can_rx_listener.hpp"
+
+#include "modm/architecture/interface/assert.hpp"
+
+namespace tap::control
+{
+void CommandTrigger::addSource(const can::CanRxListener* source)
+{
+    modm_assert(source != nullptr, "CommandTrigger::addSource", "called with nullptr source");
+    modm_assert(numSources < MAX_SOURCES, "CommandTrigger::addSource", "too many sources");
+
+    lastReceiveCounts[numSources] = source->getReceiveCount();
+    sources[numSources++] = source;
+}
+
+bool CommandTrigger::poll(uint32_t currTime)
+{
+    bool newData = false;
+    for (int i = 0; i < numSources; i++)
+    {
+        uint32_t receiveCount = sources[i]->getReceiveCount();
+        if (receiveCount != lastReceiveCounts[i])
+        {
+            lastReceiveCounts[i] = receiveCount;
+            newData = true;
+        }
+    }
+
+    if (newData)
+    {
+        lastTriggerTime = currTime;
+        return true;
+    }
+
+    if (currTime - lastTriggerTime >= timeout)
+    {
+        lastTriggerTime = currTime;
+        timeoutCount++;
+        return true;
+    }
+
+    return false;
+}
+}  // namespace tap::control
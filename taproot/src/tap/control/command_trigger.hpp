@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMAND_TRIGGER_HPP_
+#define COMMAND_TRIGGER_HPP_
+
+#include <cstdint>
+
+namespace tap::can
+{
+class CanRxListener;
+}
+
+namespace tap::control
+{
+/**
+ * Optional trigger that makes a Command event driven rather than free running. A trigger with
+ * no sources is disabled and the Command is executed every time it is due. Once sources are
+ * added (typically the `DjiMotor`s or other `CanRxListener`s whose feedback the Command uses),
+ * the CommandScheduler only executes the Command when at least one source has received a new
+ * message since the last execution, or when `timeout` microseconds have passed without any.
+ *
+ * A trigger only skips runs if its sources update slower than the scheduler runs. DJI motors
+ * send feedback at 1 kHz, faster than the 500 Hz scheduler, so triggering on them only adds a
+ * check to every run. Use triggers for Commands driven by slower sensors instead:
+ *
+ * ```
+ * // distanceSensor sends a measurement every 10 ms
+ * alignCommand.getTrigger().addSource(&distanceSensor);
+ * alignCommand.getTrigger().setTimeout(20'000);
+ * ```
+ */
+class CommandTrigger
+{
+public:
+    static constexpr int MAX_SOURCES = 4;
+
+    /// Default time after which a triggered Command is executed without new data, in microseconds.
+    static constexpr uint32_t DEFAULT_TIMEOUT = 10'000;
+
+    /**
+     * Adds a source whose new messages cause the Command to be executed.
+     *
+     * @param[in] source The listener to watch. Must not be `nullptr`, at most `MAX_SOURCES`
+     *      sources may be added.
+     */
+    void addSource(const can::CanRxListener* source);
+
+    /**
+     * @param[in] timeout The maximum time between executions when no new data arrives, in
+     *      microseconds.
+     */
+    inline void setTimeout(uint32_t timeout) { this->timeout = timeout; }
+
+    inline uint32_t getTimeout() const { return timeout; }
+
+    /**
+     * @return `true` if any sources have been added.
+     */
+    inline bool isEnabled() const { return numSources > 0; }
+
+    /**
+     * Checks whether the Command should be executed at `currTime`. If so, all data received so
+     * far is considered consumed.
+     *
+     * @param[in] currTime The current time, in microseconds.
+     * @return `true` if a source has new data or the timeout has expired.
+     */
+    bool poll(uint32_t currTime);
+
+    /**
+     * @return The number of times the Command was executed because the timeout expired rather
+     *      than because new data arrived.
+     */
+    inline uint32_t getTimeoutCount() const { return timeoutCount; }
+
+private:
+    const can::CanRxListener* sources[MAX_SOURCES] = {};
+    uint32_t lastReceiveCounts[MAX_SOURCES] = {};
+    int numSources = 0;
+
+    uint32_t timeout = DEFAULT_TIMEOUT;
+    uint32_t lastTriggerTime = 0;
+    uint32_t timeoutCount = 0;
+};  // class CommandTrigger
+}  // namespace tap::control
+
+#endif  // COMMAND_TRIGGER_HPP_
@@ -21,7 +21,7 @@
 #define __COMPRISED_COMMAND_HPP__
 
 #include "command.hpp"
-#include "command_scheduler.hpp"
+#include "sub_command_executor.hpp"
 
 namespace tap
 {
@@ -30,12 +30,12 @@ namespace control
 {
 /**
  * A class with all the features of a Command but with the addition of
- * a CommandScheduler that can be used to schedule multiple
+ * a SubCommandExecutor that can be used to schedule multiple
  * Commands inside a single Command. If you are making a comprised command,
  * operations in this Command should operate at a high level. In essence,
  * a comprised acts as a vessel for a state machine that when it wants
  * to change the state of the robot, it adds/removes commands to its
- * command scheduler instead of directly interacting with a subsystem.
+ * command executor instead of directly interacting with a subsystem.
  *
  * For example, consider this use case: You have a Command that actuates
  * a piston to grab something and another Command that flips a wrist that
@@ -46,17 +46,17 @@ namespace control
  * schedule the Command that flips the wrist out, then when that Command
  * is done, schedule the Command that actuates the piston.
  *
- * When you are using this the `comprisedCommandScheduler`, be sure to
+ * When you are using the `comprisedCommandExecutor`, be sure to
  * register Subsystems and add Subsystem dependencies for the Commands that
- * will be added to the scheduler.
+ * will be added to the executor. Call its `run()` function from `execute()`.
  */
 class ComprisedCommand : public Command
 {
 public:
-    ComprisedCommand(Drivers *drivers) : Command(), comprisedCommandScheduler(drivers) {}
+    ComprisedCommand(Drivers *drivers) : Command(), comprisedCommandExecutor(drivers) {}
 
 protected:
-    CommandScheduler comprisedCommandScheduler;
+    SubCommandExecutor comprisedCommandExecutor;
 };
 
 }  // namespace control
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MULTIWORD_BITMAP_HPP_
+#define MULTIWORD_BITMAP_HPP_
+
+#include <cstdint>
+
+namespace tap::control
+{
+/**
+ * A fixed size set of bits backed by an array of 64-bit words, used by the CommandScheduler to
+ * track Commands and Subsystems by global identifier. All operations loop over the words, so
+ * when `BITS <= 64` they compile down to the same single word operations as a raw `uint64_t`.
+ *
+ * Bits at or above `BITS` in the last word are always kept clear.
+ *
+ * @tparam BITS The number of bits in the bitmap.
+ */
+template <int BITS>
+class MultiwordBitmap
+{
+public:
+    static_assert(BITS > 0, "bitmap must contain at least one bit");
+
+    using word_t = uint64_t;
+
+    static constexpr int SIZE = BITS;
+    static constexpr int WORD_BITS = sizeof(word_t) * 8;
+    static constexpr int WORD_COUNT = (BITS + WORD_BITS - 1) / WORD_BITS;
+
+    constexpr MultiwordBitmap() : words{} {}
+
+    /**
+     * @return A bitmap with only the bit at `index` set.
+     */
+    static MultiwordBitmap oneHot(int index)
+    {
+        MultiwordBitmap bitmap;
+        bitmap.set(index);
+        return bitmap;
+    }
+
+    inline void set(int index) { words[index / WORD_BITS] |= bitInWord(index); }
+
+    inline void reset(int index) { words[index / WORD_BITS] &= ~bitInWord(index); }
+
+    inline bool test(int index) const { return words[index / WORD_BITS] & bitInWord(index); }
+
+    /**
+     * Clears all bits.
+     */
+    inline void reset()
+    {
+        for (word_t& word : words)
+        {
+            word = 0;
+        }
+    }
+
+    inline bool any() const
+    {
+        for (word_t word : words)
+        {
+            if (word != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool none() const { return !any(); }
+
+    explicit operator bool() const { return any(); }
+
+    /**
+     * @return The number of bits set.
+     */
+    inline int count() const
+    {
+        int count = 0;
+        for (word_t word : words)
+        {
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
+
+    /**
+     * @return The index of the least significant bit set that is at or above `startIndex`, or
+     *      `-1` if no such bit exists. Uses count trailing zeros so only set bits and nonzero
+     *      words are ever visited.
+     */
+    inline int findNext(int startIndex) const
+    {
+        if (startIndex < 0 || startIndex >= BITS)
+        {
+            return -1;
+        }
+
+        int wordIndex = startIndex / WORD_BITS;
+        word_t word = words[wordIndex] & (~static_cast<word_t>(0) << (startIndex % WORD_BITS));
+        while (word == 0)
+        {
+            if (++wordIndex >= WORD_COUNT)
+            {
+                return -1;
+            }
+            word = words[wordIndex];
+        }
+        return wordIndex * WORD_BITS + __builtin_ctzll(word);
+    }
+
+    /**
+     * @return The index of the least significant bit set, or `-1` if no bits are set.
+     */
+    inline int findFirst() const { return findNext(0); }
+
+    inline MultiwordBitmap& operator&=(const MultiwordBitmap& other)
+    {
+        for (int i = 0; i < WORD_COUNT; i++)
+        {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    inline MultiwordBitmap& operator|=(const MultiwordBitmap& other)
+    {
+        for (int i = 0; i < WORD_COUNT; i++)
+        {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    inline MultiwordBitmap operator~() const
+    {
+        MultiwordBitmap result;
+        for (int i = 0; i < WORD_COUNT; i++)
+        {
+            result.words[i] = ~words[i];
+        }
+        result.words[WORD_COUNT - 1] &= LAST_WORD_MASK;
+        return result;
+    }
+
+    friend inline MultiwordBitmap operator&(MultiwordBitmap a, const MultiwordBitmap& b)
+    {
+        return a &= b;
+    }
+
+    friend inline MultiwordBitmap operator|(MultiwordBitmap a, const MultiwordBitmap& b)
+    {
+        return a |= b;
+    }
+
+    friend inline bool operator==(const MultiwordBitmap& a, const MultiwordBitmap& b)
+    {
+        for (int i = 0; i < WORD_COUNT; i++)
+        {
+            if (a.words[i] != b.words[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend inline bool operator!=(const MultiwordBitmap& a, const MultiwordBitmap& b)
+    {
+        return !(a == b);
+    }
+
+private:
+    static constexpr int LAST_WORD_BITS = BITS - (WORD_COUNT - 1) * WORD_BITS;
+    static constexpr word_t LAST_WORD_MASK =
+        LAST_WORD_BITS == WORD_BITS ? ~static_cast<word_t>(0)
+                                    : (static_cast<word_t>(1) << LAST_WORD_BITS) - 1;
+
+    static inline word_t bitInWord(int index)
+    {
+        return static_cast<word_t>(1) << (index % WORD_BITS);
+    }
+
+    word_t words[WORD_COUNT];
+};
+}  // namespace tap::control
+
+#endif  // MULTIWORD_BITMAP_HPP_
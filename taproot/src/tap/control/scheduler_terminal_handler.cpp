@@ -25,6 +25,7 @@
 #include "tap/drivers.hpp"
 
 #include "command.hpp"
+#include "scheduler_trace.hpp"
 #include "subsystem.hpp"
 
 namespace tap
@@ -40,7 +41,14 @@ void SchedulerTerminalHandler::init() { drivers->terminalSerial.addHeader(HEADER
 
 void SchedulerTerminalHandler::terminalSerialStreamCallback(modm::IOStream& outputStream)
 {
-    printInfo(outputStream);
+    if (printTiming)
+    {
+        printExecutionTimes(outputStream);
+    }
+    else
+    {
+        printInfo(outputStream);
+    }
 }
 
 bool SchedulerTerminalHandler::terminalSerialCallback(
@@ -52,9 +60,34 @@ bool SchedulerTerminalHandler::terminalSerialCallback(
 
     if (arg != nullptr && strcmp(arg, "allsubcmd") == 0)
     {
+        printTiming = false;
         printInfo(outputStream);
         return true;
     }
+    else if (arg != nullptr && strcmp(arg, "timing") == 0)
+    {
+        printTiming = true;
+        printExecutionTimes(outputStream);
+        return true;
+    }
+    else if (arg != nullptr && strcmp(arg, "trace") == 0)
+    {
+        printTrace(outputStream);
+        return !streamingEnabled;
+    }
+    else if (arg != nullptr && strcmp(arg, "cleartrace") == 0)
+    {
+        SchedulerTrace::clear();
+        outputStream << "trace cleared" << modm::endl;
+        return !streamingEnabled;
+    }
+    else if (arg != nullptr && strcmp(arg, "resettiming") == 0)
+    {
+        CommandScheduler::resetExecutionTimes();
+        drivers->controlTick.resetStats();
+        outputStream << "execution times cleared" << modm::endl;
+        return !streamingEnabled;
+    }
     else
     {
         outputStream << USAGE;
@@ -76,6 +109,108 @@ void SchedulerTerminalHandler::printInfo(modm::IOStream& outputStream)
         drivers->commandScheduler.cmdMapEnd(),
         [&](Command* cmd) { outputStream << " " << cmd->getName() << modm::endl; });
 }
+
+static void printExecutionTime(
+    modm::IOStream& outputStream,
+    const char* name,
+    const CommandScheduler::ExecutionTimeStats& stats)
+{
+    outputStream << " " << name << ": ";
+    if (stats.samples == 0)
+    {
+        outputStream << "no samples";
+    }
+    else
+    {
+        outputStream << stats.min << "/" << stats.mean() << "/" << stats.max << "/"
+                     << stats.last;
+    }
+    outputStream << ", overruns: " << stats.overruns << ", deferrals: " << stats.deferrals
+                 << modm::endl;
+}
+
+void SchedulerTerminalHandler::printExecutionTimes(modm::IOStream& outputStream)
+{
+    outputStream << "Scheduler run (min/mean/max/last us), budget "
+                 << drivers->commandScheduler.getRunBudget() << " us:" << modm::endl;
+    printExecutionTime(outputStream, "run", CommandScheduler::getRunTime());
+
+    if (drivers->controlTick.isRunning())
+    {
+        const arch::ControlTick::TickStats& tick = drivers->controlTick.getStats();
+        outputStream << "Control tick (min/mean/max/last us), period "
+                     << drivers->controlTick.getPeriod() << " us:" << modm::endl;
+        outputStream << " period: " << tick.minPeriod << "/" << tick.meanPeriod() << "/"
+                     << tick.maxPeriod << "/" << tick.lastPeriod << ", jitter (mean/max): "
+                     << tick.meanJitter() << "/" << tick.maxJitter << modm::endl;
+        outputStream << " execution (max/last): " << tick.maxExecution << "/"
+                     << tick.lastExecution << ", overruns: " << tick.overruns << modm::endl;
+    }
+
+    outputStream << "Subsystem refresh (min/mean/max/last us):" << modm::endl;
+    std::for_each(
+        drivers->commandScheduler.subMapBegin(),
+        drivers->commandScheduler.subMapEnd(),
+        [&](Subsystem* sub) {
+            printExecutionTime(
+                outputStream,
+                sub->getName(),
+                CommandScheduler::getSubsystemRefreshTime(sub->getGlobalIdentifier()));
+        });
+
+    outputStream << "Command execute (min/mean/max/last us):" << modm::endl;
+    std::for_each(
+        drivers->commandScheduler.cmdMapBegin(),
+        drivers->commandScheduler.cmdMapEnd(),
+        [&](Command* cmd) {
+            printExecutionTime(
+                outputStream,
+                cmd->getName(),
+                CommandScheduler::getCommandExecutionTime(cmd->getGlobalIdentifier()));
+        });
+}
+
+void SchedulerTerminalHandler::printTrace(modm::IOStream& outputStream)
+{
+    if (!SchedulerTrace::ENABLED)
+    {
+        outputStream << "scheduler tracing disabled, build with trace=true" << modm::endl;
+        return;
+    }
+
+    // Names of everything that may appear in the trace, followed by the raw records
+    outputStream << "trace begin " << SchedulerTrace::size() << " "
+                 << SchedulerTrace::getDroppedCount() << modm::endl;
+    for (int i = 0; i < command_scheduler_bitmap_t::SIZE; i++)
+    {
+        const Command* cmd = CommandScheduler::getCommandFromGlobalIdentifier(i);
+        if (cmd != nullptr)
+        {
+            outputStream << "C " << i << " " << cmd->getName() << modm::endl;
+        }
+    }
+    for (int i = 0; i < subsystem_scheduler_bitmap_t::SIZE; i++)
+    {
+        Subsystem* sub = CommandScheduler::getSubsystemFromGlobalIdentifier(i);
+        if (sub != nullptr)
+        {
+            outputStream << "S " << i << " " << sub->getName() << modm::endl;
+        }
+    }
+
+    outputStream << modm::hex;
+    for (int i = 0; i < SchedulerTrace::size(); i++)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&SchedulerTrace::get(i));
+        outputStream << "R ";
+        for (size_t j = 0; j < sizeof(SchedulerTraceRecord); j++)
+        {
+            outputStream << bytes[j];
+        }
+        outputStream << modm::ascii << modm::endl << modm::hex;
+    }
+    outputStream << modm::ascii << "trace end" << modm::endl;
+}
 }  // namespace control
 
 }  // namespace tap
@@ -53,9 +53,26 @@ private:
         "Usage: scheduler <target>\n"
         "  Where \"<target>\" is one of:\n"
         "    - \"-H\": displays possible commands.\n"
-        "    - \"allsubcmd\" prints all running subsystems and.\n";
+        "    - \"allsubcmd\" prints all running subsystems and.\n"
+        "    - \"timing\" prints execution times (min/mean/max/last, in us) and the number\n"
+        "      of scheduler overruns caused and budget deferrals of each command and\n"
+        "      subsystem, and the control tick period and jitter.\n"
+        "    - \"resettiming\" clears all execution times and control tick statistics.\n"
+        "    - \"trace\" dumps the scheduler event trace (requires building with trace=true),\n"
+        "      decode with taproot/build_tools/decode_scheduler_trace.py.\n"
+        "    - \"cleartrace\" clears the scheduler event trace.\n";
+
+    /**
+     * `true` if `timing` was the last target requested, in which case execution times
+     * are printed when streaming.
+     */
+    bool printTiming = false;
 
     void printInfo(modm::IOStream& outputStream);
+
+    void printExecutionTimes(modm::IOStream& outputStream);
+
+    void printTrace(modm::IOStream& outputStream);
 };
 
 }  // namespace control
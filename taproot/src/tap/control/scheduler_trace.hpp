@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCHEDULER_TRACE_HPP_
+#define SCHEDULER_TRACE_HPP_
+
+#include <cstdint>
+
+/**
+ * Records a CommandScheduler event in the `SchedulerTrace`. Compiles to nothing unless
+ * `RUN_WITH_SCHEDULER_TRACE` is defined (build with `trace=true`).
+ */
+#define SCHEDULER_TRACE(event, id, time, arg)
+
+#ifdef RUN_WITH_SCHEDULER_TRACE
+#undef SCHEDULER_TRACE
+#define SCHEDULER_TRACE(event, id, time, arg) \
+    ::tap::control::SchedulerTrace::record(event, id, time, arg)
+#endif
+
+/**
+ * The number of records kept by the `SchedulerTrace`, must be a power of 2.
+ */
+#ifndef SCHEDULER_TRACE_CAPACITY
+#define SCHEDULER_TRACE_CAPACITY 512
+#endif
+
+namespace tap::control
+{
+enum class SchedulerTraceEvent : uint8_t
+{
+    ADD_COMMAND = 0,
+    /// `arg` is `1` if the Command was interrupted.
+    REMOVE_COMMAND,
+    EXECUTE_START,
+    EXECUTE_END,
+    REFRESH_START,
+    REFRESH_END,
+    /// The safe disconnect function started returning `true`, `id` is unused.
+    SAFE_DISCONNECT,
+    /// The safe disconnect function started returning `false`, `id` is unused.
+    SAFE_RECONNECT,
+};
+
+/**
+ * A single 8 byte trace record. Dumped little endian, in field order.
+ */
+struct SchedulerTraceRecord
+{
+    /// Time of the event, in microseconds.
+    uint32_t time;
+    /// Global identifier of the Command or Subsystem.
+    uint16_t id;
+    /// A `SchedulerTraceEvent`.
+    uint8_t event;
+    /// Event specific argument.
+    uint8_t arg;
+};
+
+static_assert(sizeof(SchedulerTraceRecord) == 8, "trace records must stay 8 bytes");
+
+/**
+ * Fixed size RAM ring buffer of CommandScheduler events, meant for debugging scheduling issues
+ * (commands thrashing between a default and a mapped command, etc.) without printing from the
+ * control loop. When full, the oldest records are overwritten. Dump the trace with the
+ * `scheduler trace` terminal command and decode it on the host with
+ * `taproot/build_tools/decode_scheduler_trace.py`.
+ */
+class SchedulerTrace
+{
+public:
+    static constexpr int CAPACITY = SCHEDULER_TRACE_CAPACITY;
+
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of 2");
+
+#ifdef RUN_WITH_SCHEDULER_TRACE
+    static constexpr bool ENABLED = true;
+
+    static inline void record(SchedulerTraceEvent event, int id, uint32_t time, uint8_t arg)
+    {
+        SchedulerTraceRecord& r = records[head & (CAPACITY - 1)];
+        r.time = time;
+        r.id = id;
+        r.event = static_cast<uint8_t>(event);
+        r.arg = arg;
+        head++;
+    }
+
+    /**
+     * @return The number of records currently stored.
+     */
+    static inline int size()
+    {
+        return head < static_cast<uint32_t>(CAPACITY) ? static_cast<int>(head) : CAPACITY;
+    }
+
+    /**
+     * @return The `index`th oldest record stored, `index` must be less than `size()`.
+     */
+    static inline const SchedulerTraceRecord& get(int index)
+    {
+        return records[(head - size() + index) & (CAPACITY - 1)];
+    }
+
+    /**
+     * @return The number of records that have been overwritten since the last `clear()`.
+     */
+    static inline uint32_t getDroppedCount() { return head - size(); }
+
+    static inline void clear() { head = 0; }
+
+private:
+    static SchedulerTraceRecord records[CAPACITY];
+
+    /// The total number of records written since the last `clear()`.
+    static uint32_t head;
+#else
+    static constexpr bool ENABLED = false;
+
+    static inline int size() { return 0; }
+    static inline const SchedulerTraceRecord& get(int) { return EMPTY_RECORD; }
+    static inline uint32_t getDroppedCount() { return 0; }
+    static inline void clear() {}
+
+private:
+    static constexpr SchedulerTraceRecord EMPTY_RECORD = {};
+#endif
+};  // class SchedulerTrace
+}  // namespace tap::control
+
+#endif  // SCHEDULER_TRACE_HPP_
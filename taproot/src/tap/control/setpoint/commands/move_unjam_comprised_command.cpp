@@ -20,7 +20,6 @@
 #include "tap/control/setpoint/commands/move_unjam_comprised_command.hpp"
 
 #include "tap/algorithms/math_user_utils.hpp"
-#include "tap/control/command_scheduler.hpp"
 #include "tap/control/setpoint/interfaces/setpoint_subsystem.hpp"
 
 #include "move_command.hpp"
@@ -53,13 +52,13 @@ MoveUnjamComprisedCommand::MoveUnjamComprisedCommand(
       unjamSequenceCommencing(false),
       agitatorDisconnectFault(false)
 {
-    this->comprisedCommandScheduler.registerSubsystem(setpointSubsystem);
+    this->comprisedCommandExecutor.registerSubsystem(setpointSubsystem);
     this->addSubsystemRequirement(dynamic_cast<Subsystem*>(setpointSubsystem));
 }
 
 void MoveUnjamComprisedCommand::initialize()
 {
-    this->comprisedCommandScheduler.addCommand(dynamic_cast<Command*>(&agitatorRotateCommand));
+    this->comprisedCommandExecutor.addCommand(&agitatorRotateCommand);
     unjamSequenceCommencing = false;
 }
 
@@ -80,10 +79,9 @@ void MoveUnjamComprisedCommand::execute()
             // the to scheduler. The rotate forward command will be automatically
             // unscheduled.
             unjamSequenceCommencing = true;
-            this->comprisedCommandScheduler.addCommand(
-                dynamic_cast<Command*>(&agitatorUnjamCommand));
+            this->comprisedCommandExecutor.addCommand(&agitatorUnjamCommand);
         }
-        this->comprisedCommandScheduler.run();
+        this->comprisedCommandExecutor.run();
     }
 }
 
@@ -96,20 +94,16 @@ void MoveUnjamComprisedCommand::end(bool interrupted)
     // set it back to false
     agitatorDisconnectFault = false;
 
-    this->comprisedCommandScheduler.removeCommand(
-        dynamic_cast<Command*>(&agitatorUnjamCommand),
-        interrupted);
-    this->comprisedCommandScheduler.removeCommand(
-        dynamic_cast<Command*>(&agitatorRotateCommand),
-        interrupted);
+    this->comprisedCommandExecutor.removeCommand(&agitatorUnjamCommand, interrupted);
+    this->comprisedCommandExecutor.removeCommand(&agitatorRotateCommand, interrupted);
 }
 
 bool MoveUnjamComprisedCommand::isFinished() const
 {
     return (!unjamSequenceCommencing &&
-            !comprisedCommandScheduler.isCommandScheduled(&agitatorRotateCommand)) ||
+            !comprisedCommandExecutor.isCommandScheduled(&agitatorRotateCommand)) ||
            (unjamSequenceCommencing &&
-            !comprisedCommandScheduler.isCommandScheduled(&agitatorUnjamCommand)) ||
+            !comprisedCommandExecutor.isCommandScheduled(&agitatorUnjamCommand)) ||
            agitatorDisconnectFault;
 }
 
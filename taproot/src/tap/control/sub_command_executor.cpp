@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sub_command_executor.hpp"
+
+#include "tap/drivers.hpp"
+#include "tap/errors/create_errors.hpp"
+
+#include "command.hpp"
+#include "subsystem.hpp"
+
+namespace tap
+{
+namespace control
+{
+SubCommandExecutor::SubCommandExecutor(Drivers *drivers) : drivers(drivers) {}
+
+void SubCommandExecutor::run()
+{
+    compact();
+    running = true;
+    // Commands added during the pass are appended and so run in it too
+    for (int i = 0; i < numSlots; i++)
+    {
+        Command *cmd = commands[i];
+        if (cmd == nullptr)
+        {
+            continue;
+        }
+
+        cmd->execute();
+        // The command may have been removed or replaced during its own execute
+        if (commands[i] == cmd && cmd->isFinished())
+        {
+            removeCommand(cmd, false);
+        }
+    }
+    running = false;
+}
+
+void SubCommandExecutor::addCommand(Command *commandToAdd)
+{
+    if (commandToAdd == nullptr)
+    {
+        RAISE_ERROR(drivers, "attempting to add nullptr command");
+        return;
+    }
+    else if (!commandToAdd->isReady())
+    {
+        return;
+    }
+
+    subsystem_scheduler_bitmap_t requirements = commandToAdd->getRequirementsBitwise();
+    if ((requirements & registeredSubsystemBitmap) != requirements || requirements.none())
+    {
+        RAISE_ERROR(drivers, "Attempting to add a command without subsystem in the executor");
+        return;
+    }
+
+    // End all commands using the requirements, including commandToAdd if already running
+    for (Command *cmd : commands)
+    {
+        if (cmd != nullptr && (cmd->getRequirementsBitwise() & requirements))
+        {
+            removeCommand(cmd, true);
+        }
+    }
+
+    if (numSlots == MAX_COMMAND_COUNT && !running)
+    {
+        compact();
+    }
+    if (numSlots == MAX_COMMAND_COUNT)
+    {
+        RAISE_ERROR(drivers, "too many commands in sub command executor");
+        return;
+    }
+
+    commandToAdd->initialize();
+    commands[numSlots++] = commandToAdd;
+    numCommands++;
+}
+
+void SubCommandExecutor::removeCommand(Command *command, bool interrupted)
+{
+    if (command == nullptr)
+    {
+        RAISE_ERROR(drivers, "trying to remove nullptr command");
+        return;
+    }
+
+    int slot = findSlot(command);
+    if (slot < 0)
+    {
+        return;
+    }
+
+    command->end(interrupted);
+    commands[slot] = nullptr;
+    numCommands--;
+}
+
+bool SubCommandExecutor::isCommandScheduled(const Command *command) const
+{
+    return command != nullptr && findSlot(command) >= 0;
+}
+
+void SubCommandExecutor::registerSubsystem(Subsystem *subsystem)
+{
+    if (subsystem == nullptr)
+    {
+        RAISE_ERROR(drivers, "trying to register nullptr subsystem");
+        return;
+    }
+    registeredSubsystemBitmap.set(subsystem->getGlobalIdentifier());
+}
+
+int SubCommandExecutor::findSlot(const Command *command) const
+{
+    for (int i = 0; i < numSlots; i++)
+    {
+        if (commands[i] == command)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SubCommandExecutor::compact()
+{
+    int used = 0;
+    for (int i = 0; i < numSlots; i++)
+    {
+        if (commands[i] != nullptr)
+        {
+            commands[used++] = commands[i];
+        }
+    }
+    for (int i = used; i < numSlots; i++)
+    {
+        commands[i] = nullptr;
+    }
+    numSlots = used;
+}
+
+}  // namespace control
+
+}  // namespace tap
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUB_COMMAND_EXECUTOR_HPP_
+#define SUB_COMMAND_EXECUTOR_HPP_
+
+#include "tap/util_macros.hpp"
+
+#include "command_scheduler_types.hpp"
+
+namespace tap
+{
+class Drivers;
+namespace control
+{
+class Command;
+class Subsystem;
+
+/**
+ * Runs the child Commands of a ComprisedCommand. Provides the same add, interrupt and end
+ * semantics as a CommandScheduler for a small, fixed number of Commands, but none of the
+ * machinery a ComprisedCommand does not need: there is no global registrar walk, no safe
+ * disconnect check, no Subsystem refresh and no default Commands. Subsystems are refreshed and
+ * the remote's connection is handled by the main CommandScheduler running the parent Command.
+ *
+ * Child Commands are executed in the order they were added, every time `run()` is called. Their
+ * scheduling period, priority and trigger are ignored since those are managed by the main
+ * CommandScheduler for the parent.
+ */
+class SubCommandExecutor
+{
+public:
+    /// The maximum number of Commands that may be running in a single executor at once.
+    static constexpr int MAX_COMMAND_COUNT = 8;
+
+    SubCommandExecutor(Drivers* drivers);
+    DISALLOW_COPY_AND_ASSIGN(SubCommandExecutor)
+    mockable ~SubCommandExecutor() = default;
+
+    /**
+     * Calls `execute()` on every Command added to the executor. Any Command that is finished
+     * afterwards is removed and its `end()` function is called with `interrupted = false`.
+     */
+    mockable void run();
+
+    /**
+     * Adds a Command to the executor. The Command must be ready and its requirements must all
+     * be registered with `registerSubsystem()`, otherwise it is not added (an error is raised
+     * in the latter case). Any Commands in the executor sharing a requirement with
+     * `commandToAdd` are ended with `interrupted = true`, then `commandToAdd` is initialized.
+     *
+     * @param[in] commandToAdd The Command to add.
+     */
+    mockable void addCommand(Command* commandToAdd);
+
+    /**
+     * Removes the given Command from the executor and calls its `end()` function. Does nothing
+     * if the Command is not in the executor.
+     *
+     * @param[in] command The Command to remove.
+     * @param[in] interrupted Passed to the Command's `end()` function.
+     */
+    mockable void removeCommand(Command* command, bool interrupted);
+
+    /**
+     * @return `true` if the given Command has been added and has not yet ended.
+     */
+    mockable bool isCommandScheduled(const Command* command) const;
+
+    /**
+     * Allows Commands requiring the given Subsystem to be added to the executor.
+     */
+    mockable void registerSubsystem(Subsystem* subsystem);
+
+    /**
+     * @return The number of Commands currently in the executor.
+     */
+    mockable int commandListSize() const { return numCommands; }
+
+private:
+    Drivers* drivers;
+
+    /**
+     * Commands in the executor, in the order they were added. New Commands are appended after
+     * `numSlots`. Slots of ended Commands are set to `nullptr` so Commands can be added and
+     * removed while `run()` is iterating, and are compacted away, keeping the order, whenever
+     * `run()` is not iterating.
+     */
+    Command* commands[MAX_COMMAND_COUNT] = {};
+
+    /// The number of slots in use, including those of ended Commands not yet compacted away.
+    int numSlots = 0;
+
+    int numCommands = 0;
+
+    /// `true` while `run()` is iterating over `commands`.
+    bool running = false;
+
+    subsystem_scheduler_bitmap_t registeredSubsystemBitmap;
+
+    int findSlot(const Command* command) const;
+
+    /// Moves the Commands down over the slots of ended ones, keeping their order.
+    void compact();
+};  // class SubCommandExecutor
+
+}  // namespace control
+
+}  // namespace tap
+
+#endif  // SUB_COMMAND_EXECUTOR_HPP_
@@ -24,6 +24,8 @@
 
 #include "tap/util_macros.hpp"
 
+#include "command_scheduler_types.hpp"
+
 namespace tap
 {
 class Drivers;
@@ -114,6 +116,33 @@ public:
     // This shouldn't be mockable
     inline int getGlobalIdentifier() const { return globalIdentifier; }
 
+    /**
+     * Sets the period at which the CommandScheduler should call `refresh()`. A control loop
+     * that must run fast can keep the default while slow housekeeping can use a longer period.
+     *
+     * @param[in] period The desired period, in microseconds, rounded to the nearest multiple
+     *      of the scheduler's run period. A period of 0 (the default) or one shorter than the
+     *      run period means the Subsystem is refreshed every time the scheduler runs, as the
+     *      scheduler cannot run anything faster than that.
+     * @see CommandScheduler::setRunPeriod
+     */
+    inline void setSchedulingPeriod(uint32_t period) { schedulingPeriod = period; }
+
+    inline uint32_t getSchedulingPeriod() const { return schedulingPeriod; }
+
+    /**
+     * Sets the priority class of this Subsystem. `BEST_EFFORT` Subsystems are refreshed after all
+     * other work and skipped for a run if the CommandScheduler's run budget is used up.
+     *
+     * @see CommandScheduler::setRunBudget
+     */
+    inline void setSchedulingPriority(SchedulingPriority priority)
+    {
+        schedulingPriority = priority;
+    }
+
+    inline SchedulingPriority getSchedulingPriority() const { return schedulingPriority; }
+
 protected:
     Drivers* drivers;
 
@@ -132,6 +161,13 @@ private:
      */
     const int globalIdentifier;
 
+    /**
+     * The period at which this subsystem would like to be refreshed, in microseconds.
+     */
+    uint32_t schedulingPeriod = 0;
+
+    SchedulingPriority schedulingPriority = SchedulingPriority::CONTROL;
+
 #if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
     //> Testing Related Stuff ---
 public:
@@ -21,7 +21,12 @@
 #define TAP_DRIVERS_HPP_
 
 #if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
+#include "tap/architecture/control_tick.hpp"
 #include "tap/architecture/profiler.hpp"
+#include "tap/architecture/profiler_terminal_handler.hpp"
+#include "tap/communication/can/can_stats.hpp"
+#include "tap/communication/can/can_terminal_handler.hpp"
+#include "tap/communication/tcp-server/motor_telemetry.hpp"
 #include "tap/mock/analog_mock.hpp"
 #include "tap/mock/can_mock.hpp"
 #include "tap/mock/can_rx_handler_mock.hpp"
@@ -38,10 +43,16 @@
 #include "tap/mock/terminal_serial_mock.hpp"
 #include "tap/mock/uart_mock.hpp"
 #include "tap/mock/command_scheduler_mock.hpp"
+#include "tap/motor/dji_motor_bank.hpp"
+#include "tap/motor/motor_inner_loop_service.hpp"
 #else
+#include "tap/architecture/control_tick.hpp"
 #include "tap/architecture/profiler.hpp"
+#include "tap/architecture/profiler_terminal_handler.hpp"
 #include "tap/communication/can/can.hpp"
 #include "tap/communication/can/can_rx_handler.hpp"
+#include "tap/communication/can/can_stats.hpp"
+#include "tap/communication/can/can_terminal_handler.hpp"
 #include "tap/communication/gpio/analog.hpp"
 #include "tap/communication/gpio/digital.hpp"
 #include "tap/communication/gpio/leds.hpp"
@@ -50,11 +61,14 @@
 #include "tap/communication/serial/remote.hpp"
 #include "tap/communication/serial/terminal_serial.hpp"
 #include "tap/communication/serial/uart.hpp"
+#include "tap/communication/tcp-server/motor_telemetry.hpp"
 #include "tap/control/command_mapper.hpp"
 #include "tap/control/scheduler_terminal_handler.hpp"
 #include "tap/errors/error_controller.hpp"
+#include "tap/motor/dji_motor_bank.hpp"
 #include "tap/motor/dji_motor_terminal_serial_handler.hpp"
 #include "tap/motor/dji_motor_tx_handler.hpp"
+#include "tap/motor/motor_inner_loop_service.hpp"
 #include "tap/control/command_scheduler.hpp"
 #endif
 
@@ -71,9 +85,12 @@ protected:
 #endif
     Drivers()
         : profiler(),
+          controlTick(this),
           analog(),
-          can(),
+          can(&canStats),
           canRxHandler(this),
+          canStats(),
+          canTerminalHandler(this),
           digital(),
           leds(),
           pwm(),
@@ -86,6 +103,13 @@ protected:
           errorController(this),
           djiMotorTerminalSerialHandler(this),
           djiMotorTxHandler(this),
+          djiMotorBankCan1(),
+          djiMotorBankCan2(),
+          motorInnerLoop(this),
+#ifdef PLATFORM_HOSTED
+          motorTelemetry(this),
+#endif
+          profilerTerminalHandler(this),
 #ifdef ENV_UNIT_TESTS
           commandScheduler(this)
 #else
@@ -95,9 +119,12 @@ protected:
 
 #if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
     arch::Profiler profiler;
+    arch::ControlTick controlTick;
     testing::NiceMock<mock::AnalogMock> analog;
     testing::NiceMock<mock::CanMock> can;
     testing::NiceMock<mock::CanRxHandlerMock> canRxHandler;
+    can::CanStats canStats;
+    can::CanTerminalHandler canTerminalHandler;
     testing::NiceMock<mock::DigitalMock> digital;
     testing::NiceMock<mock::LedsMock> leds;
     testing::NiceMock<mock::PwmMock> pwm;
@@ -110,13 +137,21 @@ protected:
     testing::StrictMock<mock::ErrorControllerMock> errorController;
     testing::NiceMock<mock::DjiMotorTerminalSerialHandlerMock> djiMotorTerminalSerialHandler;
     testing::NiceMock<mock::DjiMotorTxHandlerMock> djiMotorTxHandler;
+    motor::DjiMotorBank djiMotorBankCan1;
+    motor::DjiMotorBank djiMotorBankCan2;
+    motor::MotorInnerLoopService motorInnerLoop;
+    communication::MotorTelemetry motorTelemetry;
+    arch::ProfilerTerminalHandler profilerTerminalHandler;
     testing::NiceMock<mock::CommandSchedulerMock> commandScheduler;
 #else
 public:
     arch::Profiler profiler;
+    arch::ControlTick controlTick;
     gpio::Analog analog;
     can::Can can;
     can::CanRxHandler canRxHandler;
+    can::CanStats canStats;
+    can::CanTerminalHandler canTerminalHandler;
     gpio::Digital digital;
     gpio::Leds leds;
     gpio::Pwm pwm;
@@ -129,6 +164,13 @@ public:
     errors::ErrorController errorController;
     motor::DjiMotorTerminalSerialHandler djiMotorTerminalSerialHandler;
     motor::DjiMotorTxHandler djiMotorTxHandler;
+    motor::DjiMotorBank djiMotorBankCan1;
+    motor::DjiMotorBank djiMotorBankCan2;
+    motor::MotorInnerLoopService motorInnerLoop;
+#ifdef PLATFORM_HOSTED
+    communication::MotorTelemetry motorTelemetry;
+#endif
+    arch::ProfilerTerminalHandler profilerTerminalHandler;
     control::CommandScheduler commandScheduler;
 #endif
 };  // class Drivers
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "command_latency_tracker.hpp"
+
+namespace tap
+{
+namespace motor
+{
+void CommandLatencyTracker::onCommandSent(int16_t command, uint32_t time)
+{
+    if (measuring && time - commandTime > RESPONSE_TIMEOUT)
+    {
+        timeouts++;
+        measuring = false;
+    }
+
+    int32_t step = static_cast<int32_t>(command) - lastCommand;
+    lastCommand = command;
+
+    // A step sent while the previous one is still being measured is ignored, the response seen
+    // next can't be attributed to either
+    if (!measuring && (step >= MIN_COMMAND_STEP || step <= -MIN_COMMAND_STEP))
+    {
+        measuring = true;
+        stepDirection = step > 0 ? 1 : -1;
+        baselineTorque = lastTorque;
+        commandTime = time;
+    }
+}
+
+void CommandLatencyTracker::onFeedback(int16_t torque, uint32_t time)
+{
+    lastTorque = torque;
+
+    if (!measuring)
+    {
+        return;
+    }
+
+    // Frames received before the command was sent may be processed after it
+    int32_t latency = static_cast<int32_t>(time - commandTime);
+    if (latency < 0)
+    {
+        return;
+    }
+    else if (latency > static_cast<int32_t>(RESPONSE_TIMEOUT))
+    {
+        timeouts++;
+        measuring = false;
+    }
+    else if ((static_cast<int32_t>(torque) - baselineTorque) * stepDirection >= MIN_RESPONSE)
+    {
+        histogram.add(latency);
+        measuring = false;
+    }
+}
+
+void CommandLatencyTracker::reset()
+{
+    histogram.reset();
+    timeouts = 0;
+    measuring = false;
+}
+}  // namespace motor
+
+}  // namespace tap
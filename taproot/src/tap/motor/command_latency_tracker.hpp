@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMAND_LATENCY_TRACKER_HPP_
+#define COMMAND_LATENCY_TRACKER_HPP_
+
+#include <cstdint>
+
+#include "tap/algorithms/log_histogram.hpp"
+
+namespace tap
+{
+namespace motor
+{
+/**
+ * Measures the round trip latency between sending a motor controller a new output and the
+ * first feedback frame in which the reported torque current responds to it.
+ *
+ * Only steps in the commanded output of at least `MIN_COMMAND_STEP` are measured, so the
+ * response can be told apart from noise. When such a command is sent, the last reported
+ * torque current is kept as a baseline, and the latency is the time until a feedback frame
+ * reports a torque current that moved at least `MIN_RESPONSE` away from the baseline in the
+ * direction of the step. The baseline rather than the commanded value is compared against
+ * since the GM6020's command is a voltage, not a current. Steps with no response within
+ * `RESPONSE_TIMEOUT` are counted as timeouts. Both values are raw, as sent and received on
+ * the bus.
+ *
+ * Command times are taken when the frame is queued, so the latency includes time spent in
+ * the transmit queue.
+ */
+class CommandLatencyTracker
+{
+public:
+    /// 12.5% resolution, up to ~65 ms in us.
+    using Histogram = algorithms::LogHistogram<3, 16>;
+
+    static constexpr int16_t MIN_COMMAND_STEP = 1'000;
+    static constexpr int16_t MIN_RESPONSE = 200;
+    static constexpr uint32_t RESPONSE_TIMEOUT = 50'000;
+
+    /**
+     * @param[in] command the raw output sent to the motor controller.
+     * @param[in] time when the command was queued, in microseconds.
+     */
+    void onCommandSent(int16_t command, uint32_t time);
+
+    /**
+     * @param[in] torque the raw torque current reported by the motor controller.
+     * @param[in] time when the feedback frame was received, in microseconds.
+     */
+    void onFeedback(int16_t torque, uint32_t time);
+
+    const Histogram& getHistogram() const { return histogram; }
+
+    /// Number of measured command steps with no response within `RESPONSE_TIMEOUT`.
+    uint32_t getTimeouts() const { return timeouts; }
+
+    void reset();
+
+private:
+    Histogram histogram;
+    uint32_t timeouts = 0;
+
+    int16_t lastCommand = 0;
+    int16_t lastTorque = 0;
+
+    bool measuring = false;
+    /// +1 for an increasing step, -1 for a decreasing one.
+    int32_t stepDirection = 0;
+    int16_t baselineTorque = 0;
+    uint32_t commandTime = 0;
+};  // class CommandLatencyTracker
+
+}  // namespace motor
+
+}  // namespace tap
+
+#endif  // COMMAND_LATENCY_TRACKER_HPP_
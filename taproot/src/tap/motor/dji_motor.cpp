@@ -22,20 +22,18 @@
 #include "tap/algorithms/math_user_utils.hpp"
 #include "tap/drivers.hpp"
 
-#ifdef PLATFORM_HOSTED
-#include <iostream>
-
-#include "tap/communication/tcp-server/json_messages.hpp"
-#include "tap/communication/tcp-server/tcp_server.hpp"
-
-#include "modm/architecture/interface/can_message.hpp"
-#endif
-
 namespace tap
 {
 namespace motor
 {
-DjiMotor::~DjiMotor() { drivers->djiMotorTxHandler.removeFromMotorManager(*this); }
+DjiMotor::~DjiMotor()
+{
+    drivers->djiMotorTxHandler.removeFromMotorManager(*this);
+    if (bank->getMotor(bankSlot) == this)
+    {
+        bank->unregisterMotor(bankSlot);
+    }
+}
 
 DjiMotor::DjiMotor(
     Drivers* drivers,
@@ -50,54 +48,32 @@ DjiMotor::DjiMotor(
       drivers(drivers),
       motorIdentifier(desMotorIdentifier),
       motorCanBus(motorCanBus),
+      bank(
+          motorCanBus == tap::can::CanBus::CAN_BUS1 ? &drivers->djiMotorBankCan1
+                                                    : &drivers->djiMotorBankCan2),
+      bankSlot(DjiMotorBank::slotForCanId(desMotorIdentifier)),
       desiredOutput(0),
-      shaftRPM(0),
-      temperature(0),
-      torque(0),
       motorInverted(isInverted),
-      encoderWrapped(encoderWrapped),
-      encoderRevolutions(encoderRevolutions)
+      initialEncoderWrapped(encoderWrapped),
+      initialEncoderRevolutions(encoderRevolutions)
 {
-    motorDisconnectTimeout.stop();
 }
 
 void DjiMotor::initialize()
 {
+    bank->registerMotor(
+        bankSlot,
+        this,
+        motorInverted,
+        initialEncoderWrapped,
+        initialEncoderRevolutions);
     drivers->djiMotorTxHandler.addMotorToManager(this);
     attachSelfToRxHandler();
 }
 
-void DjiMotor::parseCanRxData(const modm::can::Message& message)
+void DjiMotor::processMessage(const modm::can::Message& message)
 {
-    if (message.getIdentifier() != DjiMotor::getMotorIdentifier())
-    {
-        return;
-    }
-    uint16_t encoderActual =
-        static_cast<uint16_t>(message.data[0] << 8 | message.data[1]);        // encoder value
-    shaftRPM = static_cast<int16_t>(message.data[2] << 8 | message.data[3]);  // rpm
-    shaftRPM = motorInverted ? -shaftRPM : shaftRPM;
-    torque = static_cast<int16_t>(message.data[4] << 8 | message.data[5]);  // torque
-    torque = motorInverted ? -torque : torque;
-    temperature = static_cast<int8_t>(message.data[6]);  // temperature
-
-    // restart disconnect timer, since you just received a message from the motor
-    motorDisconnectTimeout.restart(MOTOR_DISCONNECT_TIME);
-
-    // invert motor if necessary
-    encoderActual = motorInverted ? ENC_RESOLUTION - 1 - encoderActual : encoderActual;
-    updateEncoderValue(encoderActual);
-
-#ifdef PLATFORM_HOSTED
-    /* So the trace of this function to main() goes through a lot, but inside of main
-     * this function is eventually called through a sequence of functions by
-     * canRxHandler.pollCanData(). In fact this seems to be the only driver that
-     * extends the can_rx_listener class... so it's the only thing that uses CAN? */
-    using namespace tap::communication;
-    std::string jsonMessage = json::makeMotorMessage(*this);
-    const char* jsonCString = jsonMessage.c_str();
-    TCPServer::MainServer()->writeToClient(jsonCString, strlen(jsonCString));
-#endif
+    bank->decode(message, getReceiveTimestamp());
 }
 
 void DjiMotor::setDesiredOutput(int32_t desiredOutput)
@@ -107,15 +83,7 @@ void DjiMotor::setDesiredOutput(int32_t desiredOutput)
     this->desiredOutput = motorInverted ? -desOutputNotInverted : desOutputNotInverted;
 }
 
-bool DjiMotor::isMotorOnline() const
-{
-    /*
-     * motor online if the disconnect timout has not expired (if it received message but
-     * somehow got disconnected) and the timeout hasn't been stopped (initially, the timeout
-     * is stopped)
-     */
-    return !motorDisconnectTimeout.isExpired() && !motorDisconnectTimeout.isStopped();
-}
+bool DjiMotor::isMotorOnline() const { return bank->isOnline(bankSlot); }
 
 void DjiMotor::serializeCanSendData(modm::can::Message* txMessage) const
 {
@@ -128,16 +96,36 @@ void DjiMotor::serializeCanSendData(modm::can::Message* txMessage) const
     txMessage->data[2 * id + 1] = this->getOutputDesired() & 0xFF;
 }
 
+void DjiMotor::recordCommandSent(uint32_t time)
+{
+    bank->recordCommandSent(bankSlot, desiredOutput, time);
+}
+
 // getter functions
 int16_t DjiMotor::getOutputDesired() const { return desiredOutput; }
 
 uint32_t DjiMotor::getMotorIdentifier() const { return motorIdentifier; }
 
-int8_t DjiMotor::getTemperature() const { return temperature; }
+int8_t DjiMotor::getTemperature() const { return bank->getTemperature(bankSlot); }
+
+int16_t DjiMotor::getTorque() const { return bank->getTorque(bankSlot); }
+
+int16_t DjiMotor::getShaftRPM() const { return bank->getShaftRPM(bankSlot); }
 
-int16_t DjiMotor::getTorque() const { return torque; }
+float DjiMotor::getEncoderVelocity() const
+{
+    return bank->getVelocityEstimator(bankSlot).getVelocity();
+}
+
+float DjiMotor::getEncoderAcceleration() const
+{
+    return bank->getVelocityEstimator(bankSlot).getAcceleration();
+}
 
-int16_t DjiMotor::getShaftRPM() const { return shaftRPM; }
+void DjiMotor::setVelocityEstimator(const EncoderVelocityEstimator::Config& config)
+{
+    bank->setVelocityEstimator(bankSlot, config);
+}
 
 bool DjiMotor::isMotorInverted() const { return motorInverted; }
 
@@ -145,27 +133,9 @@ tap::can::CanBus DjiMotor::getCanBus() const { return motorCanBus; }
 
 const char* DjiMotor::getName() const { return motorName; }
 
-int64_t DjiMotor::getEncoderUnwrapped() const
-{
-    return static_cast<int64_t>(encoderWrapped) +
-           static_cast<int64_t>(ENC_RESOLUTION) * encoderRevolutions;
-}
-
-uint16_t DjiMotor::getEncoderWrapped() const { return encoderWrapped; }
+int64_t DjiMotor::getEncoderUnwrapped() const { return bank->getEncoderUnwrapped(bankSlot); }
 
-void DjiMotor::updateEncoderValue(uint16_t newEncWrapped)
-{
-    int16_t enc_dif = newEncWrapped - encoderWrapped;
-    if (enc_dif < -ENC_RESOLUTION / 2)
-    {
-        encoderRevolutions++;
-    }
-    else if (enc_dif > ENC_RESOLUTION / 2)
-    {
-        encoderRevolutions--;
-    }
-    encoderWrapped = newEncWrapped;
-}
+uint16_t DjiMotor::getEncoderWrapped() const { return bank->getEncoderWrapped(bankSlot); }
 }  // namespace motor
 
 }  // namespace tap
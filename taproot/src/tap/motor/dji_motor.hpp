@@ -22,9 +22,9 @@
 
 #include <string>
 
-#include "tap/architecture/timeout.hpp"
 #include "tap/communication/can/can_rx_listener.hpp"
 
+#include "dji_motor_bank.hpp"
 #include "motor_interface.hpp"
 
 namespace tap::motor
@@ -63,13 +63,15 @@ enum MotorId : int32_t
  * it is impossible to know the orientation of the shaft given just the encoder value.
  *
  * Extends the CanRxListener class to attach a message handler for feedback data from the
- * motor to the CAN Rx dispatch handler.
+ * motor to the CAN Rx dispatch handler. The feedback itself is decoded into the
+ * `DjiMotorBank` of the motor's bus, and this class is a view over its slot in the bank, which
+ * is only claimed once `initialize` is called.
  */
 class DjiMotor : public can::CanRxListener, public MotorInterface
 {
 public:
     // 0 - 8191 for dji motors
-    static constexpr uint16_t ENC_RESOLUTION = 8192;
+    static constexpr uint16_t ENC_RESOLUTION = DjiMotorBank::ENC_RESOLUTION;
 
     /**
      * @param drivers a pointer to the drivers struct
@@ -82,7 +84,7 @@ public:
      * @param encoderWrapped the starting encoderValue to store for this motor.
      *      Will be overwritten by the first reported encoder value from the motor
      * @param encoderRevolutions the starting number of encoder revolutions to store.
-     *      See comment for DjiMotor::encoderRevolutions for more details.
+     *      See comment for DjiMotorBank::encoderRevolutions for more details.
      */
     DjiMotor(
         Drivers* drivers,
@@ -106,11 +108,13 @@ public:
     /**
      * Overrides virtual method in the can class, called every time a message with the
      * CAN message id this class is attached to is received by the can receive handler.
-     * Parses the data in the message and updates this class's fields accordingly.
+     * Decodes the message into the motor's bank. `CanRxHandler::pollCanData` decodes feedback
+     * into the bank itself (profiled as `DjiMotorBank::decode`) without calling this, so
+     * subclasses must not rely on overriding it.
      *
      * @param[in] message the message to be processed.
      */
-    void processMessage(const modm::can::Message& message) override { parseCanRxData(message); }
+    void processMessage(const modm::can::Message& message) override;
 
     /**
      * Set the desired output for the motor. The meaning of this value is motor
@@ -126,7 +130,7 @@ public:
 
     /**
      * @return `true` if a CAN message has been received from the motor within the last
-     *      `MOTOR_DISCONNECT_TIME` ms, `false` otherwise.
+     *      `DjiMotorBank::MOTOR_DISCONNECT_TIME` ms, `false` otherwise.
      */
     bool isMotorOnline() const override;
 
@@ -153,12 +157,52 @@ public:
     /** For interpreting the sign of return value see class comment */
     int16_t getShaftRPM() const override;
 
+    /**
+     * @return Velocity estimated from the encoder history by the configured
+     *      `EncoderVelocityEstimator`, in encoder ticks per second. Sign as `getShaftRPM`.
+     */
+    float getEncoderVelocity() const override;
+
+    /// @return Acceleration estimated along with `getEncoderVelocity`, in ticks per second^2.
+    mockable float getEncoderAcceleration() const;
+
+    /**
+     * Selects the estimator behind `getEncoderVelocity` and `getEncoderAcceleration`, least
+     * squares over the 4 newest samples by default. Resets the estimate.
+     */
+    mockable void setVelocityEstimator(const EncoderVelocityEstimator::Config& config);
+
+    /// @return The most recent feedback samples, with receive timestamps in microseconds.
+    const MotorFeedbackHistory& getFeedbackHistory() const
+    {
+        return bank->getFeedbackHistory(bankSlot);
+    }
+
     mockable bool isMotorInverted() const;
 
     mockable tap::can::CanBus getCanBus() const;
 
     mockable const char* getName() const;
 
+    /**
+     * Called by the `DjiMotorTxHandler` when latency measurement is enabled, after the frame
+     * carrying this motor's output was queued.
+     *
+     * @param[in] time when the frame was queued, in microseconds.
+     */
+    mockable void recordCommandSent(uint32_t time);
+
+    /**
+     * @return Round trip latencies between sending this motor a new output and its torque
+     *      current responding, see `CommandLatencyTracker`.
+     */
+    const CommandLatencyTracker& getCommandLatency() const
+    {
+        return bank->getCommandLatency(bankSlot);
+    }
+
+    void resetCommandLatency() { bank->resetCommandLatency(bankSlot); }
+
     template <typename T>
     static void assertEncoderType()
     {
@@ -183,35 +227,21 @@ public:
     }
 
 private:
-    // wait time before the motor is considered disconnected, in milliseconds
-    static const uint32_t MOTOR_DISCONNECT_TIME = 100;
-
     const char* motorName;
 
-    /**
-     * Updates the stored encoder value given a newly received encoder value
-     * special logic necessary for keeping track of unwrapped encoder value.
-     */
-    void updateEncoderValue(uint16_t newEncWrapped);
-
-    /**
-     * Parses the data from a DJI motor feedback CAN message.
-     */
-    void parseCanRxData(const modm::can::Message& message);
-
     Drivers* drivers;
 
     uint32_t motorIdentifier;
 
     tap::can::CanBus motorCanBus;
 
-    int16_t desiredOutput;
-
-    int16_t shaftRPM;
+    /// The bank of `motorCanBus`, holding this motor's feedback state.
+    DjiMotorBank* bank;
 
-    int8_t temperature;
+    /// This motor's slot in `bank`.
+    int bankSlot;
 
-    int16_t torque;
+    int16_t desiredOutput;
 
     /**
      * If `false` the positive rotation direction of the shaft is counter-clockwise when
@@ -220,22 +250,11 @@ private:
      */
     bool motorInverted;
 
-    /**
-     * The raw encoder value reported by the motor controller. It wraps around from
-     * {0..8191}, hence "Wrapped"
-     */
-    uint16_t encoderWrapped;
-
-    /**
-     * Absolute unwrapped encoder position =
-     *      encoderRevolutions * ENCODER_RESOLUTION + encoderWrapped
-     * This lets us keep track of some sense of absolute position even while
-     * raw encoderValue continuosly loops within {0..8191}. Origin value is
-     * arbitrary.
-     */
-    int64_t encoderRevolutions;
+    /// The encoder value the bank starts from once this motor is initialized.
+    uint16_t initialEncoderWrapped;
 
-    tap::arch::MilliTimeout motorDisconnectTimeout;
+    /// @see `initialEncoderWrapped`.
+    int64_t initialEncoderRevolutions;
 };
 
 }  // namespace tap::motor
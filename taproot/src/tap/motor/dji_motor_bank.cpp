@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dji_motor_bank.hpp"
+
+#include "tap/architecture/clock.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::motor
+{
+void DjiMotorBank::registerMotor(
+    int slot,
+    const DjiMotor* motor,
+    bool inverted,
+    uint16_t encoderWrapped,
+    int64_t encoderRevolutions)
+{
+    uint8_t bit = 1 << slot;
+    registeredMask |= bit;
+    invertedMask = inverted ? (invertedMask | bit) : (invertedMask & ~bit);
+    receivedMask &= ~bit;
+
+    motors[slot] = motor;
+    this->encoderWrapped[slot] = encoderWrapped;
+    this->encoderRevolutions[slot] = encoderRevolutions;
+    shaftRPM[slot] = 0;
+    torque[slot] = 0;
+    temperature[slot] = 0;
+    feedbackHistory[slot].clear();
+    velocityEstimators[slot].reset();
+    commandLatency[slot].reset();
+}
+
+void DjiMotorBank::unregisterMotor(int slot)
+{
+    uint8_t bit = 1 << slot;
+    registeredMask &= ~bit;
+    receivedMask &= ~bit;
+    motors[slot] = nullptr;
+}
+
+bool DjiMotorBank::decode(const modm::can::Message& message, uint32_t timestamp)
+{
+    int slot = slotForCanId(message.getIdentifier());
+    if (slot < 0 || slot >= NUM_MOTORS || !isRegistered(slot))
+    {
+        return false;
+    }
+
+    const uint8_t* data = message.data;
+    bool inverted = (invertedMask >> slot) & 1;
+    uint16_t encoderActual = static_cast<uint16_t>(data[0] << 8 | data[1]);
+    int16_t rpm = static_cast<int16_t>(data[2] << 8 | data[3]);
+    int16_t rawTorque = static_cast<int16_t>(data[4] << 8 | data[5]);
+
+    // Latency is measured against the raw values sent to and received from the motor
+    commandLatency[slot].onFeedback(rawTorque, timestamp);
+
+    shaftRPM[slot] = inverted ? -rpm : rpm;
+    torque[slot] = inverted ? -rawTorque : rawTorque;
+    temperature[slot] = static_cast<int8_t>(data[6]);
+    lastFeedbackTime[slot] = tap::arch::clock::getTimeMilliseconds();
+    receivedMask |= 1 << slot;
+
+    // Unwrap the encoder, counting a revolution when it jumps by more than half of one
+    encoderActual = inverted ? ENC_RESOLUTION - 1 - encoderActual : encoderActual;
+    int16_t encoderDiff = encoderActual - encoderWrapped[slot];
+    if (encoderDiff < -ENC_RESOLUTION / 2)
+    {
+        encoderRevolutions[slot]++;
+    }
+    else if (encoderDiff > ENC_RESOLUTION / 2)
+    {
+        encoderRevolutions[slot]--;
+    }
+    encoderWrapped[slot] = encoderActual;
+
+    feedbackHistory[slot].push(
+        {timestamp, getEncoderUnwrapped(slot), shaftRPM[slot], torque[slot]});
+    velocityEstimators[slot].update(feedbackHistory[slot]);
+
+    return true;
+}
+
+bool DjiMotorBank::isOnline(int slot) const
+{
+    return ((receivedMask >> slot) & 1) &&
+           tap::arch::clock::getTimeMilliseconds() - lastFeedbackTime[slot] <
+               MOTOR_DISCONNECT_TIME;
+}
+}  // namespace tap::motor
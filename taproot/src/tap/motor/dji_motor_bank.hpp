@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DJI_MOTOR_BANK_HPP_
+#define DJI_MOTOR_BANK_HPP_
+
+#include <cstdint>
+
+#include "command_latency_tracker.hpp"
+#include "encoder_velocity_estimator.hpp"
+#include "motor_feedback_history.hpp"
+
+namespace modm::can
+{
+class Message;
+}
+
+namespace tap::motor
+{
+class DjiMotor;
+
+/**
+ * Feedback state of the (up to 8) DJI motors on one CAN bus, kept in contiguous arrays indexed
+ * by normalized motor ID (0 for 0x201, up to 7 for 0x208).
+ *
+ * `CanRxHandler` decodes DJI feedback frames straight into the bank of their bus, without
+ * dispatching to the `DjiMotor` listening for them, and `DjiMotor` reads its state back from
+ * the bank. A refresh that reads all motors of a bus touches a few cache lines rather than
+ * eight separate `DjiMotor` objects.
+ *
+ * Only slots claimed with `registerMotor` (done by `DjiMotor::initialize`) are decoded into.
+ */
+class DjiMotorBank
+{
+public:
+    static constexpr int NUM_MOTORS = 8;
+
+    /// Feedback ID of the motor in slot 0, motor `i` sends feedback with ID 0x201 + `i`.
+    static constexpr uint32_t FIRST_FEEDBACK_ID = 0x201;
+
+    /// Wait time before a motor is considered disconnected, in milliseconds.
+    static constexpr uint32_t MOTOR_DISCONNECT_TIME = 100;
+
+    static constexpr uint16_t ENC_RESOLUTION = 8192;
+
+    /**
+     * @return The slot of the motor sending feedback with `canId`, or a value outside
+     *      [0, `NUM_MOTORS`) if it isn't a DJI feedback ID.
+     */
+    static inline int slotForCanId(uint32_t canId)
+    {
+        return static_cast<int>(canId) - static_cast<int>(FIRST_FEEDBACK_ID);
+    }
+
+    /**
+     * Claims `slot` for `motor`, starting its encoder from `encoderWrapped` and
+     * `encoderRevolutions` and marking it offline until its first feedback frame.
+     */
+    void registerMotor(
+        int slot,
+        const DjiMotor* motor,
+        bool inverted,
+        uint16_t encoderWrapped,
+        int64_t encoderRevolutions);
+
+    void unregisterMotor(int slot);
+
+    bool isRegistered(int slot) const { return (registeredMask >> slot) & 1; }
+
+    /**
+     * Decodes `message` if it is the feedback of a registered motor.
+     *
+     * @param[in] timestamp when the frame was received, in microseconds.
+     * @return `true` if the message was decoded.
+     */
+    bool decode(const modm::can::Message& message, uint32_t timestamp);
+
+    bool isOnline(int slot) const;
+
+    uint16_t getEncoderWrapped(int slot) const { return encoderWrapped[slot]; }
+
+    int64_t getEncoderUnwrapped(int slot) const
+    {
+        return static_cast<int64_t>(encoderWrapped[slot]) +
+               static_cast<int64_t>(ENC_RESOLUTION) * encoderRevolutions[slot];
+    }
+
+    int16_t getShaftRPM(int slot) const { return shaftRPM[slot]; }
+
+    int16_t getTorque(int slot) const { return torque[slot]; }
+
+    int8_t getTemperature(int slot) const { return temperature[slot]; }
+
+    const MotorFeedbackHistory& getFeedbackHistory(int slot) const
+    {
+        return feedbackHistory[slot];
+    }
+
+    const EncoderVelocityEstimator& getVelocityEstimator(int slot) const
+    {
+        return velocityEstimators[slot];
+    }
+
+    void setVelocityEstimator(int slot, const EncoderVelocityEstimator::Config& config)
+    {
+        velocityEstimators[slot].setConfig(config);
+    }
+
+    const CommandLatencyTracker& getCommandLatency(int slot) const { return commandLatency[slot]; }
+
+    /**
+     * @param[in] command the raw output sent to the motor.
+     * @param[in] time when the command frame was queued, in microseconds.
+     */
+    void recordCommandSent(int slot, int16_t command, uint32_t time)
+    {
+        commandLatency[slot].onCommandSent(command, time);
+    }
+
+    void resetCommandLatency(int slot) { commandLatency[slot].reset(); }
+
+    /// @return The motor registered in `slot`, or `nullptr`.
+    const DjiMotor* getMotor(int slot) const { return motors[slot]; }
+
+private:
+    uint8_t registeredMask = 0;
+    uint8_t invertedMask = 0;
+    /// Set for motors that sent feedback since they were registered.
+    uint8_t receivedMask = 0;
+
+    uint16_t encoderWrapped[NUM_MOTORS] = {};
+    int16_t shaftRPM[NUM_MOTORS] = {};
+    int16_t torque[NUM_MOTORS] = {};
+    int8_t temperature[NUM_MOTORS] = {};
+    /// Time of the last feedback frame, in milliseconds, for the online state.
+    uint32_t lastFeedbackTime[NUM_MOTORS] = {};
+    /**
+     * Absolute unwrapped encoder position =
+     *      encoderRevolutions * ENC_RESOLUTION + encoderWrapped
+     * This lets us keep track of some sense of absolute position even while
+     * raw encoderValue continuosly loops within {0..8191}. Origin value is
+     * arbitrary.
+     */
+    int64_t encoderRevolutions[NUM_MOTORS] = {};
+
+    MotorFeedbackHistory feedbackHistory[NUM_MOTORS];
+    EncoderVelocityEstimator velocityEstimators[NUM_MOTORS];
+    CommandLatencyTracker commandLatency[NUM_MOTORS];
+
+    const DjiMotor* motors[NUM_MOTORS] = {};
+};  // class DjiMotorBank
+
+}  // namespace tap::motor
+
+#endif  // DJI_MOTOR_BANK_HPP_
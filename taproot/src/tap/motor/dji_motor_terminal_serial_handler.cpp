@@ -49,6 +49,7 @@ bool DjiMotorTerminalSerialHandler::terminalSerialCallback(
     motorIdValid = false;
     canBus = 0;
     printAll = false;
+    printLatency = false;
     while (
         (arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine)))
     {
@@ -89,6 +90,16 @@ bool DjiMotorTerminalSerialHandler::terminalSerialCallback(
             }
             canBusValid = true;
         }
+        else if (strcmp(arg, "latency") == 0)
+        {
+            printLatency = true;
+        }
+        else if (strcmp(arg, "latencyoff") == 0)
+        {
+            drivers->djiMotorTxHandler.setLatencyMeasurementEnabled(false);
+            outputStream << "motorinfo: latency measurement stopped" << modm::endl;
+            return false;
+        }
         else if (strcmp(arg, "all") == 0)
         {
             printAll = true;
@@ -116,6 +127,11 @@ bool DjiMotorTerminalSerialHandler::terminalSerialCallback(
         return false;
     }
 
+    if (printLatency)
+    {
+        drivers->djiMotorTxHandler.setLatencyMeasurementEnabled(true);
+    }
+
     return printInfo(outputStream);
 }
 
@@ -187,7 +203,11 @@ void DjiMotorTerminalSerialHandler::getMotorInfoToString(
     const DjiMotor* motor,
     modm::IOStream& outputStream)
 {
-    if (motor != nullptr)
+    if (printLatency)
+    {
+        getMotorLatencyToString(motor, outputStream);
+    }
+    else if (motor != nullptr)
     {
         outputStream << (DJI_MOTOR_NORMALIZED_ID(motor->getMotorIdentifier()) + 1) << ". "
                      << motor->getName() << ": online: " << (motor->isMotorOnline() ? "yes" : "no")
@@ -196,6 +216,22 @@ void DjiMotorTerminalSerialHandler::getMotorInfoToString(
     }
 }
 
+void DjiMotorTerminalSerialHandler::getMotorLatencyToString(
+    const DjiMotor* motor,
+    modm::IOStream& outputStream)
+{
+    if (motor != nullptr)
+    {
+        const CommandLatencyTracker& latency = motor->getCommandLatency();
+        const CommandLatencyTracker::Histogram& histogram = latency.getHistogram();
+        outputStream << (DJI_MOTOR_NORMALIZED_ID(motor->getMotorIdentifier()) + 1) << ". "
+                     << motor->getName() << ": latency: " << histogram.getMin() << "/"
+                     << histogram.percentile(0.5f) << "/" << histogram.percentile(0.99f) << "/"
+                     << histogram.getMax() << ", samples: " << histogram.getCount()
+                     << ", timeouts: " << latency.getTimeouts() << modm::endl;
+    }
+}
+
 void DjiMotorTerminalSerialHandler::printAllMotorInfo(
     getMotorByIdFunc func,
     modm::IOStream& outputStream)
@@ -51,13 +51,16 @@ private:
     typedef DjiMotor const* (DjiMotorTxHandler::*getMotorByIdFunc)(MotorId);
 
     static constexpr char USAGE[] =
-        "Usage: motorinfo <[-H] | [all] | [motor [mid]] [can [cid]]>\n"
+        "Usage: motorinfo <[-H] | [latencyoff] | [latency] <[all] | [motor [mid]] [can [cid]]>>\n"
         "  Where:\n"
         "    - [-H]  prints usage\n"
         "    - [all] prints all motor info\n"
         "    Or specifiy a motor id and/or can id, where\n"
         "    - [mid] is the id of a motor, in [1, 8]\n"
-        "    - [cid] is some the can id, in [1, 2]\n";
+        "    - [cid] is some the can id, in [1, 2]\n"
+        "    - [latency] prints the command-to-feedback latency of the motors instead\n"
+        "      (min/p50/p99/max, in us), starting the measurement if it isn't running\n"
+        "    - [latencyoff] stops measuring command-to-feedback latency\n";
 
     Drivers* drivers;
 
@@ -66,11 +69,14 @@ private:
     bool canBusValid = false;
     int canBus = 0;
     bool printAll = false;
+    bool printLatency = false;
 
     bool printInfo(modm::IOStream& outputStream);
 
     void getMotorInfoToString(const DjiMotor* motor, modm::IOStream& outputStream);
 
+    void getMotorLatencyToString(const DjiMotor* motor, modm::IOStream& outputStream);
+
     void printAllMotorInfo(getMotorByIdFunc func, modm::IOStream& outputStream);
 };  // class DjiMotorTerminalSerialHandler
 }  // namespace motor
@@ -20,6 +20,7 @@
 #include "dji_motor_tx_handler.hpp"
 
 #include "tap/algorithms/math_user_utils.hpp"
+#include "tap/architecture/clock.hpp"
 #include "tap/drivers.hpp"
 #include "tap/errors/create_errors.hpp"
 
@@ -37,11 +38,12 @@ namespace motor
 void DjiMotorTxHandler::addMotorToManager(DjiMotor** canMotorStore, DjiMotor* const motor)
 {
     int16_t idIndex = DJI_MOTOR_NORMALIZED_ID(motor->getMotorIdentifier());
-    bool motorOverloaded = canMotorStore[idIndex] != nullptr;
     bool motorOutOfBounds = (idIndex < 0) || (idIndex >= DJI_MOTORS_PER_CAN);
+    bool motorOverloaded = !motorOutOfBounds && canMotorStore[idIndex] != nullptr;
     // kill start
     modm_assert(!motorOverloaded && !motorOutOfBounds, "DjiMotorTxHandler:can", "overloading", 1);
     canMotorStore[idIndex] = motor;
+    motorsPerTxFrame[txFrameIndex(motor->getCanBus(), isInHighFrame(idIndex))]++;
 }
 
 void DjiMotorTxHandler::addMotorToManager(DjiMotor* motor)
@@ -61,41 +63,102 @@ void DjiMotorTxHandler::addMotorToManager(DjiMotor* motor)
 
 void DjiMotorTxHandler::processCanSendData()
 {
-    // set up new can messages to be sent via CAN bus 1 and 2
-    modm::can::Message can1MessageLow(CAN_DJI_LOW_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-    can1MessageLow.setExtended(false);
+    sendTxFrames(
+        ALL_TX_FRAMES & ~drivers->motorInnerLoop.getOwnedTxFrames(),
+        drivers->commandScheduler.getRunPeriod());
+}
 
-    modm::can::Message can1MessageHigh(CAN_DJI_HIGH_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-    can1MessageHigh.setExtended(false);
+void DjiMotorTxHandler::sendTxFrames(uint8_t frameMask, uint32_t maxAge)
+{
+    static constexpr can::CanBus FRAME_BUSES[NUM_TX_FRAMES] = {
+        can::CanBus::CAN_BUS1,
+        can::CanBus::CAN_BUS1,
+        can::CanBus::CAN_BUS2,
+        can::CanBus::CAN_BUS2};
+
+    // set up new can messages to be sent via CAN bus 1 and 2, indexed by txFrameIndex
+    modm::can::Message messages[NUM_TX_FRAMES];
+    for (int frame = 0; frame < NUM_TX_FRAMES; frame++)
+    {
+        bool highFrame = frame % 2 == 1;
+        messages[frame] = modm::can::Message(
+            highFrame ? CAN_DJI_HIGH_IDENTIFIER : CAN_DJI_LOW_IDENTIFIER,
+            CAN_DJI_MESSAGE_SEND_LENGTH);
+        messages[frame].setExtended(false);
+        zeroTxMessage(&messages[frame]);
+    }
 
-    modm::can::Message can2MessageLow(CAN_DJI_LOW_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-    can2MessageLow.setExtended(false);
+    serializeMotorStoreSendData(can1MotorStore, &messages[0], &messages[1]);
+    serializeMotorStoreSendData(can2MotorStore, &messages[2], &messages[3]);
 
-    modm::can::Message can2MessageHigh(CAN_DJI_HIGH_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-    can2MessageHigh.setExtended(false);
+    // Frames without motors, or not selected, are never sent. Nothing frees up queue space
+    // within this call, so frames whose queue is full are not retried, the next send supersedes
+    // them.
+    for (int frame = 0; frame < NUM_TX_FRAMES; frame++)
+    {
+        if (((frameMask >> frame) & 1) == 0)
+        {
+            continue;
+        }
+        txFrameStats[frame].lastSent = false;
+        if (motorsPerTxFrame[frame] > 0 &&
+            !trySendMessage(frame, FRAME_BUSES[frame], messages[frame], maxAge))
+        {
+            txFrameStats[frame].queueFull++;
+        }
+    }
+}
 
-    zeroTxMessage(&can1MessageLow);
-    zeroTxMessage(&can1MessageHigh);
-    zeroTxMessage(&can2MessageLow);
-    zeroTxMessage(&can2MessageHigh);
+bool DjiMotorTxHandler::trySendMessage(
+    int frame,
+    can::CanBus bus,
+    const modm::can::Message& message,
+    uint32_t maxAge)
+{
+    if (!drivers->can.queueMessage(bus, message, can::CanTxPriority::CONTROL, maxAge))
+    {
+        drivers->canStats.recordTxNotReady(bus);
+        return false;
+    }
 
-    serializeMotorStoreSendData(can1MotorStore, &can1MessageLow, &can1MessageHigh);
-    serializeMotorStoreSendData(can2MotorStore, &can2MessageLow, &can2MessageHigh);
+    txFrameStats[frame].sent++;
+    txFrameStats[frame].lastSent = true;
 
-    bool messageFailure = false;
-    if (drivers->can.isReadyToSend(can::CanBus::CAN_BUS1))
+    if (latencyMeasurement)
     {
-        messageFailure |= drivers->can.sendMessage(can::CanBus::CAN_BUS1, can1MessageLow);
-        messageFailure |= drivers->can.sendMessage(can::CanBus::CAN_BUS1, can1MessageHigh);
+        recordCommandsSent(frame, tap::arch::clock::getTimeMicroseconds());
     }
-    if (drivers->can.isReadyToSend(can::CanBus::CAN_BUS2))
+    return true;
+}
+
+void DjiMotorTxHandler::setLatencyMeasurementEnabled(bool enabled)
+{
+    if (enabled && !latencyMeasurement)
     {
-        messageFailure |= drivers->can.sendMessage(can::CanBus::CAN_BUS2, can2MessageLow);
-        messageFailure |= drivers->can.sendMessage(can::CanBus::CAN_BUS2, can2MessageHigh);
+        for (int i = 0; i < DJI_MOTORS_PER_CAN; i++)
+        {
+            for (DjiMotor* motor : {can1MotorStore[i], can2MotorStore[i]})
+            {
+                if (motor != nullptr)
+                {
+                    motor->resetCommandLatency();
+                }
+            }
+        }
     }
-    if (messageFailure)
+    latencyMeasurement = enabled;
+}
+
+void DjiMotorTxHandler::recordCommandsSent(int frame, uint32_t time)
+{
+    DjiMotor** motorStore = frame < NUM_TX_FRAMES / 2 ? can1MotorStore : can2MotorStore;
+    bool highFrame = frame % 2 == 1;
+    for (int i = 0; i < DJI_MOTORS_PER_CAN; i++)
     {
-        RAISE_ERROR(drivers, "sendMessage failure");
+        if (motorStore[i] != nullptr && isInHighFrame(i) == highFrame)
+        {
+            motorStore[i]->recordCommandSent(time);
+        }
     }
 }
 
@@ -109,14 +172,7 @@ void DjiMotorTxHandler::serializeMotorStoreSendData(
         const DjiMotor* const motor = canMotorStore[i];
         if (motor != nullptr)
         {
-            if (motor->getMotorIdentifier() - 0x200 <= 4)
-            {
-                motor->serializeCanSendData(messageLow);
-            }
-            else
-            {
-                motor->serializeCanSendData(messageHigh);
-            }
+            motor->serializeCanSendData(isInHighFrame(i) ? messageHigh : messageLow);
         }
     }
 }
@@ -143,6 +199,7 @@ void DjiMotorTxHandler::removeFromMotorManager(const DjiMotor& motor, DjiMotor**
         return;
     }
     motorStore[id] = nullptr;
+    motorsPerTxFrame[txFrameIndex(motor.getCanBus(), isInHighFrame(id))]--;
 }
 
 void DjiMotorTxHandler::zeroTxMessage(modm::can::Message* message)
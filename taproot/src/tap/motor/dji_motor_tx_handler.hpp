@@ -39,7 +39,12 @@
  * function. This adds the motor to a queue of receive message handlers
  * that is updated by calling the pollCanData function.
  *
- * To send messages, call processCanSendMessage.
+ * To send messages, call processCanSendData. Motors 1-4 of a bus are commanded with the 0x200
+ * frame and motors 5-8 with the 0x1FF frame, and only frames that command at least one
+ * registered motor are sent. They are queued in the `CanTxPriority::CONTROL` class, ahead of
+ * any other traffic, and dropped if not sent within one period of their sender, after which
+ * the next command supersedes them. Frames commanding a motor with a `MotorInnerLoopService`
+ * loop are left to that service, which sends them as the loops update.
  *
  * Currently, no error handling is implemented if you attempt to use
  * a motor without initialization. This must be implemented when
@@ -69,6 +74,25 @@ class DjiMotorTxHandler
 public:
     static constexpr int DJI_MOTORS_PER_CAN = 8;
 
+    /// The 0x200 and 0x1FF command frames of both buses.
+    static constexpr int NUM_TX_FRAMES = 4;
+
+    /**
+     * Send statistics of a single command frame.
+     */
+    struct TxFrameStats
+    {
+        /// Number of times the frame was queued to be sent.
+        uint32_t sent = 0;
+        /**
+         * Number of times the frame was not queued because the bus's `CanTxPriority::CONTROL`
+         * queue was full. It is not retried, the next send supersedes it.
+         */
+        uint32_t queueFull = 0;
+        /// Whether the frame was queued by the last send that selected it.
+        bool lastSent = false;
+    };
+
     DjiMotorTxHandler(Drivers* drivers) : drivers(drivers) {}
     mockable ~DjiMotorTxHandler() = default;
     DISALLOW_COPY_AND_ASSIGN(DjiMotorTxHandler)
@@ -77,20 +101,94 @@ public:
     // and checks to make sure the motor is not already being used.
     mockable void addMotorToManager(DjiMotor* motor);
 
+    /**
+     * Sends every occupied command frame except those owned by `MotorInnerLoopService` loops.
+     * Call once per control pass, frames are dropped if not sent within the command scheduler's
+     * run period.
+     */
     mockable void processCanSendData();
 
+    /// `sendTxFrames` mask selecting every frame.
+    static constexpr uint8_t ALL_TX_FRAMES = (1 << NUM_TX_FRAMES) - 1;
+
+    /**
+     * Sends the occupied command frames selected by `frameMask`, as `processCanSendData` does for
+     * all of them. Used to send commands of `MotorInnerLoopService` loops as soon as they are
+     * updated without resending every other frame.
+     *
+     * @param[in] frameMask bit `txFrameBit(...)` set for each frame to send.
+     * @param[in] maxAge the time after which a queued frame is dropped rather than sent, in
+     *      microseconds. The sender's period, after which its next command supersedes it.
+     */
+    mockable void sendTxFrames(uint8_t frameMask, uint32_t maxAge);
+
+    /**
+     * @return The `sendTxFrames` mask bit of the frame commanding `motor`.
+     */
+    static inline uint8_t txFrameBit(const DjiMotor& motor)
+    {
+        int motorIndex = DJI_MOTOR_NORMALIZED_ID(motor.getMotorIdentifier());
+        return 1 << txFrameIndex(motor.getCanBus(), isInHighFrame(motorIndex));
+    }
+
     mockable void removeFromMotorManager(const DjiMotor& motor);
 
     mockable DjiMotor const* getCan1Motor(MotorId motorId);
 
     mockable DjiMotor const* getCan2Motor(MotorId motorId);
 
+    /**
+     * @param[in] bus the bus the frame is sent on.
+     * @param[in] highFrame `false` for the 0x200 frame (motors 1-4), `true` for the 0x1FF frame
+     *      (motors 5-8).
+     * @return Whether the frame commands any registered motor, and so is sent.
+     */
+    mockable bool isTxFrameOccupied(can::CanBus bus, bool highFrame) const
+    {
+        return motorsPerTxFrame[txFrameIndex(bus, highFrame)] > 0;
+    }
+
+    /**
+     * @see `isTxFrameOccupied` for the parameters.
+     */
+    mockable const TxFrameStats& getTxFrameStats(can::CanBus bus, bool highFrame) const
+    {
+        return txFrameStats[txFrameIndex(bus, highFrame)];
+    }
+
+    /**
+     * Enables timestamping command frames for each motor they command, so that the motors
+     * measure their command-to-feedback latency, see `DjiMotor::getCommandLatency`. Enabling
+     * measurement clears the latencies measured so far.
+     */
+    mockable void setLatencyMeasurementEnabled(bool enabled);
+
+    mockable bool isLatencyMeasurementEnabled() const { return latencyMeasurement; }
+
 private:
     Drivers* drivers;
 
+    bool latencyMeasurement = false;
+
     DjiMotor* can1MotorStore[DJI_MOTORS_PER_CAN] = {0};
     DjiMotor* can2MotorStore[DJI_MOTORS_PER_CAN] = {0};
 
+    /// Number of registered motors commanded by each frame, kept up to date on registration.
+    uint8_t motorsPerTxFrame[NUM_TX_FRAMES] = {};
+
+    TxFrameStats txFrameStats[NUM_TX_FRAMES];
+
+    static inline int txFrameIndex(can::CanBus bus, bool highFrame)
+    {
+        return (bus == can::CanBus::CAN_BUS1 ? 0 : 2) + (highFrame ? 1 : 0);
+    }
+
+    /// @return Whether the motor at `motorIndex` (in [0, 8)) is commanded by the 0x1FF frame.
+    static inline bool isInHighFrame(int motorIndex)
+    {
+        return motorIndex >= DJI_MOTORS_PER_CAN / 2;
+    }
+
     void addMotorToManager(DjiMotor** canMotorStore, DjiMotor* const motor);
 
     void serializeMotorStoreSendData(
@@ -101,6 +199,21 @@ private:
     void removeFromMotorManager(const DjiMotor& motor, DjiMotor** motorStore);
 
     void zeroTxMessage(modm::can::Message* message);
+
+    /**
+     * Queues `message` on `bus`, recording the result in the frame's `TxFrameStats` and full
+     * transmit queues in `drivers->canStats`.
+     *
+     * @return `false` if the transmit queue was full.
+     */
+    bool trySendMessage(
+        int frame,
+        can::CanBus bus,
+        const modm::can::Message& message,
+        uint32_t maxAge);
+
+    /// Notifies the motors commanded by `frame` that it was queued at `time`.
+    void recordCommandsSent(int frame, uint32_t time);
 };
 
 }  // namespace motor
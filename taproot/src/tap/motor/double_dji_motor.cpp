@@ -103,4 +103,9 @@ int16_t DoubleDjiMotor::getShaftRPM() const
             static_cast<int32_t>(motorTwo.getShaftRPM())) /
            2;
 }
+
+float DoubleDjiMotor::getEncoderVelocity() const
+{
+    return (motorOne.getEncoderVelocity() + motorTwo.getEncoderVelocity()) / 2;
+}
 }  // namespace tap::motor
@@ -62,6 +62,7 @@ public:
     int8_t getTemperature() const override;
     int16_t getTorque() const override;
     int16_t getShaftRPM() const override;
+    float getEncoderVelocity() const override;
 
 private:
 #if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
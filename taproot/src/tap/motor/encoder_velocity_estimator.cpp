@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "encoder_velocity_estimator.hpp"
+
+#include "tap/algorithms/math_user_utils.hpp"
+
+namespace tap
+{
+namespace motor
+{
+void EncoderVelocityEstimator::setConfig(const Config &config)
+{
+    this->config = config;
+    this->config.window =
+        tap::algorithms::limitVal<int>(config.window, 2, MotorFeedbackHistory::SIZE);
+    reset();
+}
+
+void EncoderVelocityEstimator::reset()
+{
+    velocity = 0;
+    acceleration = 0;
+    positionOffset = 0;
+    initialized = false;
+}
+
+void EncoderVelocityEstimator::update(const MotorFeedbackHistory &history)
+{
+    if (history.size() == 0)
+    {
+        return;
+    }
+
+    uint32_t timestamp = history.get(0).timestamp;
+    if (initialized && timestamp == lastTimestamp)
+    {
+        return;
+    }
+
+    switch (config.type)
+    {
+        case Type::FINITE_DIFFERENCE:
+            updateFiniteDifference(history);
+            break;
+        case Type::LEAST_SQUARES:
+            updateLeastSquares(history);
+            break;
+        case Type::ALPHA_BETA:
+            // The tracker starts from the first sample it sees
+            if (initialized)
+            {
+                updateAlphaBeta(history);
+            }
+            break;
+    }
+
+    lastTimestamp = timestamp;
+    initialized = true;
+}
+
+/// @return The time from `older` to `newer`, in seconds.
+static inline float secondsBetween(
+    const MotorFeedbackSample &newer,
+    const MotorFeedbackSample &older)
+{
+    return static_cast<float>(static_cast<int32_t>(newer.timestamp - older.timestamp)) * 1E-6f;
+}
+
+void EncoderVelocityEstimator::updateFiniteDifference(const MotorFeedbackHistory &history)
+{
+    if (history.size() < 2)
+    {
+        return;
+    }
+
+    const MotorFeedbackSample &s0 = history.get(0);
+    const MotorFeedbackSample &s1 = history.get(1);
+    float dt0 = secondsBetween(s0, s1);
+    if (dt0 <= 0)
+    {
+        return;
+    }
+    velocity = static_cast<float>(s0.encoderUnwrapped - s1.encoderUnwrapped) / dt0;
+
+    if (history.size() >= 3)
+    {
+        const MotorFeedbackSample &s2 = history.get(2);
+        float dt1 = secondsBetween(s1, s2);
+        if (dt1 > 0)
+        {
+            float previousVelocity =
+                static_cast<float>(s1.encoderUnwrapped - s2.encoderUnwrapped) / dt1;
+            acceleration = (velocity - previousVelocity) / ((dt0 + dt1) / 2);
+        }
+    }
+}
+
+void EncoderVelocityEstimator::updateLeastSquares(const MotorFeedbackHistory &history)
+{
+    int n = history.size() < config.window ? history.size() : config.window;
+    if (n < 2)
+    {
+        return;
+    }
+
+    // Fit y = a + b * x + c * x^2 where x is the time relative to the newest sample, in ms to keep
+    // the sums well conditioned in single precision, and y the encoder relative to the newest
+    // sample.
+    const MotorFeedbackSample &newest = history.get(0);
+    float s1 = 0, s2 = 0, s3 = 0, s4 = 0, t0 = 0, t1 = 0, t2 = 0;
+    for (int i = 0; i < n; i++)
+    {
+        const MotorFeedbackSample &sample = history.get(i);
+        float x = -secondsBetween(newest, sample) * 1E3f;
+        float y = static_cast<float>(sample.encoderUnwrapped - newest.encoderUnwrapped);
+        float x2 = x * x;
+        s1 += x;
+        s2 += x2;
+        s3 += x2 * x;
+        s4 += x2 * x2;
+        t0 += y;
+        t1 += x * y;
+        t2 += x2 * y;
+    }
+    float s0 = static_cast<float>(n);
+
+    if (n >= 3)
+    {
+        float det = s0 * (s2 * s4 - s3 * s3) - s1 * (s1 * s4 - s3 * s2) + s2 * (s1 * s3 - s2 * s2);
+        if (!tap::algorithms::compareFloatClose(det, 0.0f, 1E-6f))
+        {
+            float b = (s0 * (t1 * s4 - s3 * t2) - t0 * (s1 * s4 - s3 * s2) +
+                       s2 * (s1 * t2 - t1 * s2)) /
+                      det;
+            float c = (s0 * (s2 * t2 - t1 * s3) - s1 * (s1 * t2 - t1 * s2) +
+                       t0 * (s1 * s3 - s2 * s2)) /
+                      det;
+            velocity = b * 1E3f;
+            acceleration = 2 * c * 1E6f;
+            return;
+        }
+    }
+
+    // Too few samples (or timestamps too close together) for a parabola, fit a line
+    float det = s0 * s2 - s1 * s1;
+    if (!tap::algorithms::compareFloatClose(det, 0.0f, 1E-6f))
+    {
+        velocity = (s0 * t1 - s1 * t0) / det * 1E3f;
+        acceleration = 0;
+    }
+}
+
+void EncoderVelocityEstimator::updateAlphaBeta(const MotorFeedbackHistory &history)
+{
+    if (history.size() < 2)
+    {
+        return;
+    }
+
+    const MotorFeedbackSample &s0 = history.get(0);
+    const MotorFeedbackSample &s1 = history.get(1);
+    float dt = secondsBetween(s0, s1);
+    if (dt <= 0)
+    {
+        return;
+    }
+
+    // Predict the new position relative to the previous sample and correct with the residual.
+    // The estimated position is kept relative to the newest sample so that it stays small.
+    float predicted = positionOffset + velocity * dt + acceleration * dt * dt / 2;
+    float residual = static_cast<float>(s0.encoderUnwrapped - s1.encoderUnwrapped) - predicted;
+
+    positionOffset = (config.alpha - 1) * residual;
+    velocity += acceleration * dt + config.beta * residual / dt;
+    acceleration += 2 * config.gamma * residual / (dt * dt);
+}
+}  // namespace motor
+
+}  // namespace tap
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENCODER_VELOCITY_ESTIMATOR_HPP_
+#define ENCODER_VELOCITY_ESTIMATOR_HPP_
+
+#include <cstdint>
+
+#include "motor_feedback_history.hpp"
+
+namespace tap
+{
+namespace motor
+{
+/**
+ * Estimates the velocity and acceleration of a motor from the timestamped unwrapped encoder
+ * values in its `MotorFeedbackHistory`, in encoder ticks per second (squared). Unlike the RPM
+ * reported by DJI motor controllers, the estimate uses microsecond receive timestamps and
+ * resolves speeds down to a single encoder tick per window.
+ *
+ * `update` should be called once after every sample pushed to the history. Samples with the
+ * same timestamp as the previous one are ignored.
+ */
+class EncoderVelocityEstimator
+{
+public:
+    enum class Type : uint8_t
+    {
+        /**
+         * Difference of the two newest samples. No lag but the noisiest, acceleration is the
+         * difference of the last two velocities.
+         */
+        FINITE_DIFFERENCE,
+        /**
+         * Least squares fit of a parabola to the newest `window` samples, evaluated at the
+         * newest sample, or a line with no acceleration for a window of 2. Lags about half the
+         * window for changing acceleration.
+         */
+        LEAST_SQUARES,
+        /**
+         * Alpha-beta(-gamma) tracker, predicting each sample from the previous estimate and
+         * correcting with the `alpha`, `beta` and `gamma` gains. With `gamma == 0` it is a plain
+         * alpha-beta tracker and acceleration is always 0.
+         */
+        ALPHA_BETA,
+    };
+
+    struct Config
+    {
+        Type type = Type::LEAST_SQUARES;
+        /// Number of samples fit with `LEAST_SQUARES`, in [2, `MotorFeedbackHistory::SIZE`].
+        int window = 4;
+        float alpha = 0.5f;
+        float beta = 0.1f;
+        float gamma = 0.0f;
+    };
+
+    EncoderVelocityEstimator() = default;
+    explicit EncoderVelocityEstimator(const Config &config) { setConfig(config); }
+
+    /// Resets the estimate, the window is clamped to the size of the history.
+    void setConfig(const Config &config);
+
+    const Config &getConfig() const { return config; }
+
+    void update(const MotorFeedbackHistory &history);
+
+    /// @return Estimated velocity, in encoder ticks per second.
+    float getVelocity() const { return velocity; }
+
+    /// @return Estimated acceleration, in encoder ticks per second squared.
+    float getAcceleration() const { return acceleration; }
+
+    void reset();
+
+private:
+    Config config;
+
+    float velocity = 0;
+    float acceleration = 0;
+
+    /// Timestamp of the newest sample used, to skip repeated updates.
+    uint32_t lastTimestamp = 0;
+    bool initialized = false;
+
+    /// Alpha-beta tracker state, the estimated position relative to the newest sample.
+    float positionOffset = 0;
+
+    void updateFiniteDifference(const MotorFeedbackHistory &history);
+
+    void updateLeastSquares(const MotorFeedbackHistory &history);
+
+    void updateAlphaBeta(const MotorFeedbackHistory &history);
+};  // class EncoderVelocityEstimator
+
+}  // namespace motor
+
+}  // namespace tap
+
+#endif  // ENCODER_VELOCITY_ESTIMATOR_HPP_
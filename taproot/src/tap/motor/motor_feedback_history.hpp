@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOTOR_FEEDBACK_HISTORY_HPP_
+#define MOTOR_FEEDBACK_HISTORY_HPP_
+
+#include <cstdint>
+
+namespace tap
+{
+namespace motor
+{
+/**
+ * A motor feedback frame, as recorded by `MotorFeedbackHistory`.
+ */
+struct MotorFeedbackSample
+{
+    /// When the frame was received, in microseconds.
+    uint32_t timestamp;
+    int64_t encoderUnwrapped;
+    int16_t shaftRPM;
+    int16_t torque;
+};
+
+/**
+ * Fixed size ring of the most recent feedback samples of a motor, overwriting the oldest sample
+ * once full.
+ */
+class MotorFeedbackHistory
+{
+public:
+    /// The number of samples kept, 8 ms worth at the 1 kHz DJI feedback rate.
+    static constexpr int SIZE = 8;
+
+    void push(const MotorFeedbackSample &sample)
+    {
+        newest = (newest + 1) % SIZE;
+        samples[newest] = sample;
+        if (count < SIZE)
+        {
+            count++;
+        }
+    }
+
+    /// @return The number of samples held, at most `SIZE`.
+    int size() const { return count; }
+
+    /**
+     * @param[in] age 0 for the newest sample, up to `size() - 1` for the oldest.
+     */
+    const MotorFeedbackSample &get(int age) const
+    {
+        return samples[(newest - age + SIZE) % SIZE];
+    }
+
+    void clear() { count = 0; }
+
+private:
+    MotorFeedbackSample samples[SIZE] = {};
+    int newest = SIZE - 1;
+    int count = 0;
+};  // class MotorFeedbackHistory
+
+}  // namespace motor
+
+}  // namespace tap
+
+#endif  // MOTOR_FEEDBACK_HISTORY_HPP_
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "motor_inner_loop_service.hpp"
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+
+#include "dji_motor.hpp"
+
+namespace tap
+{
+namespace motor
+{
+bool MotorInnerLoopService::addLoop(
+    DjiMotor* motor,
+    Mode mode,
+    const algorithms::SmoothPidConfig& config)
+{
+    if (motor == nullptr || findLoop(motor) != nullptr)
+    {
+        return false;
+    }
+
+    Loop* loop = findLoop(nullptr);
+    if (loop == nullptr)
+    {
+        return false;
+    }
+
+    const MotorFeedbackHistory& history = motor->getFeedbackHistory();
+    loop->motor = motor;
+    loop->mode = mode;
+    loop->pid = algorithms::SmoothPid(config);
+    loop->velocitySetpoint = 0;
+    loop->positionSetpoint = motor->getEncoderUnwrapped();
+    loop->lastFeedbackTime = history.size() > 0 ? history.get(0).timestamp : 0;
+    loop->runCount = 0;
+    loop->outputUpdated = false;
+    return true;
+}
+
+void MotorInnerLoopService::removeLoop(const DjiMotor* motor)
+{
+    Loop* loop = findLoop(motor);
+    if (loop != nullptr)
+    {
+        loop->motor = nullptr;
+    }
+}
+
+void MotorInnerLoopService::setVelocitySetpoint(const DjiMotor* motor, float rpm)
+{
+    Loop* loop = findLoop(motor);
+    if (loop != nullptr)
+    {
+        loop->velocitySetpoint = rpm;
+    }
+}
+
+void MotorInnerLoopService::setPositionSetpoint(const DjiMotor* motor, int64_t encoder)
+{
+    Loop* loop = findLoop(motor);
+    if (loop != nullptr)
+    {
+        loop->positionSetpoint = encoder;
+    }
+}
+
+void MotorInnerLoopService::run()
+{
+    uint32_t now = arch::clock::getTimeMicroseconds();
+
+    for (Loop& loop : loops)
+    {
+        if (loop.motor != nullptr && runLoop(loop))
+        {
+            loop.outputUpdated = true;
+            uint8_t frameBit = DjiMotorTxHandler::txFrameBit(*loop.motor);
+            if ((pendingTxFrames & frameBit) == 0)
+            {
+                pendingTxFrames |= frameBit;
+                pendingSince[__builtin_ctz(frameBit)] = now;
+            }
+        }
+    }
+    if (pendingTxFrames == 0)
+    {
+        return;
+    }
+
+    // Frames still waiting for feedback from one of their online motors
+    uint8_t incompleteFrames = 0;
+    for (const Loop& loop : loops)
+    {
+        if (loop.motor != nullptr && !loop.outputUpdated && loop.motor->isMotorOnline())
+        {
+            incompleteFrames |= DjiMotorTxHandler::txFrameBit(*loop.motor);
+        }
+    }
+
+    uint8_t frameMask = 0;
+    for (int frame = 0; frame < DjiMotorTxHandler::NUM_TX_FRAMES; frame++)
+    {
+        uint8_t frameBit = 1 << frame;
+        if ((pendingTxFrames & frameBit) != 0 &&
+            ((incompleteFrames & frameBit) == 0 || now - pendingSince[frame] >= MAX_SEND_DELAY))
+        {
+            frameMask |= frameBit;
+        }
+    }
+    if (frameMask == 0)
+    {
+        return;
+    }
+
+    drivers->djiMotorTxHandler.sendTxFrames(frameMask, MAX_SEND_DELAY);
+    pendingTxFrames &= ~frameMask;
+    for (Loop& loop : loops)
+    {
+        if (loop.motor != nullptr && (DjiMotorTxHandler::txFrameBit(*loop.motor) & frameMask))
+        {
+            loop.outputUpdated = false;
+        }
+    }
+}
+
+uint8_t MotorInnerLoopService::getOwnedTxFrames() const
+{
+    uint8_t frameMask = 0;
+    // Loops of offline motors never run again once they zeroed their output, so their frames
+    // are left to processCanSendData to keep commanding the other motors in them
+    for (const Loop& loop : loops)
+    {
+        if (loop.motor != nullptr && loop.motor->isMotorOnline())
+        {
+            frameMask |= DjiMotorTxHandler::txFrameBit(*loop.motor);
+        }
+    }
+    return frameMask;
+}
+
+bool MotorInnerLoopService::runLoop(Loop& loop)
+{
+    DjiMotor* motor = loop.motor;
+
+    // A disconnected motor sends no feedback to run the loop on, stop it instead
+    if (!motor->isMotorOnline())
+    {
+        if (motor->getOutputDesired() == 0)
+        {
+            return false;
+        }
+        loop.pid.reset();
+        motor->setDesiredOutput(0);
+        return true;
+    }
+
+    const MotorFeedbackHistory& history = motor->getFeedbackHistory();
+    if (history.get(0).timestamp == loop.lastFeedbackTime)
+    {
+        return false;
+    }
+
+    uint32_t feedbackTime = history.get(0).timestamp;
+    float dt = static_cast<float>(feedbackTime - loop.lastFeedbackTime) / 1'000.0f;
+    dt = dt < MAX_DT ? dt : MAX_DT;
+    loop.lastFeedbackTime = feedbackTime;
+    loop.runCount++;
+
+    static constexpr float TICKS_PER_SECOND_TO_RPM = 60.0f / DjiMotor::ENC_RESOLUTION;
+    float output;
+    if (loop.mode == Mode::VELOCITY)
+    {
+        float rpm = motor->getEncoderVelocity() * TICKS_PER_SECOND_TO_RPM;
+        float acceleration = motor->getEncoderAcceleration() * TICKS_PER_SECOND_TO_RPM;
+        output = loop.pid.runController(loop.velocitySetpoint - rpm, acceleration, dt);
+    }
+    else
+    {
+        float error = static_cast<float>(loop.positionSetpoint - motor->getEncoderUnwrapped());
+        output = loop.pid.runController(error, motor->getEncoderVelocity(), dt);
+    }
+    motor->setDesiredOutput(output);
+    return true;
+}
+
+uint32_t MotorInnerLoopService::getRunCount(const DjiMotor* motor) const
+{
+    const Loop* loop = findLoop(motor);
+    return loop == nullptr ? 0 : loop->runCount;
+}
+
+MotorInnerLoopService::Loop* MotorInnerLoopService::findLoop(const DjiMotor* motor)
+{
+    for (Loop& loop : loops)
+    {
+        if (loop.motor == motor)
+        {
+            return &loop;
+        }
+    }
+    return nullptr;
+}
+
+const MotorInnerLoopService::Loop* MotorInnerLoopService::findLoop(const DjiMotor* motor) const
+{
+    return const_cast<MotorInnerLoopService*>(this)->findLoop(motor);
+}
+}  // namespace motor
+
+}  // namespace tap
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOTOR_INNER_LOOP_SERVICE_HPP_
+#define MOTOR_INNER_LOOP_SERVICE_HPP_
+
+#include <cstdint>
+
+#include "tap/algorithms/smooth_pid.hpp"
+#include "tap/util_macros.hpp"
+
+#include "dji_motor_tx_handler.hpp"
+
+namespace tap
+{
+class Drivers;
+namespace motor
+{
+/**
+ * Runs per-motor velocity or position PID loops as soon as new feedback from the motor has been
+ * decoded, at the motor's feedback rate (1 kHz for DJI motors) rather than the command
+ * scheduler's rate, and sends the resulting outputs with `DjiMotorTxHandler::sendTxFrames`.
+ *
+ * The motors sharing a command frame send feedback at different times, so a frame is sent once
+ * every loop of an online motor in it has run since the frame was last sent, or once
+ * `MAX_SEND_DELAY` has passed since the first of them ran. Each frame thus goes out once per
+ * feedback period rather than once per motor feedback.
+ *
+ * Subsystems owning a motor with an inner loop only push setpoints with `setVelocitySetpoint`
+ * or `setPositionSetpoint` and must not call `DjiMotor::setDesiredOutput` themselves. Frames
+ * commanding an online motor with an inner loop are owned by this service (see
+ * `getOwnedTxFrames`) and skipped by the scheduled `DjiMotorTxHandler::processCanSendData`.
+ *
+ * Loops of disconnected motors are stopped, setting their output to 0. Their frames then go
+ * back to `processCanSendData`, so that the other motors in them keep being commanded.
+ *
+ * `run` must be called right after `CanRxHandler::pollCanData`, holding off the control tick
+ * in the same way, so that setpoints written by the control pass and loop state never change
+ * under each other.
+ *
+ * Velocities are in RPM (as `DjiMotor::getShaftRPM`) and positions in unwrapped encoder ticks,
+ * both measured with the motor's `EncoderVelocityEstimator`. The derivative term acts on the
+ * measured acceleration (velocity loops) or velocity (position loops).
+ */
+class MotorInnerLoopService
+{
+public:
+    static constexpr int MAX_LOOPS = 8;
+
+    /**
+     * Upper bound of the time step passed to the PID, in ms, so that the first feedback after a
+     * gap (such as the motor reconnecting) doesn't wind up the integral term.
+     */
+    static constexpr float MAX_DT = 10.0f;
+
+    /**
+     * Longest time a frame with an updated output waits for the other loops in it to run, in
+     * microseconds. One feedback period of a DJI motor. Also the time after which a queued frame
+     * is dropped, as the next feedback's output supersedes it.
+     */
+    static constexpr uint32_t MAX_SEND_DELAY = 1'000;
+
+    enum class Mode : uint8_t
+    {
+        VELOCITY,
+        POSITION,
+    };
+
+    MotorInnerLoopService(Drivers* drivers) : drivers(drivers) {}
+    DISALLOW_COPY_AND_ASSIGN(MotorInnerLoopService)
+    mockable ~MotorInnerLoopService() = default;
+
+    /**
+     * Starts running a loop for `motor`, holding its current position (or at rest) until a
+     * setpoint is pushed. The motor must be initialized.
+     *
+     * @return `false` if all `MAX_LOOPS` loops are used or `motor` already has one.
+     */
+    mockable bool addLoop(DjiMotor* motor, Mode mode, const algorithms::SmoothPidConfig& config);
+
+    mockable void removeLoop(const DjiMotor* motor);
+
+    /// Sets the setpoint of `motor`'s velocity loop, in RPM.
+    mockable void setVelocitySetpoint(const DjiMotor* motor, float rpm);
+
+    /// Sets the setpoint of `motor`'s position loop, in unwrapped encoder ticks.
+    mockable void setPositionSetpoint(const DjiMotor* motor, int64_t encoder);
+
+    /**
+     * Runs the loop of each motor with new feedback since the last call, and sends the command
+     * frames that are complete or have waited `MAX_SEND_DELAY`.
+     */
+    mockable void run();
+
+    /**
+     * @return A `DjiMotorTxHandler::sendTxFrames` mask of the frames commanding an online motor
+     *      with a loop, which only this service sends. Frames whose loop motors are all offline
+     *      (or were never online) are sent by `DjiMotorTxHandler::processCanSendData`.
+     */
+    mockable uint8_t getOwnedTxFrames() const;
+
+    /// @return The number of times `motor`'s loop ran, 0 if it has none.
+    mockable uint32_t getRunCount(const DjiMotor* motor) const;
+
+private:
+    struct Loop
+    {
+        DjiMotor* motor = nullptr;
+        Mode mode = Mode::VELOCITY;
+        algorithms::SmoothPid pid{algorithms::SmoothPidConfig()};
+        float velocitySetpoint = 0;
+        int64_t positionSetpoint = 0;
+        /// Receive timestamp of the feedback the loop last ran on, in microseconds.
+        uint32_t lastFeedbackTime = 0;
+        uint32_t runCount = 0;
+        /// Whether the loop ran since its frame was last sent.
+        bool outputUpdated = false;
+    };
+
+    Drivers* drivers;
+
+    Loop loops[MAX_LOOPS];
+
+    /// Mask of the frames with an updated output that have not been sent yet.
+    uint8_t pendingTxFrames = 0;
+
+    /// Time the first loop of each pending frame ran, in microseconds, indexed by mask bit.
+    uint32_t pendingSince[DjiMotorTxHandler::NUM_TX_FRAMES] = {};
+
+    Loop* findLoop(const DjiMotor* motor);
+
+    const Loop* findLoop(const DjiMotor* motor) const;
+
+    /**
+     * Runs `loop` if its motor sent new feedback.
+     *
+     * @return `true` if the loop ran.
+     */
+    bool runLoop(Loop& loop);
+};  // class MotorInnerLoopService
+
+}  // namespace motor
+
+}  // namespace tap
+
+#endif  // MOTOR_INNER_LOOP_SERVICE_HPP_
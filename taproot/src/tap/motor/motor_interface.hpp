@@ -36,6 +36,8 @@ public:
     virtual int8_t getTemperature() const = 0;
     virtual int16_t getTorque() const = 0;
     virtual int16_t getShaftRPM() const = 0;
+    /// @return Estimated velocity of the encoder, in encoder ticks per second.
+    virtual float getEncoderVelocity() const = 0;
 };
 
 }  // namespace tap::motor
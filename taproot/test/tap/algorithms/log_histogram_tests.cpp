@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/log_histogram.hpp"
+
+using tap::algorithms::LogHistogram;
+
+TEST(LogHistogram, bucketIndex_is_contiguous_and_monotonic)
+{
+    using Histogram = LogHistogram<3, 12>;
+
+    EXPECT_EQ(7, Histogram::bucketIndex(7));
+    EXPECT_EQ(8, Histogram::bucketIndex(8));
+    EXPECT_EQ(15, Histogram::bucketIndex(15));
+    // 16-17 share a bucket, as do 18-19
+    EXPECT_EQ(16, Histogram::bucketIndex(16));
+    EXPECT_EQ(16, Histogram::bucketIndex(17));
+    EXPECT_EQ(17, Histogram::bucketIndex(18));
+    EXPECT_EQ(Histogram::BUCKET_COUNT - 1, Histogram::bucketIndex(4095));
+    EXPECT_EQ(Histogram::BUCKET_COUNT - 1, Histogram::bucketIndex(1'000'000));
+
+    for (int i = 0; i < Histogram::BUCKET_COUNT; i++)
+    {
+        EXPECT_EQ(i, Histogram::bucketIndex(Histogram::bucketUpperBound(i)));
+        if (i + 1 < Histogram::BUCKET_COUNT)
+        {
+            EXPECT_EQ(i + 1, Histogram::bucketIndex(Histogram::bucketUpperBound(i) + 1));
+        }
+    }
+}
+
+TEST(LogHistogram, percentile_finds_the_tail)
+{
+    LogHistogram<3, 20> histogram;
+
+    // 990 fast samples, 9 slow ones and one very slow outlier
+    for (int i = 0; i < 990; i++)
+    {
+        histogram.add(100);
+    }
+    for (int i = 0; i < 9; i++)
+    {
+        histogram.add(2'000);
+    }
+    histogram.add(10'000);
+
+    EXPECT_EQ(1000u, histogram.getCount());
+    EXPECT_EQ(100u, histogram.getMin());
+    EXPECT_EQ(10'000u, histogram.getMax());
+    EXPECT_EQ(127u, histogram.getMean());
+
+    // Percentiles are bucket upper bounds, within 12.5% above the true value
+    EXPECT_EQ(103u, histogram.percentile(0.5f));
+    EXPECT_EQ(103u, histogram.percentile(0.99f));
+    EXPECT_GE(histogram.percentile(0.999f), 2'000u);
+    EXPECT_LE(histogram.percentile(0.999f), 2'250u);
+    EXPECT_EQ(10'000u, histogram.percentile(1.0f));
+
+    histogram.reset();
+    EXPECT_EQ(0u, histogram.getCount());
+    EXPECT_EQ(0u, histogram.percentile(0.5f));
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/control_tick.hpp"
+#include "tap/control/scheduler_terminal_handler.hpp"
+#include "tap/drivers.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using tap::arch::ControlTick;
+
+static int controlPasses = 0;
+
+static void runControl(tap::Drivers *) { controlPasses++; }
+
+static void runSlowControl(tap::Drivers *)
+{
+    controlPasses++;
+    tap::arch::clock::setTime(tap::arch::clock::getTimeMilliseconds() + 3);
+}
+
+TEST(ControlTick, tick_records_period_and_jitter)
+{
+    tap::Drivers drivers;
+    ControlTick controlTick(&drivers);
+    controlPasses = 0;
+
+    controlTick.start(2'000, runControl);
+    EXPECT_TRUE(controlTick.isRunning());
+
+    // Ticks at 0, 2, 5 and 6 ms: periods of 2, 3 and 1 ms
+    tap::arch::clock::setTime(0);
+    controlTick.tick();
+    for (uint32_t time : {2, 5, 6})
+    {
+        tap::arch::clock::setTime(time);
+        controlTick.tick();
+    }
+
+    const ControlTick::TickStats &stats = controlTick.getStats();
+    EXPECT_EQ(4, controlPasses);
+    EXPECT_EQ(4u, stats.ticks);
+    EXPECT_EQ(3u, stats.periods);
+    EXPECT_EQ(1'000u, stats.minPeriod);
+    EXPECT_EQ(3'000u, stats.maxPeriod);
+    EXPECT_EQ(2'000u, stats.meanPeriod());
+    EXPECT_EQ(1'000u, stats.lastPeriod);
+    EXPECT_EQ(1'000u, stats.maxJitter);
+    EXPECT_EQ(666u, stats.meanJitter());
+    EXPECT_EQ(0u, stats.overruns);
+
+    controlTick.resetStats();
+    EXPECT_EQ(0u, controlTick.getStats().ticks);
+}
+
+TEST(ControlTick, tick_counts_overruns)
+{
+    tap::Drivers drivers;
+    ControlTick controlTick(&drivers);
+
+    controlTick.start(2'000, runSlowControl);
+    tap::arch::clock::setTime(0);
+    controlTick.tick();
+
+    EXPECT_EQ(3'000u, controlTick.getStats().lastExecution);
+    EXPECT_EQ(1u, controlTick.getStats().overruns);
+}
+
+TEST(ControlTick, start_raises_error_if_started_twice)
+{
+    tap::Drivers drivers;
+    ControlTick controlTick(&drivers);
+
+    controlTick.start(2'000, runControl);
+
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+    controlTick.start(1'000, runControl);
+    EXPECT_EQ(2'000u, controlTick.getPeriod());
+}
+
+TEST(ControlTick, lock_nests)
+{
+    tap::Drivers drivers;
+    ControlTick controlTick(&drivers);
+
+    {
+        ControlTick::Lock outer(&controlTick);
+        {
+            ControlTick::Lock inner(&controlTick);
+            EXPECT_TRUE(controlTick.isLocked());
+        }
+        // The inner lock must not release the outer one
+        EXPECT_TRUE(controlTick.isLocked());
+    }
+    EXPECT_FALSE(controlTick.isLocked());
+}
+
+TEST(ControlTick, resettiming_clears_stats_while_locked)
+{
+    tap::Drivers drivers;
+    tap::control::SchedulerTerminalHandler handler(&drivers);
+    tap::stub::TerminalDeviceStub terminalDevice(&drivers);
+    modm::IOStream stream(terminalDevice);
+
+    drivers.controlTick.start(2'000, runControl);
+    drivers.controlTick.tick();
+    ASSERT_EQ(1u, drivers.controlTick.getStats().ticks);
+
+    {
+        // The terminal is updated under the lock, like in main.cpp
+        ControlTick::Lock lock(&drivers.controlTick);
+        char input[] = "resettiming";
+        EXPECT_TRUE(handler.terminalSerialCallback(input, stream, false));
+
+        EXPECT_EQ(0u, drivers.controlTick.getStats().ticks);
+        EXPECT_TRUE(drivers.controlTick.isLocked());
+    }
+    EXPECT_FALSE(drivers.controlTick.isLocked());
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef RUN_WITH_PROFILING
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/profiler.hpp"
+#include "tap/architecture/profiler_terminal_handler.hpp"
+#include "tap/drivers.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace tap::arch;
+using namespace testing;
+
+/**
+ * Measures the probes "a" (10 ms) containing "b" (2 ms) then "c" (4 ms) containing "d" (2 ms),
+ * followed by a second outermost probe "e" (2 ms).
+ */
+static void runNestedProbes(Profiler &profiler)
+{
+    int a = Profiler::registerProbe("profiler_tests a");
+    int b = Profiler::registerProbe("profiler_tests b");
+    int c = Profiler::registerProbe("profiler_tests c");
+    int d = Profiler::registerProbe("profiler_tests d");
+    int e = Profiler::registerProbe("profiler_tests \"e\"");
+
+    clock::setTime(0);
+    profiler.push(a);
+    clock::setTime(1);
+    profiler.push(b);
+    clock::setTime(3);
+    profiler.pop();
+    profiler.push(c);
+    clock::setTime(4);
+    profiler.push(d);
+    clock::setTime(6);
+    profiler.pop();
+    clock::setTime(7);
+    profiler.pop();
+    clock::setTime(10);
+    profiler.pop();
+    profiler.push(e);
+    clock::setTime(12);
+    profiler.pop();
+}
+
+TEST(Profiler, nested_probes_build_call_tree)
+{
+    tap::Drivers drivers;
+    Profiler &profiler = drivers.profiler;
+
+    runNestedProbes(profiler);
+
+    EXPECT_EQ(5, profiler.getCallNodeCount());
+    EXPECT_EQ(0u, profiler.getDroppedCount());
+
+    // Siblings are listed most recently added first
+    int e = profiler.getFirstRootCallNode();
+    ASSERT_NE(Profiler::NO_CALL_NODE, e);
+    EXPECT_STREQ("profiler_tests \"e\"", Profiler::getProbeName(profiler.getCallNode(e).probe));
+    EXPECT_EQ(Profiler::NO_CALL_NODE, profiler.getCallNode(e).firstChild);
+
+    int a = profiler.getCallNode(e).nextSibling;
+    ASSERT_NE(Profiler::NO_CALL_NODE, a);
+    const Profiler::CallNode &aNode = profiler.getCallNode(a);
+    EXPECT_STREQ("profiler_tests a", Profiler::getProbeName(aNode.probe));
+    EXPECT_EQ(Profiler::NO_CALL_NODE, aNode.parent);
+    EXPECT_EQ(Profiler::NO_CALL_NODE, aNode.nextSibling);
+    EXPECT_EQ(1u, aNode.count);
+    EXPECT_EQ(10'000u, aNode.inclusiveTime);
+    EXPECT_EQ(4'000u, aNode.exclusiveTime);
+
+    int c = aNode.firstChild;
+    ASSERT_NE(Profiler::NO_CALL_NODE, c);
+    EXPECT_STREQ("profiler_tests c", Profiler::getProbeName(profiler.getCallNode(c).probe));
+    EXPECT_EQ(a, profiler.getCallNode(c).parent);
+    EXPECT_EQ(4'000u, profiler.getCallNode(c).inclusiveTime);
+    EXPECT_EQ(2'000u, profiler.getCallNode(c).exclusiveTime);
+
+    int d = profiler.getCallNode(c).firstChild;
+    ASSERT_NE(Profiler::NO_CALL_NODE, d);
+    EXPECT_STREQ("profiler_tests d", Profiler::getProbeName(profiler.getCallNode(d).probe));
+    EXPECT_EQ(c, profiler.getCallNode(d).parent);
+
+    int b = profiler.getCallNode(c).nextSibling;
+    ASSERT_NE(Profiler::NO_CALL_NODE, b);
+    EXPECT_STREQ("profiler_tests b", Profiler::getProbeName(profiler.getCallNode(b).probe));
+    EXPECT_EQ(a, profiler.getCallNode(b).parent);
+    EXPECT_EQ(Profiler::NO_CALL_NODE, profiler.getCallNode(b).nextSibling);
+}
+
+TEST(Profiler, repeated_probes_reuse_call_nodes)
+{
+    tap::Drivers drivers;
+    Profiler &profiler = drivers.profiler;
+
+    runNestedProbes(profiler);
+    runNestedProbes(profiler);
+
+    EXPECT_EQ(5, profiler.getCallNodeCount());
+    int a = profiler.getCallNode(profiler.getFirstRootCallNode()).nextSibling;
+    EXPECT_EQ(2u, profiler.getCallNode(a).count);
+    EXPECT_EQ(20'000u, profiler.getCallNode(a).inclusiveTime);
+}
+
+TEST(ProfilerTerminalHandler, tree_prints_nodes_depth_first_with_indentation)
+{
+    tap::Drivers drivers;
+    ProfilerTerminalHandler handler(&drivers);
+    tap::stub::TerminalDeviceStub terminalDevice(&drivers);
+    modm::IOStream stream(terminalDevice);
+
+    runNestedProbes(drivers.profiler);
+
+    char input[] = "tree";
+    EXPECT_TRUE(handler.terminalSerialCallback(input, stream, false));
+
+    EXPECT_EQ(
+        "Call tree (count, mean inclusive/exclusive us):\n"
+        "  profiler_tests \"e\": 1, 2000/2000\n"
+        "  profiler_tests a: 1, 10000/4000\n"
+        "    profiler_tests c: 1, 4000/2000\n"
+        "      profiler_tests d: 1, 2000/2000\n"
+        "    profiler_tests b: 1, 2000/2000\n",
+        terminalDevice.readAllItemsFromWriteBufferToString());
+}
+
+#ifdef PLATFORM_HOSTED
+TEST(Profiler, writeChromeTrace_writes_one_complete_event_per_probe)
+{
+    tap::Drivers drivers;
+    Profiler &profiler = drivers.profiler;
+    std::string path = TempDir() + "profiler_tests_chrome_trace.json";
+
+    profiler.startChromeTrace();
+    runNestedProbes(profiler);
+    profiler.stopChromeTrace();
+    EXPECT_EQ(5u, profiler.getChromeTraceEventCount());
+
+    // Not recorded once stopped
+    runNestedProbes(profiler);
+    EXPECT_EQ(5u, profiler.getChromeTraceEventCount());
+
+    ASSERT_TRUE(profiler.writeChromeTrace(path.c_str()));
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::remove(path.c_str());
+
+    // Events are recorded as their probe ends, so nested probes come first
+    EXPECT_EQ(
+        "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+        "{\"name\": \"profiler_tests b\", \"ph\": \"X\", \"ts\": 1000, \"dur\": 2000, \"pid\": "
+        "0, \"tid\": 0},\n"
+        "{\"name\": \"profiler_tests d\", \"ph\": \"X\", \"ts\": 4000, \"dur\": 2000, \"pid\": "
+        "0, \"tid\": 0},\n"
+        "{\"name\": \"profiler_tests c\", \"ph\": \"X\", \"ts\": 3000, \"dur\": 4000, \"pid\": "
+        "0, \"tid\": 0},\n"
+        "{\"name\": \"profiler_tests a\", \"ph\": \"X\", \"ts\": 0, \"dur\": 10000, \"pid\": 0, "
+        "\"tid\": 0},\n"
+        "{\"name\": \"profiler_tests \\\"e\\\"\", \"ph\": \"X\", \"ts\": 10000, \"dur\": 2000, "
+        "\"pid\": 0, \"tid\": 0}\n"
+        "]}\n",
+        contents.str());
+}
+
+TEST(Profiler, startChromeTrace_stops_recording_at_capacity)
+{
+    tap::Drivers drivers;
+    Profiler &profiler = drivers.profiler;
+
+    profiler.startChromeTrace(3);
+    runNestedProbes(profiler);
+
+    EXPECT_EQ(3u, profiler.getChromeTraceEventCount());
+}
+#endif
+
+#endif
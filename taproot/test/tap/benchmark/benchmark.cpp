@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace tap::benchmark
+{
+void report(const char *benchmark, const char *benchmarkCase, int n, double nsPerOp)
+{
+    std::printf("%-24s %-28s n=%-6d %12.1f ns/op\n", benchmark, benchmarkCase, n, nsPerOp);
+
+    static bool truncated = false;
+    const char *outputPath = std::getenv(OUTPUT_ENV_VAR);
+    if (outputPath == nullptr)
+    {
+        return;
+    }
+
+    FILE *output = std::fopen(outputPath, truncated ? "a" : "w");
+    if (output == nullptr)
+    {
+        std::fprintf(stderr, "failed to open benchmark output file %s\n", outputPath);
+        return;
+    }
+    truncated = true;
+
+    std::fprintf(
+        output,
+        "{\"benchmark\": \"%s\", \"case\": \"%s\", \"n\": %d, \"ns_per_op\": %.1f}\n",
+        benchmark,
+        benchmarkCase,
+        n,
+        nsPerOp);
+    std::fclose(output);
+}
+}  // namespace tap::benchmark
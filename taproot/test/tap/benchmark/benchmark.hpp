@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_HPP_
+#define BENCHMARK_HPP_
+
+#include <chrono>
+#include <cstdint>
+
+namespace tap::benchmark
+{
+/**
+ * Name prefix of every benchmark test suite. `scons run-tests` skips suites starting with this
+ * prefix and `scons run-benchmarks` runs only them.
+ *
+ * ```
+ * TEST(BenchmarkCommandScheduler, run)
+ * {
+ *     double nsPerOp = tap::benchmark::measureNsPerOp(10'000, [&]() { scheduler.run(); });
+ *     tap::benchmark::report("CommandScheduler", "run", commandCount, nsPerOp);
+ * }
+ * ```
+ */
+static constexpr char SUITE_PREFIX[] = "Benchmark";
+
+/**
+ * Environment variable holding the path of the file results are written to. If unset, results
+ * are only printed.
+ */
+static constexpr char OUTPUT_ENV_VAR[] = "TAPROOT_BENCHMARK_OUTPUT";
+
+/**
+ * Calls `op` `iterations` times after a short warm-up.
+ *
+ * @return The mean wall clock time of a single call, in nanoseconds.
+ */
+template <typename Op>
+double measureNsPerOp(int iterations, Op &&op)
+{
+    for (int i = 0; i < iterations / 10; i++)
+    {
+        op();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        op();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+/**
+ * Prints a result and, if `TAPROOT_BENCHMARK_OUTPUT` is set, appends it to that file as a
+ * line of JSON (`{"benchmark": ..., "case": ..., "n": ..., "ns_per_op": ...}`). The file is
+ * truncated by the first report of each run.
+ *
+ * @param[in] benchmark The name of the benchmarked unit, e.g. `"CommandScheduler"`.
+ * @param[in] benchmarkCase The name of the operation measured, e.g. `"run"`.
+ * @param[in] n The problem size of this measurement (number of commands, mappings, ...).
+ * @param[in] nsPerOp The result of `measureNsPerOp`.
+ */
+void report(const char *benchmark, const char *benchmarkCase, int n, double nsPerOp);
+}  // namespace tap::benchmark
+
+#endif  // BENCHMARK_HPP_
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/can/can_id_filter.hpp"
+
+using namespace tap::can;
+
+static std::vector<CanIdFilter> buildFilters(const std::vector<uint16_t> &ids, int maxFilters)
+{
+    std::vector<CanIdFilter> filters(maxFilters);
+    filters.resize(buildCanIdFilters(ids.data(), ids.size(), filters.data(), maxFilters));
+    return filters;
+}
+
+static bool isAccepted(const std::vector<CanIdFilter> &filters, uint16_t id)
+{
+    for (const CanIdFilter &filter : filters)
+    {
+        if (filter.accepts(id))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST(CanIdFilter, buildCanIdFilters_covers_ranges_with_mask_filters)
+{
+    // 0x201-0x208 are the feedback identifiers of eight DJI motors
+    std::vector<uint16_t> ids = {0x201, 0x202, 0x203, 0x204, 0x205, 0x206, 0x207, 0x208, 0x211};
+
+    std::vector<CanIdFilter> filters = buildFilters(ids, 28);
+
+    std::vector<CanIdFilter> expected = {
+        {0x201, 0x7FF},
+        {0x202, 0x7FE},
+        {0x204, 0x7FC},
+        {0x208, 0x7FF},
+        {0x211, 0x7FF},
+    };
+    EXPECT_EQ(expected, filters);
+    for (uint16_t id = 0x1E4; id < 0x224; id++)
+    {
+        bool listened = std::find(ids.begin(), ids.end(), id) != ids.end();
+        EXPECT_EQ(listened, isAccepted(filters, id)) << id;
+    }
+    EXPECT_TRUE(buildFilters({}, 28).empty());
+}
+
+TEST(CanIdFilter, buildCanIdFilters_merges_the_closest_blocks_when_out_of_filters)
+{
+    std::vector<uint16_t> ids = {0x201, 0x203, 0x210, 0x220};
+
+    std::vector<CanIdFilter> filters = buildFilters(ids, 3);
+
+    // 0x201 and 0x203 are merged into 0x200-0x203, which is cheaper than any other merge
+    std::vector<CanIdFilter> expected = {{0x200, 0x7FC}, {0x210, 0x7FF}, {0x220, 0x7FF}};
+    EXPECT_EQ(expected, filters);
+
+    filters = buildFilters(ids, 1);
+    ASSERT_EQ(1u, filters.size());
+    for (uint16_t id : ids)
+    {
+        EXPECT_TRUE(isAccepted(filters, id)) << id;
+    }
+    EXPECT_FALSE(isAccepted(filters, 0x1FF));
+}
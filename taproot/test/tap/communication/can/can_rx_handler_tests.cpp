@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can_rx_handler.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/can_rx_listener_mock.hpp"
+
+using namespace tap::can;
+using namespace testing;
+
+/**
+ * Makes `drivers.can` report `can1Frames` and `can2Frames` frames waiting on CAN 1 and CAN 2,
+ * all addressed to 0x201. A frame's timestamp is the number of frames queued behind it.
+ */
+static void queueFrames(tap::Drivers &drivers, int *can1Frames, int *can2Frames)
+{
+    ON_CALL(drivers.can, getMessage)
+        .WillByDefault([=](CanBus bus, modm::can::Message *message, uint32_t *timestamp) {
+            int *frames = bus == CanBus::CAN_BUS1 ? can1Frames : can2Frames;
+            if (*frames == 0)
+            {
+                return false;
+            }
+            (*frames)--;
+            *message = modm::can::Message(0x201, 8);
+            *timestamp = *frames;
+            return true;
+        });
+    ON_CALL(drivers.can, isMessageAvailable).WillByDefault([=](CanBus bus) {
+        return *(bus == CanBus::CAN_BUS1 ? can1Frames : can2Frames) > 0;
+    });
+}
+
+TEST(CanRxHandler, pollCanData_processes_one_frame_per_bus_by_default)
+{
+    tap::Drivers drivers;
+    CanRxHandler handler(&drivers);
+    NiceMock<tap::mock::CanRxListenerMock> can1Motor(&drivers, 0x201, CanBus::CAN_BUS1);
+    NiceMock<tap::mock::CanRxListenerMock> can2Motor(&drivers, 0x201, CanBus::CAN_BUS2);
+    handler.attachReceiveHandler(&can1Motor);
+    handler.attachReceiveHandler(&can2Motor);
+    int can1Frames = 3, can2Frames = 1;
+    queueFrames(drivers, &can1Frames, &can2Frames);
+
+    EXPECT_CALL(can1Motor, processMessage).Times(1);
+    EXPECT_CALL(can2Motor, processMessage).Times(1);
+    handler.pollCanData();
+
+    EXPECT_EQ(1u, handler.getRxStats(CanBus::CAN_BUS1).backlogPolls);
+    EXPECT_EQ(0u, handler.getRxStats(CanBus::CAN_BUS2).backlogPolls);
+}
+
+TEST(CanRxHandler, pollCanData_drains_up_to_the_frame_limit_per_bus)
+{
+    tap::Drivers drivers;
+    CanRxHandler handler(&drivers);
+    NiceMock<tap::mock::CanRxListenerMock> can1Motor(&drivers, 0x201, CanBus::CAN_BUS1);
+    NiceMock<tap::mock::CanRxListenerMock> can2Motor(&drivers, 0x201, CanBus::CAN_BUS2);
+    handler.attachReceiveHandler(&can1Motor);
+    handler.attachReceiveHandler(&can2Motor);
+    int can1Frames = 10, can2Frames = 3;
+    queueFrames(drivers, &can1Frames, &can2Frames);
+    ON_CALL(drivers.can, getRxOverflowCount(CanBus::CAN_BUS1)).WillByDefault(Return(2));
+
+    handler.setDrainLimits(8, 0);
+
+    EXPECT_CALL(can1Motor, processMessage).Times(8);
+    EXPECT_CALL(can2Motor, processMessage).Times(3);
+    handler.pollCanData();
+
+    const CanRxHandler::RxStats &can1Stats = handler.getRxStats(CanBus::CAN_BUS1);
+    EXPECT_EQ(8u, can1Stats.frames);
+    EXPECT_EQ(8u, can1Stats.maxFramesPerPoll);
+    EXPECT_EQ(1u, can1Stats.backlogPolls);
+    EXPECT_EQ(2u, can1Stats.overflows);
+    EXPECT_EQ(3u, handler.getRxStats(CanBus::CAN_BUS2).frames);
+    EXPECT_EQ(0u, handler.getRxStats(CanBus::CAN_BUS2).backlogPolls);
+}
+
+TEST(CanRxHandler, pollCanData_stops_draining_once_the_time_budget_is_used_up)
+{
+    tap::Drivers drivers;
+    CanRxHandler handler(&drivers);
+    NiceMock<tap::mock::CanRxListenerMock> can1Motor(&drivers, 0x201, CanBus::CAN_BUS1);
+    handler.attachReceiveHandler(&can1Motor);
+    int can1Frames = 10, can2Frames = 0;
+    queueFrames(drivers, &can1Frames, &can2Frames);
+
+    // Each frame takes 1 ms to process
+    ON_CALL(can1Motor, processMessage).WillByDefault([](const modm::can::Message &) {
+        tap::arch::clock::setTime(tap::arch::clock::getTimeMilliseconds() + 1);
+    });
+    handler.setDrainLimits(16, 3'000);
+
+    EXPECT_CALL(can1Motor, processMessage).Times(3);
+    handler.pollCanData();
+    EXPECT_EQ(7, can1Frames);
+}
+
+TEST(CanRxHandler, pollCanData_passes_arrival_time_to_listeners)
+{
+    tap::Drivers drivers;
+    CanRxHandler handler(&drivers);
+    NiceMock<tap::mock::CanRxListenerMock> can1Motor(&drivers, 0x201, CanBus::CAN_BUS1);
+    handler.attachReceiveHandler(&can1Motor);
+    int can1Frames = 3, can2Frames = 0;
+    queueFrames(drivers, &can1Frames, &can2Frames);
+
+    std::vector<uint32_t> timestamps;
+    ON_CALL(can1Motor, processMessage).WillByDefault([&](const modm::can::Message &) {
+        timestamps.push_back(can1Motor.getReceiveTimestamp());
+    });
+    handler.setDrainLimits(16, 0);
+    handler.pollCanData();
+
+    EXPECT_EQ(std::vector<uint32_t>({2, 1, 0}), timestamps);
+}
+
+TEST(CanRxHandler, attaching_and_removing_listeners_updates_the_rx_filters)
+{
+    tap::Drivers drivers;
+    CanRxHandler handler(&drivers);
+    NiceMock<tap::mock::CanRxListenerMock> motor1(&drivers, 0x201, CanBus::CAN_BUS1);
+    NiceMock<tap::mock::CanRxListenerMock> motor2(&drivers, 0x202, CanBus::CAN_BUS1);
+    std::vector<CanIdFilter> filters;
+    ON_CALL(drivers.can, setRxFilters)
+        .WillByDefault([&](CanBus, const CanIdFilter *first, int numFilters) {
+            filters.assign(first, first + numFilters);
+        });
+
+    EXPECT_CALL(drivers.can, setRxFilters(CanBus::CAN_BUS1, _, _)).Times(3);
+    handler.attachReceiveHandler(&motor1);
+    handler.attachReceiveHandler(&motor2);
+    EXPECT_EQ(std::vector<CanIdFilter>({{0x201, 0x7FF}, {0x202, 0x7FF}}), filters);
+
+    handler.removeReceiveHandler(motor1);
+    EXPECT_EQ(std::vector<CanIdFilter>({{0x202, 0x7FF}}), filters);
+}
+
+TEST(CanRxHandler, initialize_rejects_every_frame_on_buses_without_listeners)
+{
+    tap::Drivers drivers;
+    CanRxHandler handler(&drivers);
+    NiceMock<tap::mock::CanRxListenerMock> motor(&drivers, 0x201, CanBus::CAN_BUS1);
+    handler.attachReceiveHandler(&motor);
+
+    EXPECT_CALL(drivers.can, setRxFilters(CanBus::CAN_BUS1, _, 1));
+    EXPECT_CALL(drivers.can, setRxFilters(CanBus::CAN_BUS2, _, 0));
+    handler.initialize();
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/can/can_rx_ring.hpp"
+
+using namespace tap::can;
+
+TEST(CanRxRing, pop_returns_frames_in_order_with_their_timestamps)
+{
+    CanRxRing<4> ring;
+    TimestampedCanMessage frame;
+
+    EXPECT_TRUE(ring.isEmpty());
+    EXPECT_FALSE(ring.pop(&frame));
+
+    EXPECT_TRUE(ring.push(modm::can::Message(0x201, 8), 100));
+    EXPECT_TRUE(ring.push(modm::can::Message(0x202, 8), 200));
+    EXPECT_EQ(2, ring.size());
+
+    ASSERT_TRUE(ring.pop(&frame));
+    EXPECT_EQ(0x201u, frame.message.getIdentifier());
+    EXPECT_EQ(100u, frame.timestamp);
+    ASSERT_TRUE(ring.pop(&frame));
+    EXPECT_EQ(0x202u, frame.message.getIdentifier());
+    EXPECT_EQ(200u, frame.timestamp);
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(CanRxRing, push_drops_frames_once_full_and_wraps_around)
+{
+    CanRxRing<4> ring;
+    TimestampedCanMessage frame;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        EXPECT_TRUE(ring.push(modm::can::Message(0x201, 8), i));
+    }
+    EXPECT_FALSE(ring.push(modm::can::Message(0x201, 8), 3));
+    EXPECT_EQ(1u, ring.getDroppedCount());
+    EXPECT_EQ(3, ring.size());
+
+    // Free two slots and fill them, wrapping the indices around the end of the ring
+    ring.pop(&frame);
+    ring.pop(&frame);
+    EXPECT_TRUE(ring.push(modm::can::Message(0x201, 8), 4));
+    EXPECT_TRUE(ring.push(modm::can::Message(0x201, 8), 5));
+    EXPECT_EQ(3, ring.size());
+
+    for (uint32_t expected : {2u, 4u, 5u})
+    {
+        ASSERT_TRUE(ring.pop(&frame));
+        EXPECT_EQ(expected, frame.timestamp);
+    }
+    EXPECT_EQ(1u, ring.getDroppedCount());
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can_stats.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+using namespace tap::can;
+
+TEST(CanStats, frameBits_is_the_worst_case_length_with_bit_stuffing)
+{
+    modm::can::Message standard(0x201, 8);
+    standard.setExtended(false);
+    EXPECT_EQ(135u, CanStats::frameBits(standard));
+
+    modm::can::Message empty(0x201, 0);
+    empty.setExtended(false);
+    EXPECT_EQ(55u, CanStats::frameBits(empty));
+
+    modm::can::Message extended(0x201, 8);
+    extended.setExtended(true);
+    EXPECT_EQ(160u, CanStats::frameBits(extended));
+}
+
+TEST(CanStats, sample_computes_rates_and_load_since_the_last_sample)
+{
+    CanStats stats;
+    modm::can::Message feedback(0x201, 8);
+    feedback.setExtended(false);
+    modm::can::Message command(0x200, 8);
+    command.setExtended(false);
+
+    tap::arch::clock::setTime(1'000);
+    stats.reset();
+
+    // 1 kHz feedback and command frames for 100 ms, with a third of the commands dropped
+    for (int i = 0; i < 100; i++)
+    {
+        stats.recordRx(CanBus::CAN_BUS1, feedback);
+        if (i % 3 != 0)
+        {
+            stats.recordTx(CanBus::CAN_BUS1, command);
+        }
+    }
+    stats.recordTxFailures(CanBus::CAN_BUS1, 34);
+    stats.recordTxNotReady(CanBus::CAN_BUS1, 2);
+    tap::arch::clock::setTime(1'100);
+    stats.sample();
+
+    const CanStats::BusStats &bus = stats.getBusStats(CanBus::CAN_BUS1);
+    EXPECT_EQ(1'000u, bus.rx.framesPerSecond);
+    EXPECT_EQ(8'000u, bus.rx.bytesPerSecond);
+    EXPECT_EQ(660u, bus.tx.framesPerSecond);
+    EXPECT_EQ(34u, bus.txFailures);
+    EXPECT_EQ(2u, bus.txNotReady);
+    // (100 + 66) frames * 135 bits over 100 ms at 1 Mbps
+    EXPECT_EQ(224u, bus.loadPermille);
+
+    ASSERT_EQ(1, bus.rx.numIds);
+    EXPECT_EQ(0x201u, bus.rx.ids[0].identifier);
+    EXPECT_EQ(1'000u, bus.rx.ids[0].framesPerSecond);
+    ASSERT_EQ(1, bus.tx.numIds);
+    EXPECT_EQ(0x200u, bus.tx.ids[0].identifier);
+    EXPECT_EQ(0, stats.getBusStats(CanBus::CAN_BUS2).rx.numIds);
+
+    // No traffic in the next 100 ms
+    tap::arch::clock::setTime(1'200);
+    stats.sample();
+    EXPECT_EQ(0u, bus.rx.framesPerSecond);
+    EXPECT_EQ(0u, bus.loadPermille);
+    EXPECT_EQ(100u, bus.rx.total.frames);
+}
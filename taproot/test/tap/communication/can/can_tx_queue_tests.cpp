@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/can/can_tx_queue.hpp"
+
+using namespace tap::can;
+
+static modm::can::Message frame(uint32_t id)
+{
+    modm::can::Message message(id, 8);
+    message.setExtended(false);
+    return message;
+}
+
+TEST(CanTxQueue, pop_takes_higher_priority_frames_first)
+{
+    CanTxQueue queue;
+    modm::can::Message message;
+
+    queue.push(frame(0x300), CanTxPriority::TELEMETRY, 0, 0);
+    queue.push(frame(0x100), CanTxPriority::NORMAL, 0, 0);
+    queue.push(frame(0x200), CanTxPriority::CONTROL, 0, 0);
+    queue.push(frame(0x1FF), CanTxPriority::CONTROL, 0, 0);
+
+    for (uint32_t expected : {0x200u, 0x1FFu, 0x100u, 0x300u})
+    {
+        ASSERT_TRUE(queue.pop(0, &message));
+        EXPECT_EQ(expected, message.getIdentifier());
+    }
+    EXPECT_FALSE(queue.pop(0, &message));
+    EXPECT_EQ(2u, queue.getStats(CanTxPriority::CONTROL).sent);
+}
+
+TEST(CanTxQueue, pop_drops_frames_past_their_deadline)
+{
+    CanTxQueue queue;
+    modm::can::Message message;
+
+    // The clock is about to wrap around
+    uint32_t now = UINT32_MAX - 500;
+    queue.push(frame(0x200), CanTxPriority::CONTROL, now, 1'000);
+    queue.push(frame(0x201), CanTxPriority::CONTROL, now + 600, 1'000);
+    queue.push(frame(0x300), CanTxPriority::TELEMETRY, now, 0);
+
+    ASSERT_TRUE(queue.pop(now + 1'200, &message));
+    EXPECT_EQ(0x201u, message.getIdentifier());
+    ASSERT_TRUE(queue.pop(now + 100'000, &message));
+    EXPECT_EQ(0x300u, message.getIdentifier());
+    EXPECT_EQ(1u, queue.getStats(CanTxPriority::CONTROL).deadlineMisses);
+    EXPECT_EQ(0u, queue.getStats(CanTxPriority::TELEMETRY).deadlineMisses);
+    EXPECT_EQ(1u, queue.getDeadlineMisses());
+
+    for (int i = 0; i < CanTxQueue::SLOTS_PER_PRIORITY; i++)
+    {
+        EXPECT_TRUE(queue.push(frame(0x100), CanTxPriority::NORMAL, 0, 0));
+    }
+    EXPECT_TRUE(queue.isFull(CanTxPriority::NORMAL));
+    EXPECT_FALSE(queue.push(frame(0x100), CanTxPriority::NORMAL, 0, 0));
+    EXPECT_EQ(1u, queue.getStats(CanTxPriority::NORMAL).overflows);
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/tcp-server/motor_telemetry.hpp"
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor.hpp"
+
+using namespace tap::communication;
+using namespace tap::motor;
+using tap::can::CanBus;
+
+TEST(MotorTelemetry, update_packs_a_batch_per_bus_with_a_record_per_registered_motor)
+{
+    tap::Drivers drivers;
+    DjiMotor motor1(&drivers, MOTOR2, CanBus::CAN_BUS1, false, "motor1");
+    DjiMotor motor2(&drivers, MOTOR5, CanBus::CAN_BUS2, false, "motor2");
+    DjiMotor motor3(&drivers, MOTOR1, CanBus::CAN_BUS2, false, "motor3");
+    motor1.initialize();
+    motor2.initialize();
+    motor3.initialize();
+    motor2.setDesiredOutput(-300);
+
+    modm::can::Message feedback(MOTOR5, 8);
+    feedback.data[2] = 0x01;  // 256 RPM
+    feedback.data[6] = 30;
+    tap::arch::clock::setTime(2);
+    drivers.djiMotorBankCan2.decode(feedback, 1'500);
+
+    drivers.motorTelemetry.update();
+    drivers.motorTelemetry.update();
+
+    ASSERT_EQ(
+        sizeof(MotorTelemetryHeader) + sizeof(MotorTelemetryRecord),
+        drivers.motorTelemetry.getBatchSize(0));
+    ASSERT_EQ(
+        sizeof(MotorTelemetryHeader) + 2 * sizeof(MotorTelemetryRecord),
+        drivers.motorTelemetry.getBatchSize(1));
+
+    MotorTelemetryHeader header;
+    memcpy(&header, drivers.motorTelemetry.getBatch(1), sizeof(header));
+    EXPECT_EQ(MotorTelemetry::MAGIC, header.magic);
+    EXPECT_EQ(MotorTelemetry::CHANNEL_CAN2, header.channel);
+    EXPECT_EQ(2, header.count);
+    EXPECT_EQ(1u, header.sequence);
+    EXPECT_EQ(2'000u, header.time);
+
+    MotorTelemetryRecord record;
+    memcpy(&record, drivers.motorTelemetry.getBatch(0) + sizeof(header), sizeof(record));
+    EXPECT_EQ(0, record.canBus);
+    EXPECT_EQ(1, record.motorId);
+    EXPECT_EQ(0, record.flags);
+
+    MotorTelemetryRecord records[2];
+    memcpy(records, drivers.motorTelemetry.getBatch(1) + sizeof(header), sizeof(records));
+    EXPECT_EQ(0, records[0].motorId);
+    EXPECT_EQ(1, records[1].canBus);
+    EXPECT_EQ(4, records[1].motorId);
+    EXPECT_EQ(256, records[1].shaftRPM);
+    EXPECT_EQ(-300, records[1].desiredOutput);
+    EXPECT_EQ(30, records[1].temperature);
+    EXPECT_EQ(1'500u, records[1].feedbackTime);
+    EXPECT_EQ(1, records[1].flags);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/tcp-server/tcp_server.hpp"
+
+using namespace tap::communication;
+
+static int connectClient(uint16_t port)
+{
+    int fileDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+    timeval timeout = {1, 0};
+    setsockopt(fileDescriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    connect(fileDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    return fileDescriptor;
+}
+
+static std::string receive(int fileDescriptor, size_t length)
+{
+    std::string received;
+    char buffer[64];
+    while (received.size() < length)
+    {
+        ssize_t n = recv(fileDescriptor, buffer, std::min(sizeof(buffer), length), 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        received.append(buffer, n);
+    }
+    return received;
+}
+
+TEST(TCPServer, publish_sends_each_client_the_channels_it_subscribed_to)
+{
+    TCPServer server;
+    const uint8_t zero[] = "zero", one[] = "one";
+
+    // Nothing is queued while no client is connected
+    EXPECT_TRUE(server.publish(0, zero, 4));
+    ASSERT_TRUE(server.start(0));
+    ASSERT_NE(0, server.getPortNumber());
+
+    int allChannels = connectClient(server.getPortNumber());
+    int channel1 = connectClient(server.getPortNumber());
+    send(channel1, "subscribe 1\n", 12, 0);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (server.getClientCount() < 2 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(2, server.getClientCount());
+    // Let the server thread handle the subscribe command
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_TRUE(server.publish(0, zero, 4));
+    EXPECT_TRUE(server.publish(1, one, 3));
+
+    EXPECT_EQ("zeroone", receive(allChannels, 7));
+    EXPECT_EQ("one", receive(channel1, 3));
+
+    close(allChannels);
+    close(channel1);
+    server.stop();
+    EXPECT_FALSE(server.isRunning());
+    EXPECT_EQ(0, server.getPortNumber());
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/tcp-server/telemetry_queue.hpp"
+
+using namespace tap::communication;
+
+TEST(TelemetryQueue, push_drops_messages_once_full_or_too_long)
+{
+    TelemetryQueue<4, 8> queue;
+    TelemetryQueue<4, 8>::Message message;
+    const uint8_t data[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    EXPECT_FALSE(queue.push(0, data, 9));
+    for (uint8_t channel = 0; channel < 3; channel++)
+    {
+        EXPECT_TRUE(queue.push(channel, data + channel, 2));
+    }
+    EXPECT_FALSE(queue.push(3, data, 2));
+    EXPECT_EQ(2u, queue.getDroppedCount());
+
+    for (uint8_t channel = 0; channel < 3; channel++)
+    {
+        ASSERT_TRUE(queue.pop(&message));
+        EXPECT_EQ(channel, message.channel);
+        EXPECT_EQ(2, message.length);
+        EXPECT_EQ(channel + 1, message.data[0]);
+        EXPECT_EQ(channel + 2, message.data[1]);
+    }
+    EXPECT_TRUE(queue.isEmpty());
+    EXPECT_FALSE(queue.pop(&message));
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/benchmark/benchmark.hpp"
+#include "tap/control/command_mapper.hpp"
+#include "tap/control/hold_command_mapping.hpp"
+#include "tap/control/hold_repeat_command_mapping.hpp"
+#include "tap/control/press_command_mapping.hpp"
+#include "tap/control/toggle_command_mapping.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/command_mock.hpp"
+
+using namespace tap::control;
+using tap::Remote;
+using tap::benchmark::measureNsPerOp;
+using tap::benchmark::report;
+using testing::NiceMock;
+
+static constexpr int KEY_COUNT = static_cast<int>(Remote::Key::B) + 1;
+
+/**
+ * A real CommandMapper holding `count` mappings, cycling through every mapping type. The first
+ * `KEY_COUNT` mappings are bound to a single key and the rest to a pair of adjacent keys so that
+ * every RemoteMapState is unique.
+ *
+ * @note The scheduler in `tap::Drivers` is a gmock object, so the measured time includes the
+ *      mock's overhead for every command the mappings add or remove.
+ */
+struct BenchmarkMapperFixture
+{
+    BenchmarkMapperFixture(int count) : mapper(&drivers)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            std::list<Remote::Key> keys = {static_cast<Remote::Key>(i % KEY_COUNT)};
+            if (i >= KEY_COUNT)
+            {
+                keys.push_back(static_cast<Remote::Key>((i + 1) % KEY_COUNT));
+            }
+            RemoteMapState rms(keys);
+
+            cmds.emplace_back(new NiceMock<tap::mock::CommandMock>());
+            std::vector<Command *> mappedCmds = {cmds.back().get()};
+
+            switch (i % 4)
+            {
+                case 0:
+                    mappings.emplace_back(new PressCommandMapping(&drivers, mappedCmds, rms));
+                    break;
+                case 1:
+                    mappings.emplace_back(new HoldCommandMapping(&drivers, mappedCmds, rms));
+                    break;
+                case 2:
+                    mappings.emplace_back(
+                        new HoldRepeatCommandMapping(&drivers, mappedCmds, rms));
+                    break;
+                default:
+                    mappings.emplace_back(new ToggleCommandMapping(&drivers, mappedCmds, rms));
+                    break;
+            }
+            mapper.addMap(mappings.back().get());
+        }
+    }
+
+    tap::Drivers drivers;
+    CommandMapper mapper;
+    std::vector<std::unique_ptr<NiceMock<tap::mock::CommandMock>>> cmds;
+    std::vector<std::unique_ptr<CommandMapping>> mappings;
+};
+
+static constexpr int ITERATIONS = 20'000;
+static constexpr int MAPPING_COUNTS[] = {4, 8, 16, 32};
+
+TEST(BenchmarkCommandMapper, handleKeyStateChange_no_change)
+{
+    for (int count : MAPPING_COUNTS)
+    {
+        BenchmarkMapperFixture fixture(count);
+        ASSERT_EQ(static_cast<std::size_t>(count), fixture.mapper.getSize());
+
+        report(
+            "CommandMapper",
+            "handleKeyStateChange_no_change",
+            count,
+            measureNsPerOp(ITERATIONS, [&]() {
+                fixture.mapper.handleKeyStateChange(
+                    0,
+                    Remote::SwitchState::MID,
+                    Remote::SwitchState::MID,
+                    false,
+                    false);
+            }));
+    }
+}
+
+TEST(BenchmarkCommandMapper, handleKeyStateChange_toggling_keys)
+{
+    for (int count : MAPPING_COUNTS)
+    {
+        BenchmarkMapperFixture fixture(count);
+
+        // Alternate between every mapped key pressed and released so each call adds or removes
+        // commands
+        const uint16_t allKeys = (1 << KEY_COUNT) - 1;
+        bool pressed = false;
+        report(
+            "CommandMapper",
+            "handleKeyStateChange_toggling_keys",
+            count,
+            measureNsPerOp(ITERATIONS, [&]() {
+                pressed = !pressed;
+                fixture.mapper.handleKeyStateChange(
+                    pressed ? allKeys : 0,
+                    Remote::SwitchState::MID,
+                    Remote::SwitchState::MID,
+                    false,
+                    false);
+            }));
+    }
+}
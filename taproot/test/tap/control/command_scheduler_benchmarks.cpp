@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/benchmark/benchmark.hpp"
+#include "tap/control/command_scheduler.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap::control;
+using tap::benchmark::measureNsPerOp;
+using tap::benchmark::report;
+
+/**
+ * Lightweight subsystem and command used to measure scheduler overhead. gmock objects are not
+ * used here since their call bookkeeping would dominate the measurement.
+ */
+class BenchmarkSubsystem : public Subsystem
+{
+public:
+    BenchmarkSubsystem(tap::Drivers *drivers) : Subsystem(drivers) {}
+    void refresh() override { refreshCount++; }
+    int refreshCount = 0;
+};
+
+class BenchmarkCommand : public Command
+{
+public:
+    BenchmarkCommand(Subsystem *sub) { addSubsystemRequirement(sub); }
+    const char *getName() const override { return "benchmark"; }
+    void initialize() override {}
+    void execute() override { executeCount++; }
+    void end(bool) override {}
+    bool isFinished() const override { return false; }
+    int executeCount = 0;
+};
+
+/**
+ * A master scheduler with `count` subsystems registered, each with one command requiring it.
+ */
+struct BenchmarkSchedulerFixture
+{
+    BenchmarkSchedulerFixture(int count) : scheduler(&drivers, true)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            subs.emplace_back(new BenchmarkSubsystem(&drivers));
+            cmds.emplace_back(new BenchmarkCommand(subs.back().get()));
+            scheduler.registerSubsystem(subs.back().get());
+        }
+    }
+
+    void addAllCommands()
+    {
+        for (auto &cmd : cmds)
+        {
+            scheduler.addCommand(cmd.get());
+        }
+    }
+
+    tap::Drivers drivers;
+    CommandScheduler scheduler;
+    std::vector<std::unique_ptr<BenchmarkSubsystem>> subs;
+    std::vector<std::unique_ptr<BenchmarkCommand>> cmds;
+};
+
+static constexpr int ITERATIONS = 20'000;
+static constexpr int COMMAND_COUNTS[] = {1, 8, 16, 32, 48};
+
+TEST(BenchmarkCommandScheduler, run)
+{
+    for (int count : COMMAND_COUNTS)
+    {
+        BenchmarkSchedulerFixture fixture(count);
+        fixture.addAllCommands();
+        ASSERT_EQ(count, fixture.scheduler.commandListSize());
+
+        report(
+            "CommandScheduler",
+            "run",
+            count,
+            measureNsPerOp(ITERATIONS, [&]() { fixture.scheduler.run(); }));
+
+        EXPECT_GE(fixture.cmds[0]->executeCount, ITERATIONS);
+        EXPECT_GE(fixture.subs[0]->refreshCount, ITERATIONS);
+    }
+}
+
+TEST(BenchmarkCommandScheduler, run_subsystems_only)
+{
+    for (int count : COMMAND_COUNTS)
+    {
+        BenchmarkSchedulerFixture fixture(count);
+
+        report(
+            "CommandScheduler",
+            "run_subsystems_only",
+            count,
+            measureNsPerOp(ITERATIONS, [&]() { fixture.scheduler.run(); }));
+    }
+}
+
+TEST(BenchmarkCommandScheduler, addCommand_interrupting)
+{
+    for (int count : COMMAND_COUNTS)
+    {
+        BenchmarkSchedulerFixture fixture(count);
+        fixture.addAllCommands();
+
+        // Re-adding a scheduled command interrupts and replaces the existing instance
+        int i = 0;
+        report(
+            "CommandScheduler",
+            "addCommand_interrupting",
+            count,
+            measureNsPerOp(ITERATIONS, [&]() {
+                fixture.scheduler.addCommand(fixture.cmds[i++ % count].get());
+            }));
+
+        EXPECT_EQ(count, fixture.scheduler.commandListSize());
+    }
+}
+
+TEST(BenchmarkCommandScheduler, addCommand_removeCommand)
+{
+    for (int count : COMMAND_COUNTS)
+    {
+        BenchmarkSchedulerFixture fixture(count);
+        fixture.addAllCommands();
+
+        // Remove and re-add one command while the rest stay scheduled
+        int i = 0;
+        report(
+            "CommandScheduler",
+            "addCommand_removeCommand",
+            count,
+            measureNsPerOp(ITERATIONS, [&]() {
+                BenchmarkCommand *cmd = fixture.cmds[i++ % count].get();
+                fixture.scheduler.removeCommand(cmd, true);
+                fixture.scheduler.addCommand(cmd);
+            }));
+
+        EXPECT_EQ(count, fixture.scheduler.commandListSize());
+    }
+}
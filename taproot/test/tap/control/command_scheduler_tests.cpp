@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can_rx_handler.hpp"
+#include "tap/control/command_scheduler.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/can_rx_listener_mock.hpp"
+#include "tap/mock/command_mock.hpp"
+#include "tap/mock/subsystem_mock.hpp"
+
+using namespace tap::control;
+using namespace testing;
+
+TEST(CommandScheduler, addCommand_interrupts_only_commands_sharing_requirements)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers);
+    NiceMock<tap::mock::SubsystemMock> s1(&drivers), s2(&drivers), s3(&drivers);
+    NiceMock<tap::mock::CommandMock> c1, c2, c3;
+
+    const auto s1Bit = subsystem_scheduler_bitmap_t::oneHot(s1.getGlobalIdentifier());
+    const auto s2Bit = subsystem_scheduler_bitmap_t::oneHot(s2.getGlobalIdentifier());
+    const auto s3Bit = subsystem_scheduler_bitmap_t::oneHot(s3.getGlobalIdentifier());
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(s1Bit));
+    ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(s2Bit));
+    ON_CALL(c3, getRequirementsBitwise).WillByDefault(Return(s2Bit | s3Bit));
+
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+    scheduler.registerSubsystem(&s3);
+
+    scheduler.addCommand(&c1);
+    scheduler.addCommand(&c2);
+
+    EXPECT_CALL(c1, end).Times(0);
+    EXPECT_CALL(c2, end(true));
+    scheduler.addCommand(&c3);
+
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c1));
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c2));
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c3));
+    EXPECT_EQ(2, scheduler.commandListSize());
+    EXPECT_EQ(3, scheduler.subsystemListSize());
+}
+
+TEST(CommandScheduler, addCommand_interrupts_every_command_owning_a_requirement)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers);
+    NiceMock<tap::mock::SubsystemMock> s1(&drivers), s2(&drivers);
+    NiceMock<tap::mock::CommandMock> c1, c2, c3;
+
+    const auto s1Bit = subsystem_scheduler_bitmap_t::oneHot(s1.getGlobalIdentifier());
+    const auto s2Bit = subsystem_scheduler_bitmap_t::oneHot(s2.getGlobalIdentifier());
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(s1Bit));
+    ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(s2Bit));
+    ON_CALL(c3, getRequirementsBitwise).WillByDefault(Return(s1Bit | s2Bit));
+
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+    scheduler.addCommand(&c1);
+    scheduler.addCommand(&c2);
+
+    EXPECT_CALL(c1, end(true));
+    EXPECT_CALL(c2, end(true));
+    scheduler.addCommand(&c3);
+
+    EXPECT_EQ(1, scheduler.commandListSize());
+
+    // Re-adding c1 must in turn interrupt c3, which now owns s1
+    EXPECT_CALL(c3, end(true));
+    scheduler.addCommand(&c1);
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c1));
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c3));
+}
+
+TEST(CommandScheduler, run_records_command_and_subsystem_execution_times)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<tap::mock::SubsystemMock> sub(&drivers);
+    NiceMock<tap::mock::CommandMock> cmd;
+
+    ON_CALL(cmd, getRequirementsBitwise)
+        .WillByDefault(
+            Return(subsystem_scheduler_bitmap_t::oneHot(sub.getGlobalIdentifier())));
+    ON_CALL(cmd, execute).WillByDefault([&]() {
+        tap::arch::clock::setTime(tap::arch::clock::getTimeMilliseconds() + 2);
+    });
+    ON_CALL(sub, refresh).WillByDefault([&]() {
+        tap::arch::clock::setTime(tap::arch::clock::getTimeMilliseconds() + 1);
+    });
+
+    scheduler.registerSubsystem(&sub);
+    scheduler.addCommand(&cmd);
+    scheduler.run();
+    scheduler.run();
+
+    const auto &cmdStats = CommandScheduler::getCommandExecutionTime(cmd.getGlobalIdentifier());
+    EXPECT_EQ(2u, cmdStats.samples);
+    EXPECT_EQ(2000u, cmdStats.mean());
+    EXPECT_EQ(2000u, cmdStats.max);
+    // the command is the slowest item in every run and each run is over budget
+    EXPECT_EQ(2u, cmdStats.overruns);
+
+    const auto &subStats = CommandScheduler::getSubsystemRefreshTime(sub.getGlobalIdentifier());
+    EXPECT_EQ(2u, subStats.samples);
+    EXPECT_EQ(1000u, subStats.min);
+    EXPECT_EQ(0u, subStats.overruns);
+
+    CommandScheduler::resetExecutionTimes();
+    EXPECT_EQ(0u, CommandScheduler::getCommandExecutionTime(cmd.getGlobalIdentifier()).samples);
+}
+
+TEST(CommandScheduler, run_executes_rate_limited_items_at_their_period)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<tap::mock::SubsystemMock> fastSub(&drivers), slowSub(&drivers);
+    NiceMock<tap::mock::CommandMock> fastCmd, slowCmd;
+
+    ON_CALL(fastCmd, getRequirementsBitwise)
+        .WillByDefault(
+            Return(subsystem_scheduler_bitmap_t::oneHot(fastSub.getGlobalIdentifier())));
+    ON_CALL(slowCmd, getRequirementsBitwise)
+        .WillByDefault(
+            Return(subsystem_scheduler_bitmap_t::oneHot(slowSub.getGlobalIdentifier())));
+
+    scheduler.setRunPeriod(1'000);
+    slowSub.setSchedulingPeriod(10'000);
+    slowCmd.setSchedulingPeriod(100'000);
+
+    scheduler.registerSubsystem(&fastSub);
+    scheduler.registerSubsystem(&slowSub);
+    scheduler.addCommand(&fastCmd);
+    scheduler.addCommand(&slowCmd);
+
+    EXPECT_CALL(fastSub, refresh).Times(100);
+    EXPECT_CALL(fastCmd, execute).Times(100);
+    EXPECT_CALL(slowSub, refresh).Times(10);
+    EXPECT_CALL(slowCmd, execute).Times(1);
+
+    for (int i = 0; i < 100; i++)
+    {
+        scheduler.run();
+    }
+}
+
+TEST(CommandScheduler, run_rounds_scheduling_periods_to_the_nearest_number_of_runs)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<tap::mock::SubsystemMock> sub(&drivers), otherSub(&drivers);
+    NiceMock<tap::mock::CommandMock> shortCmd, unevenCmd;
+
+    ON_CALL(shortCmd, getRequirementsBitwise)
+        .WillByDefault(Return(subsystem_scheduler_bitmap_t::oneHot(sub.getGlobalIdentifier())));
+    ON_CALL(unevenCmd, getRequirementsBitwise)
+        .WillByDefault(
+            Return(subsystem_scheduler_bitmap_t::oneHot(otherSub.getGlobalIdentifier())));
+
+    scheduler.setRunPeriod(2'000);
+    // Faster than the scheduler runs, so every run
+    shortCmd.setSchedulingPeriod(1'000);
+    // 1.5 runs, rounded to 2
+    unevenCmd.setSchedulingPeriod(3'000);
+    // 4.5 runs, rounded to 5
+    sub.setSchedulingPeriod(9'000);
+
+    scheduler.registerSubsystem(&sub);
+    scheduler.registerSubsystem(&otherSub);
+    scheduler.addCommand(&shortCmd);
+    scheduler.addCommand(&unevenCmd);
+
+    EXPECT_CALL(shortCmd, execute).Times(100);
+    EXPECT_CALL(unevenCmd, execute).Times(50);
+    EXPECT_CALL(sub, refresh).Times(20);
+
+    for (int i = 0; i < 100; i++)
+    {
+        scheduler.run();
+    }
+}
+
+TEST(CommandScheduler, run_defers_best_effort_items_once_the_budget_is_used_up)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<tap::mock::SubsystemMock> controlSub(&drivers), bestEffortSub(&drivers);
+    NiceMock<tap::mock::CommandMock> controlCmd, bestEffortCmd;
+
+    ON_CALL(controlCmd, getRequirementsBitwise)
+        .WillByDefault(
+            Return(subsystem_scheduler_bitmap_t::oneHot(controlSub.getGlobalIdentifier())));
+    ON_CALL(bestEffortCmd, getRequirementsBitwise)
+        .WillByDefault(
+            Return(subsystem_scheduler_bitmap_t::oneHot(bestEffortSub.getGlobalIdentifier())));
+
+    bestEffortSub.setSchedulingPriority(SchedulingPriority::BEST_EFFORT);
+    bestEffortCmd.setSchedulingPriority(SchedulingPriority::BEST_EFFORT);
+    scheduler.setRunBudget(500);
+
+    scheduler.registerSubsystem(&controlSub);
+    scheduler.registerSubsystem(&bestEffortSub);
+    scheduler.addCommand(&controlCmd);
+    scheduler.addCommand(&bestEffortCmd);
+
+    // The control command uses up the whole budget in the first run only
+    int controlExecutions = 0, bestEffortExecutions = 0, bestEffortRefreshes = 0;
+    ON_CALL(controlCmd, execute).WillByDefault([&]() {
+        if (controlExecutions++ == 0)
+        {
+            tap::arch::clock::setTime(tap::arch::clock::getTimeMilliseconds() + 1);
+        }
+    });
+    ON_CALL(bestEffortCmd, execute).WillByDefault([&]() { bestEffortExecutions++; });
+    ON_CALL(bestEffortSub, refresh).WillByDefault([&]() { bestEffortRefreshes++; });
+    EXPECT_CALL(controlSub, refresh).Times(2);
+
+    scheduler.run();
+
+    EXPECT_EQ(1, controlExecutions);
+    EXPECT_EQ(0, bestEffortExecutions);
+    EXPECT_EQ(0, bestEffortRefreshes);
+    EXPECT_EQ(
+        1u,
+        CommandScheduler::getCommandExecutionTime(bestEffortCmd.getGlobalIdentifier()).deferrals);
+    EXPECT_EQ(
+        1u,
+        CommandScheduler::getSubsystemRefreshTime(bestEffortSub.getGlobalIdentifier())
+            .deferrals);
+
+    scheduler.run();
+
+    EXPECT_EQ(2, controlExecutions);
+    EXPECT_EQ(1, bestEffortExecutions);
+    EXPECT_EQ(1, bestEffortRefreshes);
+}
+
+TEST(CommandScheduler, run_executes_triggered_command_on_new_feedback_or_timeout)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<tap::mock::SubsystemMock> sub(&drivers);
+    NiceMock<tap::mock::CommandMock> cmd;
+    NiceMock<tap::mock::CanRxListenerMock> motor(&drivers, 0x201, tap::can::CanBus::CAN_BUS1);
+    tap::can::CanRxHandler canRxHandler(&drivers);
+    tap::can::CanRxListener *handlerStore[tap::can::CanRxHandler::NUM_CAN_IDS] = {};
+    handlerStore[tap::can::CanRxHandler::lookupTableIndexForCanId(0x201)] = &motor;
+    modm::can::Message feedback(0x201, 8);
+
+    ON_CALL(cmd, getRequirementsBitwise)
+        .WillByDefault(Return(subsystem_scheduler_bitmap_t::oneHot(sub.getGlobalIdentifier())));
+    cmd.getTrigger().addSource(&motor);
+    cmd.getTrigger().setTimeout(10'000);
+
+    scheduler.registerSubsystem(&sub);
+    scheduler.addCommand(&cmd);
+
+    tap::arch::clock::setTime(1'000);
+
+    // No new feedback since the source was added, so only the timeout fires
+    EXPECT_CALL(cmd, execute).Times(1);
+    scheduler.run();
+    scheduler.run();
+    Mock::VerifyAndClearExpectations(&cmd);
+
+    EXPECT_CALL(cmd, execute).Times(1);
+    canRxHandler.processReceivedCanData(feedback, 0, handlerStore);
+    scheduler.run();
+    scheduler.run();
+    Mock::VerifyAndClearExpectations(&cmd);
+
+    EXPECT_CALL(cmd, execute).Times(1);
+    tap::arch::clock::setTime(tap::arch::clock::getTimeMilliseconds() + 10);
+    scheduler.run();
+    EXPECT_EQ(2u, cmd.getTrigger().getTimeoutCount());
+}
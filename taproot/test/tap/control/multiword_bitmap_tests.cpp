@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/control/multiword_bitmap.hpp"
+
+using tap::control::MultiwordBitmap;
+
+TEST(MultiwordBitmap, single_word_set_reset_test_and_count)
+{
+    MultiwordBitmap<64> bitmap;
+    EXPECT_TRUE(bitmap.none());
+    EXPECT_EQ(-1, bitmap.findFirst());
+
+    bitmap.set(0);
+    bitmap.set(63);
+    EXPECT_TRUE(bitmap.test(0));
+    EXPECT_TRUE(bitmap.test(63));
+    EXPECT_FALSE(bitmap.test(1));
+    EXPECT_EQ(2, bitmap.count());
+
+    bitmap.reset(0);
+    EXPECT_EQ(63, bitmap.findFirst());
+    EXPECT_EQ(1, bitmap.count());
+}
+
+TEST(MultiwordBitmap, findNext_crosses_word_boundaries)
+{
+    MultiwordBitmap<150> bitmap;
+    bitmap.set(3);
+    bitmap.set(64);
+    bitmap.set(149);
+
+    EXPECT_EQ(3, bitmap.findFirst());
+    EXPECT_EQ(64, bitmap.findNext(4));
+    EXPECT_EQ(64, bitmap.findNext(64));
+    EXPECT_EQ(149, bitmap.findNext(65));
+    EXPECT_EQ(-1, bitmap.findNext(150));
+    EXPECT_EQ(-1, bitmap.findNext(-1));
+    EXPECT_EQ(3, bitmap.count());
+}
+
+TEST(MultiwordBitmap, bitwise_operators_work_across_words)
+{
+    auto a = MultiwordBitmap<150>::oneHot(10) | MultiwordBitmap<150>::oneHot(100);
+    auto b = MultiwordBitmap<150>::oneHot(100) | MultiwordBitmap<150>::oneHot(140);
+
+    EXPECT_EQ(MultiwordBitmap<150>::oneHot(100), a & b);
+    EXPECT_EQ(3, (a | b).count());
+    EXPECT_NE(a, b);
+    EXPECT_FALSE(a & MultiwordBitmap<150>::oneHot(11));
+
+    a &= ~b;
+    EXPECT_EQ(MultiwordBitmap<150>::oneHot(10), a);
+}
+
+TEST(MultiwordBitmap, complement_does_not_set_bits_past_size)
+{
+    MultiwordBitmap<70> bitmap;
+    EXPECT_EQ(70, (~bitmap).count());
+    EXPECT_EQ(-1, (~bitmap).findNext(70));
+
+    bitmap.reset();
+    bitmap.set(5);
+    bitmap.reset();
+    EXPECT_TRUE(bitmap.none());
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef RUN_WITH_SCHEDULER_TRACE
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/control/scheduler_terminal_handler.hpp"
+#include "tap/control/scheduler_trace.hpp"
+#include "tap/drivers.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace tap::control;
+using namespace testing;
+
+/**
+ * Decodes the "R" lines of a `scheduler trace` dump the way decode_scheduler_trace.py does,
+ * as little endian records laid out in `SchedulerTraceRecord` field order.
+ */
+static std::vector<SchedulerTraceRecord> decodeTraceDump(
+    const std::string &dump,
+    int *size,
+    uint32_t *dropped)
+{
+    std::vector<SchedulerTraceRecord> records;
+    std::istringstream lines(dump);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        if (line.rfind("trace begin ", 0) == 0)
+        {
+            std::istringstream(line.substr(12)) >> *size >> *dropped;
+        }
+        else if (line.rfind("R ", 0) == 0)
+        {
+            EXPECT_EQ(2 + 2 * sizeof(SchedulerTraceRecord), line.size()) << line;
+            uint8_t bytes[sizeof(SchedulerTraceRecord)];
+            for (size_t i = 0; i < sizeof(bytes); i++)
+            {
+                bytes[i] = std::stoul(line.substr(2 + 2 * i, 2), nullptr, 16);
+            }
+            SchedulerTraceRecord record;
+            record.time = bytes[0] | bytes[1] << 8 | bytes[2] << 16 |
+                          static_cast<uint32_t>(bytes[3]) << 24;
+            record.id = bytes[4] | bytes[5] << 8;
+            record.event = bytes[6];
+            record.arg = bytes[7];
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+TEST(SchedulerTrace, record_overwrites_oldest_records_once_full)
+{
+    SchedulerTrace::clear();
+    EXPECT_EQ(0, SchedulerTrace::size());
+
+    for (int i = 0; i < SchedulerTrace::CAPACITY + 3; i++)
+    {
+        SchedulerTrace::record(SchedulerTraceEvent::EXECUTE_START, i, i * 10, 0);
+    }
+
+    EXPECT_EQ(SchedulerTrace::CAPACITY, SchedulerTrace::size());
+    EXPECT_EQ(3u, SchedulerTrace::getDroppedCount());
+    EXPECT_EQ(3, SchedulerTrace::get(0).id);
+    EXPECT_EQ(30u, SchedulerTrace::get(0).time);
+    EXPECT_EQ(SchedulerTrace::CAPACITY + 2, SchedulerTrace::get(SchedulerTrace::CAPACITY - 1).id);
+
+    SchedulerTrace::clear();
+    EXPECT_EQ(0, SchedulerTrace::size());
+    EXPECT_EQ(0u, SchedulerTrace::getDroppedCount());
+}
+
+TEST(SchedulerTrace, terminal_dump_decodes_to_recorded_events_oldest_first)
+{
+    tap::Drivers drivers;
+    SchedulerTerminalHandler handler(&drivers);
+    tap::stub::TerminalDeviceStub terminalDevice(&drivers);
+    modm::IOStream stream(terminalDevice);
+
+    // Wrap the ring so the dump has to start part way through it
+    SchedulerTrace::clear();
+    for (int i = 0; i < SchedulerTrace::CAPACITY - 1; i++)
+    {
+        SchedulerTrace::record(SchedulerTraceEvent::REFRESH_START, 0, 0, 0);
+    }
+    SchedulerTrace::record(SchedulerTraceEvent::ADD_COMMAND, 0x0102, 0x12345678, 0);
+    SchedulerTrace::record(SchedulerTraceEvent::REMOVE_COMMAND, 0x0a0b, 0xfedcba98, 1);
+    SchedulerTrace::record(SchedulerTraceEvent::SAFE_DISCONNECT, 0, 0x00000100, 0);
+
+    char input[] = "trace";
+    handler.terminalSerialCallback(input, stream, false);
+
+    int size = 0;
+    uint32_t dropped = 0;
+    std::vector<SchedulerTraceRecord> records =
+        decodeTraceDump(terminalDevice.readAllItemsFromWriteBufferToString(), &size, &dropped);
+    SchedulerTrace::clear();
+
+    EXPECT_EQ(SchedulerTrace::CAPACITY, size);
+    EXPECT_EQ(2u, dropped);
+    ASSERT_EQ(static_cast<size_t>(SchedulerTrace::CAPACITY), records.size());
+
+    const SchedulerTraceRecord &add = records[SchedulerTrace::CAPACITY - 3];
+    EXPECT_EQ(0x12345678u, add.time);
+    EXPECT_EQ(0x0102, add.id);
+    EXPECT_EQ(static_cast<uint8_t>(SchedulerTraceEvent::ADD_COMMAND), add.event);
+    EXPECT_EQ(0, add.arg);
+
+    const SchedulerTraceRecord &remove = records[SchedulerTrace::CAPACITY - 2];
+    EXPECT_EQ(0xfedcba98u, remove.time);
+    EXPECT_EQ(0x0a0b, remove.id);
+    EXPECT_EQ(static_cast<uint8_t>(SchedulerTraceEvent::REMOVE_COMMAND), remove.event);
+    EXPECT_EQ(1, remove.arg);
+
+    const SchedulerTraceRecord &disconnect = records[SchedulerTrace::CAPACITY - 1];
+    EXPECT_EQ(0x100u, disconnect.time);
+    EXPECT_EQ(static_cast<uint8_t>(SchedulerTraceEvent::SAFE_DISCONNECT), disconnect.event);
+}
+
+#endif
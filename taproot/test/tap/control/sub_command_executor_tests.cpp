@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/control/sub_command_executor.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/command_mock.hpp"
+#include "tap/mock/subsystem_mock.hpp"
+
+using namespace tap::control;
+using namespace testing;
+
+TEST(SubCommandExecutor, addCommand_interrupts_commands_sharing_requirements)
+{
+    tap::Drivers drivers;
+    SubCommandExecutor executor(&drivers);
+    NiceMock<tap::mock::SubsystemMock> s1(&drivers), s2(&drivers);
+    NiceMock<tap::mock::CommandMock> c1, c2, c3;
+
+    const auto s1Bit = subsystem_scheduler_bitmap_t::oneHot(s1.getGlobalIdentifier());
+    const auto s2Bit = subsystem_scheduler_bitmap_t::oneHot(s2.getGlobalIdentifier());
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(s1Bit));
+    ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(s2Bit));
+    ON_CALL(c3, getRequirementsBitwise).WillByDefault(Return(s1Bit));
+
+    executor.registerSubsystem(&s1);
+    executor.registerSubsystem(&s2);
+
+    EXPECT_CALL(c1, initialize);
+    EXPECT_CALL(c2, initialize);
+    executor.addCommand(&c1);
+    executor.addCommand(&c2);
+    EXPECT_EQ(2, executor.commandListSize());
+
+    EXPECT_CALL(c1, end(true));
+    EXPECT_CALL(c2, end).Times(0);
+    EXPECT_CALL(c3, initialize);
+    executor.addCommand(&c3);
+
+    EXPECT_FALSE(executor.isCommandScheduled(&c1));
+    EXPECT_TRUE(executor.isCommandScheduled(&c2));
+    EXPECT_TRUE(executor.isCommandScheduled(&c3));
+}
+
+TEST(SubCommandExecutor, run_executes_commands_and_ends_finished_ones)
+{
+    tap::Drivers drivers;
+    SubCommandExecutor executor(&drivers);
+    NiceMock<tap::mock::SubsystemMock> s1(&drivers), s2(&drivers);
+    NiceMock<tap::mock::CommandMock> c1, c2;
+
+    ON_CALL(c1, getRequirementsBitwise)
+        .WillByDefault(Return(subsystem_scheduler_bitmap_t::oneHot(s1.getGlobalIdentifier())));
+    ON_CALL(c2, getRequirementsBitwise)
+        .WillByDefault(Return(subsystem_scheduler_bitmap_t::oneHot(s2.getGlobalIdentifier())));
+    ON_CALL(c1, isFinished).WillByDefault(Return(true));
+
+    executor.registerSubsystem(&s1);
+    executor.registerSubsystem(&s2);
+    executor.addCommand(&c1);
+    executor.addCommand(&c2);
+
+    EXPECT_CALL(c1, execute).Times(1);
+    EXPECT_CALL(c1, end(false));
+    EXPECT_CALL(c2, execute).Times(2);
+    EXPECT_CALL(s1, refresh).Times(0);
+    EXPECT_CALL(s2, refresh).Times(0);
+
+    executor.run();
+    executor.run();
+
+    EXPECT_EQ(1, executor.commandListSize());
+}
+
+TEST(SubCommandExecutor, run_executes_commands_in_the_order_they_were_added)
+{
+    tap::Drivers drivers;
+    SubCommandExecutor executor(&drivers);
+    NiceMock<tap::mock::SubsystemMock> s1(&drivers), s2(&drivers), s3(&drivers);
+    NiceMock<tap::mock::CommandMock> c1, c2, c3, c4;
+
+    ON_CALL(c1, getRequirementsBitwise)
+        .WillByDefault(Return(subsystem_scheduler_bitmap_t::oneHot(s1.getGlobalIdentifier())));
+    ON_CALL(c2, getRequirementsBitwise)
+        .WillByDefault(Return(subsystem_scheduler_bitmap_t::oneHot(s2.getGlobalIdentifier())));
+    ON_CALL(c3, getRequirementsBitwise)
+        .WillByDefault(Return(subsystem_scheduler_bitmap_t::oneHot(s3.getGlobalIdentifier())));
+    ON_CALL(c4, getRequirementsBitwise)
+        .WillByDefault(Return(subsystem_scheduler_bitmap_t::oneHot(s1.getGlobalIdentifier())));
+
+    executor.registerSubsystem(&s1);
+    executor.registerSubsystem(&s2);
+    executor.registerSubsystem(&s3);
+    executor.addCommand(&c1);
+    executor.addCommand(&c2);
+    executor.addCommand(&c3);
+
+    // c4 takes over c1's requirement, but runs after the Commands added before it
+    executor.removeCommand(&c1, false);
+    executor.addCommand(&c4);
+
+    {
+        InSequence sequence;
+        EXPECT_CALL(c2, execute);
+        EXPECT_CALL(c3, execute);
+        EXPECT_CALL(c4, execute);
+    }
+    EXPECT_CALL(c1, execute).Times(0);
+
+    executor.run();
+}
+
+TEST(SubCommandExecutor, addCommand_with_unregistered_requirement_raises_error)
+{
+    tap::Drivers drivers;
+    SubCommandExecutor executor(&drivers);
+    NiceMock<tap::mock::SubsystemMock> s1(&drivers);
+    NiceMock<tap::mock::CommandMock> c1;
+
+    ON_CALL(c1, getRequirementsBitwise)
+        .WillByDefault(Return(subsystem_scheduler_bitmap_t::oneHot(s1.getGlobalIdentifier())));
+
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+    EXPECT_CALL(c1, initialize).Times(0);
+    executor.addCommand(&c1);
+
+    EXPECT_FALSE(executor.isCommandScheduled(&c1));
+}
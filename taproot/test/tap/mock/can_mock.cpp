@@ -21,6 +21,6 @@
 
 namespace tap::mock
 {
-CanMock::CanMock() {}
+CanMock::CanMock(tap::can::CanStats *stats) : tap::can::Can(stats) {}
 CanMock::~CanMock() {}
 }  // namespace tap::mock
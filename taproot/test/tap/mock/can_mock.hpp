@@ -33,18 +33,41 @@ namespace mock
 class CanMock : public tap::can::Can
 {
 public:
-    CanMock();
+    explicit CanMock(tap::can::CanStats *stats = nullptr);
     virtual ~CanMock();
 
     MOCK_METHOD(void, initialize, (), (override));
+    MOCK_METHOD(
+        void,
+        setRxFilters,
+        (tap::can::CanBus bus, const tap::can::CanIdFilter *filters, int numFilters),
+        (override));
     MOCK_METHOD(bool, isMessageAvailable, (tap::can::CanBus bus), (const override));
-    MOCK_METHOD(bool, getMessage, (tap::can::CanBus bus, modm::can::Message *message), (override));
+    MOCK_METHOD(
+        bool,
+        getMessage,
+        (tap::can::CanBus bus, modm::can::Message *message, uint32_t *timestamp),
+        (override));
     MOCK_METHOD(bool, isReadyToSend, (tap::can::CanBus bus), (const override));
     MOCK_METHOD(
         bool,
         sendMessage,
         (tap::can::CanBus bus, const modm::can::Message &message),
         (override));
+    MOCK_METHOD(
+        bool,
+        queueMessage,
+        (tap::can::CanBus bus,
+         const modm::can::Message &message,
+         tap::can::CanTxPriority priority,
+         uint32_t maxAge),
+        (override));
+    MOCK_METHOD(
+        tap::can::CanTxQueue::Stats,
+        getTxQueueStats,
+        (tap::can::CanBus bus, tap::can::CanTxPriority priority),
+        (const override));
+    MOCK_METHOD(uint32_t, getRxOverflowCount, (tap::can::CanBus bus), (const override));
 };  // class CanMock
 }  // namespace mock
 }  // namespace tap
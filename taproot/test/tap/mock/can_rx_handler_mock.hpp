@@ -37,6 +37,7 @@ public:
     CanRxHandlerMock(tap::Drivers* drivers);
     virtual ~CanRxHandlerMock();
 
+    MOCK_METHOD(void, initialize, (), (override));
     MOCK_METHOD(void, attachReceiveHandler, (tap::can::CanRxListener* const listener), (override));
     MOCK_METHOD(void, pollCanData, (), (override));
     MOCK_METHOD(
@@ -44,6 +45,7 @@ public:
         removeReceiveHandler,
         (const tap::can::CanRxListener& rxListener),
         (override));
+    MOCK_METHOD(void, setDrainLimits, (int maxFramesPerBus, uint32_t timeBudget), (override));
 };  // class CanRxHandlerMock
 }  // namespace mock
 }  // namespace tap
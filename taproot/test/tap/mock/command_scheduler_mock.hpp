@@ -42,6 +42,10 @@ public:
     MOCK_METHOD(bool, isCommandScheduled, (const control::Command *), (const override));
     MOCK_METHOD(void, registerSubsystem, (control::Subsystem *), (override));
     MOCK_METHOD(bool, isSubsystemRegistered, (const control::Subsystem *), (const override));
+    MOCK_METHOD(void, setRunPeriod, (uint32_t), (override));
+    MOCK_METHOD(uint32_t, getRunPeriod, (), (const override));
+    MOCK_METHOD(void, setRunBudget, (uint32_t), (override));
+    MOCK_METHOD(uint32_t, getRunBudget, (), (const override));
     MOCK_METHOD(void, startHardwareTests, (), (override));
     MOCK_METHOD(void, stopHardwareTests, (), (override));
     MOCK_METHOD(int, subsystemListSize, (), (const override));
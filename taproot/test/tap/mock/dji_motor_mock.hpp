@@ -57,9 +57,17 @@ public:
     MOCK_METHOD(int8_t, getTemperature, (), (const override));
     MOCK_METHOD(int16_t, getTorque, (), (const override));
     MOCK_METHOD(int16_t, getShaftRPM, (), (const override));
+    MOCK_METHOD(float, getEncoderVelocity, (), (const override));
+    MOCK_METHOD(float, getEncoderAcceleration, (), (const override));
+    MOCK_METHOD(
+        void,
+        setVelocityEstimator,
+        (const tap::motor::EncoderVelocityEstimator::Config& config),
+        (override));
     MOCK_METHOD(bool, isMotorInverted, (), (const override));
     MOCK_METHOD(tap::can::CanBus, getCanBus, (), (const override));
     MOCK_METHOD(const char*, getName, (), (const override));
+    MOCK_METHOD(void, recordCommandSent, (uint32_t time), (override));
 
 };  // class DjiMotor
 
@@ -38,6 +38,7 @@ public:
 
     MOCK_METHOD(void, addMotorToManager, (tap::motor::DjiMotor * motor), (override));
     MOCK_METHOD(void, processCanSendData, (), (override));
+    MOCK_METHOD(void, sendTxFrames, (uint8_t frameMask, uint32_t maxAge), (override));
     MOCK_METHOD(void, removeFromMotorManager, (const tap::motor::DjiMotor &motor), (override));
     MOCK_METHOD(
         const tap::motor::DjiMotor *,
@@ -49,6 +50,8 @@ public:
         getCan2Motor,
         (tap::motor::MotorId motorId),
         (override));
+    MOCK_METHOD(void, setLatencyMeasurementEnabled, (bool enabled), (override));
+    MOCK_METHOD(bool, isLatencyMeasurementEnabled, (), (const override));
 };  // class DjiMotorTxHandlerMock
 }  // namespace mock
 }  // namespace tap
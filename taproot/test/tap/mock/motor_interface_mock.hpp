@@ -43,6 +43,7 @@ public:
     MOCK_METHOD(int8_t, getTemperature, (), (const override));
     MOCK_METHOD(int16_t, getTorque, (), (const override));
     MOCK_METHOD(int16_t, getShaftRPM, (), (const override));
+    MOCK_METHOD(float, getEncoderVelocity, (), (const override));
 };
 
 }  // namespace tap::mock
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/motor/command_latency_tracker.hpp"
+
+using namespace tap::motor;
+
+TEST(CommandLatencyTracker, measures_time_until_torque_responds_to_a_command_step)
+{
+    CommandLatencyTracker tracker;
+
+    // Small changes in command aren't measured
+    tracker.onFeedback(100, 0);
+    tracker.onCommandSent(500, 1'000);
+    tracker.onFeedback(800, 1'500);
+    EXPECT_EQ(0u, tracker.getHistogram().getCount());
+
+    // A feedback frame received before the command was sent, then one with too little response
+    tracker.onCommandSent(-3'000, 10'000);
+    tracker.onFeedback(700, 9'900);
+    tracker.onFeedback(650, 10'800);
+    tracker.onFeedback(500, 11'200);
+    EXPECT_EQ(1u, tracker.getHistogram().getCount());
+    EXPECT_EQ(1'200u, tracker.getHistogram().getMax());
+
+    // No response at all
+    tracker.onCommandSent(3'000, 20'000);
+    tracker.onFeedback(500, 20'000 + CommandLatencyTracker::RESPONSE_TIMEOUT + 1);
+    EXPECT_EQ(1u, tracker.getHistogram().getCount());
+    EXPECT_EQ(1u, tracker.getTimeouts());
+
+    tracker.reset();
+    EXPECT_EQ(0u, tracker.getHistogram().getCount());
+    EXPECT_EQ(0u, tracker.getTimeouts());
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can_rx_handler.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/can_rx_listener_mock.hpp"
+#include "tap/motor/dji_motor.hpp"
+
+using namespace tap::motor;
+using namespace testing;
+using tap::can::CanBus;
+
+static modm::can::Message feedback(uint32_t id, uint16_t encoder, int16_t rpm, int16_t torque)
+{
+    modm::can::Message message(id, 8);
+    message.data[0] = encoder >> 8;
+    message.data[1] = encoder & 0xFF;
+    message.data[2] = static_cast<uint16_t>(rpm) >> 8;
+    message.data[3] = rpm & 0xFF;
+    message.data[4] = static_cast<uint16_t>(torque) >> 8;
+    message.data[5] = torque & 0xFF;
+    message.data[6] = 40;
+    return message;
+}
+
+TEST(DjiMotorBank, decode_updates_registered_slots_only)
+{
+    tap::Drivers drivers;
+    DjiMotorBank &bank = drivers.djiMotorBankCan1;
+    DjiMotor motor(&drivers, MOTOR3, CanBus::CAN_BUS1, true, "motor", 100, 2);
+    tap::arch::clock::setTime(1'000);
+
+    EXPECT_FALSE(bank.decode(feedback(MOTOR3, 8000, 100, 200), 0));
+
+    motor.initialize();
+    EXPECT_EQ(100 + 2 * DjiMotor::ENC_RESOLUTION, motor.getEncoderUnwrapped());
+    EXPECT_FALSE(motor.isMotorOnline());
+
+    // Inverted, so the raw encoder 8000 reads as 191, a step back from 100 with no wrap
+    EXPECT_TRUE(bank.decode(feedback(MOTOR3, 8000, 100, 200), 0));
+    EXPECT_FALSE(bank.decode(feedback(MOTOR4, 8000, 100, 200), 0));
+    EXPECT_EQ(191, motor.getEncoderWrapped());
+    EXPECT_EQ(191 + 2 * DjiMotor::ENC_RESOLUTION, motor.getEncoderUnwrapped());
+    EXPECT_EQ(-100, motor.getShaftRPM());
+    EXPECT_EQ(-200, motor.getTorque());
+    EXPECT_EQ(40, motor.getTemperature());
+    EXPECT_TRUE(motor.isMotorOnline());
+
+    // Raw encoder 100 reads as 8091, wrapping back a revolution
+    EXPECT_TRUE(bank.decode(feedback(MOTOR3, 100, 0, 0), 1'000));
+    EXPECT_EQ(8091 + DjiMotor::ENC_RESOLUTION, motor.getEncoderUnwrapped());
+    EXPECT_EQ(2, motor.getFeedbackHistory().size());
+
+    tap::arch::clock::setTime(1'000 + DjiMotorBank::MOTOR_DISCONNECT_TIME);
+    EXPECT_FALSE(motor.isMotorOnline());
+}
+
+TEST(DjiMotorBank, pollCanData_decodes_motor_feedback_without_calling_the_listener)
+{
+    tap::Drivers drivers;
+    tap::can::CanRxHandler handler(&drivers);
+    DjiMotor motor(&drivers, MOTOR1, CanBus::CAN_BUS2, false, "motor");
+    NiceMock<tap::mock::CanRxListenerMock> other(&drivers, 0x210, CanBus::CAN_BUS2);
+    motor.initialize();
+    handler.attachReceiveHandler(&motor);
+    handler.attachReceiveHandler(&other);
+
+    std::vector<modm::can::Message> frames = {
+        feedback(MOTOR1, 1234, 5, 6),
+        modm::can::Message(0x210, 8)};
+    ON_CALL(drivers.can, getMessage)
+        .WillByDefault([&](CanBus bus, modm::can::Message *message, uint32_t *timestamp) {
+            if (bus != CanBus::CAN_BUS2 || frames.empty())
+            {
+                return false;
+            }
+            *message = frames.front();
+            *timestamp = 42;
+            frames.erase(frames.begin());
+            return true;
+        });
+    handler.setDrainLimits(2, 0);
+
+    EXPECT_CALL(other, processMessage).Times(1);
+    handler.pollCanData();
+
+    EXPECT_EQ(1234, motor.getEncoderWrapped());
+    EXPECT_EQ(1u, motor.getReceiveCount());
+    EXPECT_EQ(42u, motor.getReceiveTimestamp());
+}
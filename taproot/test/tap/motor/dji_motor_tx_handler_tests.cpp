@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can_rx_handler.hpp"
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor_tx_handler.hpp"
+
+using namespace tap::motor;
+using namespace testing;
+using tap::can::CanBus;
+
+TEST(DjiMotorTxHandler, processCanSendData_sends_only_frames_with_motors)
+{
+    tap::Drivers drivers;
+    DjiMotorTxHandler handler(&drivers);
+    DjiMotor motor1(&drivers, MOTOR1, CanBus::CAN_BUS1, false, "motor1");
+    DjiMotor motor6(&drivers, MOTOR6, CanBus::CAN_BUS1, false, "motor6");
+    handler.addMotorToManager(&motor1);
+    handler.addMotorToManager(&motor6);
+    motor6.setDesiredOutput(0x1234);
+    ON_CALL(drivers.commandScheduler, getRunPeriod).WillByDefault(Return(2'000));
+
+    ON_CALL(drivers.can, queueMessage).WillByDefault(Return(true));
+    EXPECT_CALL(
+        drivers.can,
+        queueMessage(
+            CanBus::CAN_BUS1,
+            Property(&modm::can::Message::getIdentifier, 0x200),
+            tap::can::CanTxPriority::CONTROL,
+            2'000));
+    EXPECT_CALL(
+        drivers.can,
+        queueMessage(CanBus::CAN_BUS1, Property(&modm::can::Message::getIdentifier, 0x1FF), _, _))
+        .WillOnce([](CanBus, const modm::can::Message &message, auto, auto) {
+            EXPECT_EQ(0x12, message.data[2]);
+            EXPECT_EQ(0x34, message.data[3]);
+            return true;
+        });
+    EXPECT_CALL(drivers.can, queueMessage(CanBus::CAN_BUS2, _, _, _)).Times(0);
+
+    handler.processCanSendData();
+
+    EXPECT_TRUE(handler.getTxFrameStats(CanBus::CAN_BUS1, false).lastSent);
+    EXPECT_EQ(1u, handler.getTxFrameStats(CanBus::CAN_BUS1, true).sent);
+    EXPECT_FALSE(handler.isTxFrameOccupied(CanBus::CAN_BUS2, false));
+
+    // Once motor 1 is gone, the 0x200 frame is no longer sent
+    handler.removeFromMotorManager(motor1);
+    EXPECT_FALSE(handler.isTxFrameOccupied(CanBus::CAN_BUS1, false));
+    EXPECT_CALL(drivers.can, queueMessage(CanBus::CAN_BUS1, _, _, _)).Times(1);
+    handler.processCanSendData();
+}
+
+TEST(DjiMotorTxHandler, processCanSendData_skips_frames_owned_by_inner_loops)
+{
+    tap::Drivers drivers;
+    DjiMotorTxHandler handler(&drivers);
+    DjiMotor looped(&drivers, MOTOR1, CanBus::CAN_BUS1, false, "looped");
+    DjiMotor plain(&drivers, MOTOR5, CanBus::CAN_BUS1, false, "plain");
+    looped.initialize();
+    handler.addMotorToManager(&looped);
+    handler.addMotorToManager(&plain);
+    drivers.motorInnerLoop.addLoop(
+        &looped,
+        MotorInnerLoopService::Mode::VELOCITY,
+        tap::algorithms::SmoothPidConfig());
+    // Only frames of online loop motors are owned
+    tap::arch::clock::setTime(1);
+    drivers.djiMotorBankCan1.decode(modm::can::Message(MOTOR1, 8), 1'000);
+
+    ON_CALL(drivers.can, queueMessage).WillByDefault(Return(true));
+    EXPECT_CALL(
+        drivers.can,
+        queueMessage(CanBus::CAN_BUS1, Property(&modm::can::Message::getIdentifier, 0x200), _, _))
+        .Times(0);
+    EXPECT_CALL(
+        drivers.can,
+        queueMessage(CanBus::CAN_BUS1, Property(&modm::can::Message::getIdentifier, 0x1FF), _, _));
+
+    handler.processCanSendData();
+}
+
+TEST(DjiMotorTxHandler, processCanSendData_does_not_retry_frames_while_the_tx_queue_is_full)
+{
+    tap::Drivers drivers;
+    DjiMotorTxHandler handler(&drivers);
+    DjiMotor motor1(&drivers, MOTOR1, CanBus::CAN_BUS1, false, "motor1");
+    DjiMotor motor2(&drivers, MOTOR1, CanBus::CAN_BUS2, false, "motor2");
+    handler.addMotorToManager(&motor1);
+    handler.addMotorToManager(&motor2);
+
+    // CAN 2's queue is full, its frame is tried once and left to the next send
+    EXPECT_CALL(drivers.can, queueMessage(CanBus::CAN_BUS1, _, _, _)).WillOnce(Return(true));
+    EXPECT_CALL(drivers.can, queueMessage(CanBus::CAN_BUS2, _, _, _)).WillOnce(Return(false));
+
+    handler.processCanSendData();
+
+    const DjiMotorTxHandler::TxFrameStats &can1 = handler.getTxFrameStats(CanBus::CAN_BUS1, false);
+    EXPECT_EQ(1u, can1.sent);
+    EXPECT_EQ(0u, can1.queueFull);
+    EXPECT_TRUE(can1.lastSent);
+    const DjiMotorTxHandler::TxFrameStats &can2 = handler.getTxFrameStats(CanBus::CAN_BUS2, false);
+    EXPECT_EQ(0u, can2.sent);
+    EXPECT_EQ(1u, can2.queueFull);
+    EXPECT_FALSE(can2.lastSent);
+    EXPECT_EQ(1u, drivers.canStats.getBusStats(CanBus::CAN_BUS2).txNotReady);
+}
+
+TEST(DjiMotorTxHandler, processCanSendData_timestamps_commands_when_measuring_latency)
+{
+    tap::Drivers drivers;
+    DjiMotorTxHandler handler(&drivers);
+    DjiMotor motor(&drivers, MOTOR2, CanBus::CAN_BUS2, false, "motor");
+    motor.initialize();
+    handler.addMotorToManager(&motor);
+    ON_CALL(drivers.can, queueMessage).WillByDefault(Return(true));
+
+    tap::can::CanRxHandler rxHandler(&drivers);
+    tap::can::CanRxListener *handlerStore[tap::can::CanRxHandler::NUM_CAN_IDS] = {};
+    handlerStore[tap::can::CanRxHandler::lookupTableIndexForCanId(MOTOR2)] = &motor;
+
+    modm::can::Message feedback(MOTOR2, 8);
+    feedback.data[4] = 0x07;
+    feedback.data[5] = 0xD0;
+
+    // Not measured until enabled
+    motor.setDesiredOutput(2'000);
+    tap::arch::clock::setTime(1);
+    handler.processCanSendData();
+    motor.setDesiredOutput(0);
+    handler.processCanSendData();
+
+    handler.setLatencyMeasurementEnabled(true);
+    motor.setDesiredOutput(4'000);
+    handler.processCanSendData();
+    tap::arch::clock::setTime(3);
+    rxHandler.processReceivedCanData(feedback, 3'000, handlerStore);
+
+    EXPECT_EQ(1u, motor.getCommandLatency().getHistogram().getCount());
+    EXPECT_EQ(2'000u, motor.getCommandLatency().getHistogram().getMax());
+}
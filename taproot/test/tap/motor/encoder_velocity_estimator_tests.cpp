@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/motor/encoder_velocity_estimator.hpp"
+
+using namespace tap::motor;
+
+/**
+ * Pushes samples of a motor accelerating at 2e6 ticks/s^2 from 1e5 ticks/s, starting far from 0
+ * and sampled every 1 ms with some jitter, updating `estimator` after each.
+ */
+static void feedAcceleratingMotor(EncoderVelocityEstimator &estimator, int samples)
+{
+    MotorFeedbackHistory history;
+    for (int i = 0; i < samples; i++)
+    {
+        uint32_t timestamp = 1'000 * i + (i % 2 == 0 ? 0 : 37);
+        float t = timestamp * 1E-6f;
+        int64_t encoder = 1'000'000'000 + static_cast<int64_t>(100'000 * t + 1'000'000 * t * t);
+        history.push({timestamp, encoder, 0, 0});
+        estimator.update(history);
+    }
+}
+
+TEST(EncoderVelocityEstimator, least_squares_tracks_velocity_and_acceleration)
+{
+    EncoderVelocityEstimator::Config config;
+    config.type = EncoderVelocityEstimator::Type::LEAST_SQUARES;
+    config.window = MotorFeedbackHistory::SIZE;
+    EncoderVelocityEstimator estimator(config);
+
+    // 3e5 ticks/s after 100 ms, the encoder's resolution limits the accuracy
+    feedAcceleratingMotor(estimator, 101);
+    EXPECT_NEAR(300'000, estimator.getVelocity(), 1'000);
+    EXPECT_NEAR(2'000'000, estimator.getAcceleration(), 200'000);
+}
+
+TEST(EncoderVelocityEstimator, finite_difference_and_alpha_beta_track_velocity)
+{
+    EncoderVelocityEstimator::Config config;
+    config.type = EncoderVelocityEstimator::Type::FINITE_DIFFERENCE;
+    EncoderVelocityEstimator finiteDifference(config);
+    config.type = EncoderVelocityEstimator::Type::ALPHA_BETA;
+    config.gamma = 0.01f;
+    EncoderVelocityEstimator alphaBeta(config);
+
+    feedAcceleratingMotor(finiteDifference, 101);
+    feedAcceleratingMotor(alphaBeta, 101);
+
+    // The finite difference is the velocity half a sample ago, off by another 1000 ticks/s for a
+    // tick of rounding
+    EXPECT_NEAR(300'000, finiteDifference.getVelocity(), 3'000);
+    EXPECT_NEAR(300'000, alphaBeta.getVelocity(), 5'000);
+    EXPECT_GT(alphaBeta.getAcceleration(), 0);
+
+    alphaBeta.reset();
+    EXPECT_EQ(0, alphaBeta.getVelocity());
+}
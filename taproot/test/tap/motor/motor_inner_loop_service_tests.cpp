@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor.hpp"
+#include "tap/motor/dji_motor_tx_handler.hpp"
+#include "tap/motor/motor_inner_loop_service.hpp"
+
+using namespace tap::motor;
+using namespace testing;
+using tap::can::CanBus;
+
+static modm::can::Message feedback(uint32_t id, uint16_t encoder)
+{
+    modm::can::Message message(id, 8);
+    message.data[0] = encoder >> 8;
+    message.data[1] = encoder & 0xFF;
+    return message;
+}
+
+TEST(MotorInnerLoopService, run_updates_loops_on_new_feedback_and_sends_their_frames)
+{
+    tap::Drivers drivers;
+    MotorInnerLoopService service(&drivers);
+    DjiMotor pitch(&drivers, MOTOR6, CanBus::CAN_BUS1, false, "pitch", 4'000);
+    DjiMotor yaw(&drivers, MOTOR1, CanBus::CAN_BUS2, false, "yaw", 4'000);
+    pitch.initialize();
+    yaw.initialize();
+    tap::arch::clock::setTime(1);
+
+    tap::algorithms::SmoothPidConfig config;
+    config.kp = 2;
+    config.maxOutput = 16'000;
+    EXPECT_TRUE(service.addLoop(&pitch, MotorInnerLoopService::Mode::POSITION, config));
+    EXPECT_TRUE(service.addLoop(&yaw, MotorInnerLoopService::Mode::POSITION, config));
+    EXPECT_FALSE(service.addLoop(&yaw, MotorInnerLoopService::Mode::VELOCITY, config));
+    service.setPositionSetpoint(&pitch, 4'500);
+
+    // Only pitch sent feedback
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR6, 4'000), 1'000);
+    EXPECT_CALL(
+        drivers.djiMotorTxHandler,
+        sendTxFrames(DjiMotorTxHandler::txFrameBit(pitch), MotorInnerLoopService::MAX_SEND_DELAY));
+    service.run();
+    EXPECT_EQ(1'000, pitch.getOutputDesired());
+    EXPECT_EQ(0, yaw.getOutputDesired());
+
+    // No new feedback
+    EXPECT_CALL(drivers.djiMotorTxHandler, sendTxFrames).Times(0);
+    service.run();
+
+    EXPECT_EQ(1u, service.getRunCount(&pitch));
+    EXPECT_EQ(0u, service.getRunCount(&yaw));
+}
+
+TEST(MotorInnerLoopService, run_sends_a_shared_frame_once_all_its_loops_ran)
+{
+    tap::Drivers drivers;
+    MotorInnerLoopService service(&drivers);
+    DjiMotor left(&drivers, MOTOR1, CanBus::CAN_BUS1, false, "left", 0);
+    DjiMotor right(&drivers, MOTOR2, CanBus::CAN_BUS1, false, "right", 0);
+    left.initialize();
+    right.initialize();
+    tap::arch::clock::setTime(1);
+
+    tap::algorithms::SmoothPidConfig config;
+    config.kp = 1;
+    service.addLoop(&left, MotorInnerLoopService::Mode::VELOCITY, config);
+    service.addLoop(&right, MotorInnerLoopService::Mode::VELOCITY, config);
+    const uint8_t frameBit = DjiMotorTxHandler::txFrameBit(left);
+    ASSERT_EQ(frameBit, DjiMotorTxHandler::txFrameBit(right));
+
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR1, 0), 1'000);
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR2, 0), 1'000);
+    EXPECT_EQ(frameBit, service.getOwnedTxFrames());
+    EXPECT_CALL(
+        drivers.djiMotorTxHandler,
+        sendTxFrames(frameBit, MotorInnerLoopService::MAX_SEND_DELAY));
+    service.run();
+    Mock::VerifyAndClearExpectations(&drivers.djiMotorTxHandler);
+
+    // The frame waits for the feedback of the other motor in it
+    tap::arch::clock::setTime(2);
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR1, 0), 2'000);
+    EXPECT_CALL(drivers.djiMotorTxHandler, sendTxFrames).Times(0);
+    service.run();
+    Mock::VerifyAndClearExpectations(&drivers.djiMotorTxHandler);
+
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR2, 0), 2'300);
+    EXPECT_CALL(
+        drivers.djiMotorTxHandler,
+        sendTxFrames(frameBit, MotorInnerLoopService::MAX_SEND_DELAY));
+    service.run();
+    Mock::VerifyAndClearExpectations(&drivers.djiMotorTxHandler);
+
+    // Without feedback from the other motor, sent once MAX_SEND_DELAY has passed
+    tap::arch::clock::setTime(3);
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR1, 0), 3'000);
+    EXPECT_CALL(drivers.djiMotorTxHandler, sendTxFrames).Times(0);
+    service.run();
+    Mock::VerifyAndClearExpectations(&drivers.djiMotorTxHandler);
+
+    tap::arch::clock::setTime(3 + MotorInnerLoopService::MAX_SEND_DELAY / 1'000);
+    EXPECT_CALL(
+        drivers.djiMotorTxHandler,
+        sendTxFrames(frameBit, MotorInnerLoopService::MAX_SEND_DELAY));
+    service.run();
+
+    EXPECT_EQ(3u, service.getRunCount(&left));
+    EXPECT_EQ(2u, service.getRunCount(&right));
+}
+
+TEST(MotorInnerLoopService, velocity_loop_drives_towards_the_setpoint_and_stops_offline_motors)
+{
+    tap::Drivers drivers;
+    MotorInnerLoopService service(&drivers);
+    DjiMotor motor(&drivers, MOTOR2, CanBus::CAN_BUS1, true, "motor", 0);
+    motor.initialize();
+    tap::arch::clock::setTime(1);
+
+    tap::algorithms::SmoothPidConfig config;
+    config.kp = 10;
+    config.maxOutput = 16'000;
+    service.addLoop(&motor, MotorInnerLoopService::Mode::VELOCITY, config);
+    service.setVelocitySetpoint(&motor, 600);
+
+    // At rest, the motor is inverted so the output sent is negative
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR2, 8'191), 1'000);
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR2, 8'191), 2'000);
+    service.run();
+    EXPECT_EQ(-6'000, motor.getOutputDesired());
+
+    // Stopped once disconnected, without waiting for feedback
+    tap::arch::clock::setTime(1 + DjiMotorBank::MOTOR_DISCONNECT_TIME);
+    EXPECT_CALL(
+        drivers.djiMotorTxHandler,
+        sendTxFrames(DjiMotorTxHandler::txFrameBit(motor), MotorInnerLoopService::MAX_SEND_DELAY));
+    service.run();
+    EXPECT_EQ(0, motor.getOutputDesired());
+    EXPECT_EQ(1u, service.getRunCount(&motor));
+
+    service.removeLoop(&motor);
+    EXPECT_EQ(0u, service.getRunCount(&motor));
+}
+
+TEST(MotorInnerLoopService, frames_without_online_loop_motors_are_not_owned)
+{
+    tap::Drivers drivers;
+    MotorInnerLoopService service(&drivers);
+    DjiMotor looped(&drivers, MOTOR1, CanBus::CAN_BUS1, false, "looped", 0);
+    DjiMotor wheel(&drivers, MOTOR2, CanBus::CAN_BUS1, false, "wheel", 0);
+    looped.initialize();
+    wheel.initialize();
+    tap::arch::clock::setTime(1);
+
+    tap::algorithms::SmoothPidConfig config;
+    config.kp = 10;
+    config.maxOutput = 16'000;
+    service.addLoop(&looped, MotorInnerLoopService::Mode::VELOCITY, config);
+    service.setVelocitySetpoint(&looped, 600);
+    const uint8_t frameBit = DjiMotorTxHandler::txFrameBit(looped);
+    ASSERT_EQ(frameBit, DjiMotorTxHandler::txFrameBit(wheel));
+
+    // Never online, the wheel's commands must still be sent by processCanSendData
+    EXPECT_EQ(0, service.getOwnedTxFrames());
+
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR1, 0), 1'000);
+    drivers.djiMotorBankCan1.decode(feedback(MOTOR1, 0), 2'000);
+    service.run();
+    EXPECT_EQ(frameBit, service.getOwnedTxFrames());
+    EXPECT_NE(0, looped.getOutputDesired());
+
+    // Disconnected, the loop zeroes its output once and hands the frame back
+    tap::arch::clock::setTime(1 + DjiMotorBank::MOTOR_DISCONNECT_TIME);
+    EXPECT_CALL(
+        drivers.djiMotorTxHandler,
+        sendTxFrames(frameBit, MotorInnerLoopService::MAX_SEND_DELAY));
+    service.run();
+    Mock::VerifyAndClearExpectations(&drivers.djiMotorTxHandler);
+    EXPECT_EQ(0, looped.getOutputDesired());
+    EXPECT_EQ(0, service.getOwnedTxFrames());
+
+    EXPECT_CALL(drivers.djiMotorTxHandler, sendTxFrames).Times(0);
+    service.run();
+    EXPECT_EQ(0, service.getOwnedTxFrames());
+}